@@ -16,18 +16,35 @@ enum class PluginType : u8
   EMPTY,
 };
 
-extern "C" CLT_EXPORT const Char8* colt_name()
+/// @brief The function table returned by 'colt_plugin_v1'.
+/// Its layout must match 'ColtPlugin::TableV1' of the compiler.
+struct PluginTableV1
+{
+  /// @brief The version of the ABI (1)
+  u32 abi_version;
+  /// @brief The size of this struct
+  u32 struct_size;
+  /// @brief Bit mask of capabilities (1: report, 2: highlight, 4: backend)
+  u64 capabilities;
+  const Char8* (*name)();
+  const Char8* (*desc)();
+  PluginType (*purpose)();
+  i32 (*setup)();
+  void (*shutdown)();
+};
+
+static const Char8* plugin_name()
 {
   return (const Char8*)"EmptyPlugin"_UTF8;
 }
 
-extern "C" CLT_EXPORT const Char8* colt_desc()
+static const Char8* plugin_desc()
 {
   return (const Char8*)"This is an empty plugin to verify the plugin system"
                        " is functional."_UTF8;
 }
 
-extern "C" CLT_EXPORT PluginType colt_purpose()
+static PluginType plugin_purpose()
 {
   return PluginType::EMPTY;
 }
@@ -35,7 +52,7 @@ extern "C" CLT_EXPORT PluginType colt_purpose()
 /// @brief The setup function.
 /// This function is called once to initialize the plugin.
 /// @return 0 if initialization was successful.
-extern "C" CLT_EXPORT i32 colt_setup()
+static i32 plugin_setup()
 {
   // Add setup code if needed
   return 0;
@@ -43,7 +60,24 @@ extern "C" CLT_EXPORT i32 colt_setup()
 
 /// @brief The shutdown function.
 /// This function is called once when the plugin is unloaded.
-extern "C" CLT_EXPORT void colt_shutdown()
+static void plugin_shutdown()
+{
+  // Free any resources created by plugin_setup
+}
+
+/// @brief The only symbol looked up by the compiler.
+/// @return The function table of the plugin
+extern "C" CLT_EXPORT const PluginTableV1* colt_plugin_v1()
 {
-  // Free any resources created by colt_setup
+  static constexpr PluginTableV1 TABLE = {
+      1,
+      sizeof(PluginTableV1),
+      0,
+      &plugin_name,
+      &plugin_desc,
+      &plugin_purpose,
+      &plugin_setup,
+      &plugin_shutdown,
+  };
+  return &TABLE;
 }
@@ -0,0 +1,140 @@
+/*****************************************************************/ /**
+ * @file   client_main.cpp
+ * @brief  Entry point of 'coltc-client', the thin client of
+ *         'coltc --daemon'.
+ * 'coltc-client' takes the same arguments as 'coltc': they are sent to
+ * the daemon with the working directory, and the output and exit code
+ * of the compilation are forwarded. If no daemon is listening, 'coltc'
+ * is executed instead (from the PATH), so that build scripts work
+ * whether or not a daemon was started.
+ * This file only depends on the C++ standard library and POSIX.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <util/daemon_protocol.h>
+
+using namespace clt;
+
+/// @brief Connects to the daemon.
+/// A daemon that is not run by the current user is not trusted (it
+/// could read the sources and forge the output of the compilation).
+/// @param path The path of the socket of the daemon
+/// @return The connection, or -1 if no trusted daemon is listening
+static int connect_to(const std::string& path) noexcept
+{
+  // Another user may have created the fallback directory first
+  if (auto dir = daemon::fallback_socket_dir(); path.starts_with(dir + '/'))
+  {
+    struct stat info;
+    if (::lstat(dir.c_str(), &info) != 0)
+      return -1;
+    if (!daemon::is_private_dir(dir))
+    {
+      std::fprintf(
+          stderr, "coltc-client: '%s' is not a private directory!\n",
+          dir.c_str());
+      return -1;
+    }
+  }
+  sockaddr_un address = {};
+  address.sun_family  = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path))
+    return -1;
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return -1;
+  if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address))
+      != 0)
+  {
+    ::close(fd);
+    return -1;
+  }
+  if (!daemon::is_peer_trusted(fd))
+  {
+    std::fprintf(
+        stderr, "coltc-client: the daemon on '%s' is run by another user!\n",
+        path.c_str());
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/// @brief Forwards the output of the compilation to stdout
+/// @param fd The connection to the daemon
+/// @return The exit code of the compilation
+static int forward_response(int fd) noexcept
+{
+  // The trailer is only known once the connection is closed: the last
+  // TRAILER_SIZE bytes received are held back
+  std::vector<char> pending;
+  char buffer[64 * 1024];
+  while (true)
+  {
+    auto count = ::read(fd, buffer, sizeof(buffer));
+    if (count < 0 && errno == EINTR)
+      continue;
+    if (count <= 0)
+      break;
+    pending.insert(pending.end(), buffer, buffer + count);
+    if (pending.size() <= daemon::TRAILER_SIZE)
+      continue;
+    const size_t ready = pending.size() - daemon::TRAILER_SIZE;
+    std::fwrite(pending.data(), 1, ready, stdout);
+    pending.erase(pending.begin(), pending.begin() + ready);
+  }
+  std::fflush(stdout);
+  ::close(fd);
+  if (pending.size() != daemon::TRAILER_SIZE
+      || !std::equal(
+          daemon::EXIT_MAGIC.begin(), daemon::EXIT_MAGIC.end(), pending.begin()))
+  {
+    std::fprintf(stderr, "coltc-client: the daemon closed the connection!\n");
+    return 1;
+  }
+  std::int32_t code;
+  std::memcpy(&code, pending.data() + daemon::EXIT_MAGIC.size(), sizeof(code));
+  return code;
+}
+
+int main(int argc, char** argv)
+{
+  const auto path = daemon::default_socket_path();
+  const int fd    = connect_to(path);
+  if (fd < 0)
+  {
+    // Without a daemon, the compiler is run directly
+    argv[0] = const_cast<char*>("coltc");
+    ::execvp("coltc", argv);
+    std::fprintf(
+        stderr,
+        "coltc-client: no daemon listens on '%s' and 'coltc' could not be "
+        "executed!\n",
+        path.c_str());
+    return 1;
+  }
+  // Reported as an error by 'write_all' instead of killing the client
+  std::signal(SIGPIPE, SIG_IGN);
+
+  std::error_code error;
+  const auto cwd = std::filesystem::current_path(error).string();
+  std::vector<std::string_view> strings = {cwd};
+  for (int i = 0; i < argc; i++)
+    strings.push_back(argv[i]);
+  const auto request = daemon::encode_request(strings);
+  if (error || !daemon::write_all(fd, request.data(), request.size()))
+  {
+    std::fprintf(stderr, "coltc-client: could not send the request!\n");
+    return 1;
+  }
+  ::shutdown(fd, SHUT_WR);
+  return forward_response(fd);
+}
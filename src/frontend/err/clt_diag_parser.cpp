@@ -0,0 +1,247 @@
+/*****************************************************************/ /**
+ * @file   clt_diag_parser.cpp
+ * @brief  Implementation of DiagnosticDatabase.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include "clt_diag_parser.h"
+
+namespace clt::lng
+{
+  namespace details
+  {
+    /// @brief Returns the line starting at 'begin' (without '\n' or '\r\n')
+    /// @param begin The beginning of the line
+    /// @param end The end of the file
+    /// @param next Set to the beginning of the next line
+    /// @return The line
+    static std::string_view next_line(
+        const char* begin, const char* end, const char*& next) noexcept
+    {
+      auto line_end = static_cast<const char*>(
+          std::memchr(begin, '\n', static_cast<size_t>(end - begin)));
+      if (line_end == nullptr)
+      {
+        line_end = end;
+        next     = end;
+      }
+      else
+        next = line_end + 1;
+      if (line_end != begin && line_end[-1] == '\r')
+        --line_end;
+      return std::string_view{begin, static_cast<size_t>(line_end - begin)};
+    }
+
+    /// @brief Counts the number of arguments ('{}') of a diagnostic
+    /// @param diag The diagnostic
+    /// @return The number of arguments
+    static u8 count_arguments(std::string_view diag) noexcept
+    {
+      u8 count = 0;
+      for (size_t i = diag.find("{}"); i != std::string_view::npos;
+           i        = diag.find("{}", i + 2))
+        count += static_cast<u8>(count != std::numeric_limits<u8>::max());
+      return count;
+    }
+  } // namespace details
+
+  Expect<DiagnosticDatabase, DiagnosticDatabase::LoadError> DiagnosticDatabase::load(
+      const char* path) noexcept
+  {
+    COLT_TRACE_FN_C(clt::Color::Gold);
+    auto file = ViewOfFile::open(path);
+    if (!file.is_value())
+      return {Error, LoadError::OS_ERR};
+    auto db      = DiagnosticDatabase(std::move(*file));
+    auto content = *db.file.view();
+
+    Option<LoadError> result = None;
+    if (content.size() >= sizeof(DiagnosticBinHeader)
+        && std::memcmp(
+               content.data(), DiagnosticBinHeader::MAGIC.data(),
+               DiagnosticBinHeader::MAGIC.size())
+               == 0)
+      result = db.parse_binary(content);
+    else
+      result = db.parse_text(content);
+    if (result.is_value())
+      return {Error, *result};
+    return {std::move(db)};
+  }
+
+  Option<DiagnosticDatabase::LoadError> DiagnosticDatabase::parse_text(
+      View<u8> content) noexcept
+  {
+    COLT_TRACE_FN_C(clt::Color::Gold);
+    static constexpr std::string_view HEADER = "COLTCDIAG:";
+
+    // Offsets are stored on 32 bits
+    if (content.size() > std::numeric_limits<u32>::max())
+      return LoadError::INVALID_ENTRY;
+
+    const char* begin = reinterpret_cast<const char*>(content.data());
+    const char* end   = begin + content.size();
+    const char* next  = begin;
+
+    // COLTCDIAG:{ISO 639-1}:{Language}
+    auto line = details::next_line(begin, end, next);
+    if (!line.starts_with(HEADER))
+      return LoadError::INVALID_HEADER;
+    line.remove_prefix(HEADER.size());
+    auto colon = line.find(':');
+    if (colon == 0 || colon == std::string_view::npos || colon + 1 == line.size())
+      return LoadError::INVALID_HEADER;
+    lang_abrv_ = u8StringView{reinterpret_cast<const Char8*>(line.data()), colon};
+    language_  = u8StringView{
+        reinterpret_cast<const Char8*>(line.data()) + colon + 1,
+        line.size() - colon - 1};
+
+    // ([MWE][0-9]{ENTRY_ID_DIGITS}:{DIAGNOSTIC}\n)*
+    static constexpr size_t PREFIX_SIZE = DiagnosticEntry::ENTRY_ID_DIGITS + 2;
+    while (next != end)
+    {
+      line = details::next_line(next, end, next);
+      if (line.empty())
+        continue;
+      if (line.size() < PREFIX_SIZE || line[PREFIX_SIZE - 1] != ':')
+        return LoadError::INVALID_ENTRY;
+
+      ReportKind kind;
+      switch (line[0])
+      {
+      case 'M':
+        kind = ReportKind::MESSAGE;
+        break;
+      case 'W':
+        kind = ReportKind::WARNING;
+        break;
+      case 'E':
+        kind = ReportKind::ERROR;
+        break;
+      default:
+        return LoadError::INVALID_ENTRY;
+      }
+
+      u16 id = 0;
+      for (size_t i = 1; i < PREFIX_SIZE - 1; i++)
+      {
+        if (!clt::isdigit(line[i]))
+          return LoadError::INVALID_ENTRY;
+        id = static_cast<u16>(id * 10 + (line[i] - '0'));
+      }
+
+      auto diag = line.substr(PREFIX_SIZE);
+      if (diag.size() > std::numeric_limits<u16>::max())
+        return LoadError::INVALID_ENTRY;
+
+      auto& table = owned_index[static_cast<u8>(kind)];
+      if (table.size() <= id)
+        table.resize(static_cast<size_t>(id) + 1, DiagnosticIndex{0, 0, 0, 0});
+      if (table[id].is_present)
+        return LoadError::DUPLICATE_ENTRY;
+      table[id] = DiagnosticIndex{
+          static_cast<u32>(diag.data() - begin), static_cast<u16>(diag.size()),
+          details::count_arguments(diag), 1};
+    }
+
+    text      = reinterpret_cast<const Char8*>(begin);
+    text_size = content.size();
+    for (size_t i = 0; i < owned_index.size(); i++)
+    {
+      index[i]       = owned_index[i].data();
+      index_count[i] = static_cast<u32>(owned_index[i].size());
+    }
+    return None;
+  }
+
+  Option<DiagnosticDatabase::LoadError> DiagnosticDatabase::parse_binary(
+      View<u8> content) noexcept
+  {
+    COLT_TRACE_FN_C(clt::Color::Gold);
+    DiagnosticBinHeader header;
+    std::memcpy(&header, content.data(), sizeof(DiagnosticBinHeader));
+    if (header.version != DiagnosticBinHeader::CURRENT_VERSION)
+      return LoadError::INVALID_BINARY;
+
+    const u64 size  = content.size();
+    u64 index_total = 0;
+    for (auto i : header.index_count)
+      index_total += i;
+    if (header.index_offset % alignof(DiagnosticIndex) != 0
+        || header.index_offset + index_total * sizeof(DiagnosticIndex) > size
+        || static_cast<u64>(header.text_offset) + header.text_size > size
+        || static_cast<u64>(header.lang_abrv_offset) + header.lang_abrv_size > size
+        || static_cast<u64>(header.language_offset) + header.language_size > size)
+      return LoadError::INVALID_BINARY;
+
+    auto base  = reinterpret_cast<const Char8*>(content.data());
+    lang_abrv_ = u8StringView{base + header.lang_abrv_offset, header.lang_abrv_size};
+    language_  = u8StringView{base + header.language_offset, header.language_size};
+    text       = base + header.text_offset;
+    text_size  = header.text_size;
+
+    // The index is used in place: loading is independent of the
+    // number of diagnostics.
+    auto table =
+        reinterpret_cast<const DiagnosticIndex*>(content.data() + header.index_offset);
+    for (size_t i = 0; i < index.size(); i++)
+    {
+      index[i]       = table;
+      index_count[i] = header.index_count[i];
+      table += header.index_count[i];
+    }
+    return None;
+  }
+
+  bool DiagnosticDatabase::compile_to(const char* path) const noexcept
+  {
+    COLT_TRACE_FN_C(clt::Color::Gold);
+    std::string blob;
+    blob.append(reinterpret_cast<const char*>(lang_abrv_.data()), lang_abrv_.size());
+    blob.append(reinterpret_cast<const char*>(language_.data()), language_.size());
+
+    // Rebuild the index so that it points into 'blob'
+    std::array<std::vector<DiagnosticIndex>, 3> compiled;
+    u64 index_total = 0;
+    for (size_t i = 0; i < compiled.size(); i++)
+    {
+      compiled[i].assign(index[i], index[i] + index_count[i]);
+      index_total += index_count[i];
+      for (auto& entry : compiled[i])
+      {
+        if (!entry.is_present)
+          continue;
+        auto old_offset = entry.offset;
+        entry.offset    = static_cast<u32>(blob.size());
+        blob.append(reinterpret_cast<const char*>(text) + old_offset, entry.size);
+      }
+    }
+
+    DiagnosticBinHeader header{};
+    header.magic            = DiagnosticBinHeader::MAGIC;
+    header.version          = DiagnosticBinHeader::CURRENT_VERSION;
+    header.index_offset     = static_cast<u32>(sizeof(DiagnosticBinHeader));
+    header.text_offset      = static_cast<u32>(
+        header.index_offset + index_total * sizeof(DiagnosticIndex));
+    header.text_size        = static_cast<u32>(blob.size());
+    header.lang_abrv_size   = static_cast<u16>(lang_abrv_.size());
+    header.language_size    = static_cast<u16>(language_.size());
+    header.lang_abrv_offset = header.text_offset;
+    header.language_offset  = header.text_offset + header.lang_abrv_size;
+    for (size_t i = 0; i < compiled.size(); i++)
+      header.index_count[i] = static_cast<u32>(compiled[i].size());
+
+    auto file = std::fopen(path, "wb");
+    if (file == nullptr)
+      return false;
+    bool success =
+        std::fwrite(&header, sizeof(DiagnosticBinHeader), 1, file) == 1;
+    for (auto& i : compiled)
+      success = success
+                && std::fwrite(i.data(), sizeof(DiagnosticIndex), i.size(), file)
+                       == i.size();
+    success = success && std::fwrite(blob.data(), 1, blob.size(), file) == blob.size();
+    return (std::fclose(file) == 0) && success;
+  }
+} // namespace clt::lng
@@ -9,7 +9,13 @@
  * COLTCDIAG:{ISO 639-1}:{Language}
  * ([MWE][0-9]{ENTRY_ID_DIGITS}:{DIAGNOSTIC}\n)*
  * 
- * For an example, see `resources/diag/en.clt.diag`.
+ * For an example, see `resources/diag/en.colt.diag`.
+ * 
+ * A '.colt.diag' file can be compiled to a '.colt.diagbin' file,
+ * which is made of a DiagnosticBinHeader, followed by the index
+ * of each kind of diagnostic, followed by the text of all the
+ * diagnostics. Loading such a file does not require any parsing:
+ * the index is used in place from the mapped file.
  * 
  * @author RPC
  * @date   September 2024
@@ -17,6 +23,7 @@
 #ifndef HG_COLTC_CLT_DIAG_PARSER
 #define HG_COLTC_CLT_DIAG_PARSER
 
+#include <vector>
 #include <frontend/err/error_reporter.h>
 #include <colt/os/mmap_file.h>
 
@@ -38,12 +45,177 @@ namespace clt::lng
     u8StringView diagnostic;
   };
 
-  /// @brief Represents a parsed '.colt.diag' file
+  /// @brief An entry of the index of a DiagnosticDatabase.
+  /// This is also the on-disk layout used by '.colt.diagbin' files.
+  struct DiagnosticIndex
+  {
+    /// @brief The offset of the diagnostic from the beginning of the text
+    u32 offset;
+    /// @brief The size of the diagnostic in bytes
+    u16 size;
+    /// @brief The number of arguments expected by the diagnostic
+    u8 arg_count;
+    /// @brief True if the entry exists
+    u8 is_present;
+  };
+
+  /// @brief The header of a '.colt.diagbin' file.
+  /// All offsets are from the beginning of the file, and all integers
+  /// are stored using the endianness of the machine that compiled the file.
+  struct DiagnosticBinHeader
+  {
+    /// @brief The expected magic number
+    static constexpr std::array<char, 8> MAGIC = {'C', 'O', 'L', 'T',
+                                                  'D', 'B', 'I', 'N'};
+    /// @brief The current version of the format
+    static constexpr u32 CURRENT_VERSION = 1;
+
+    /// @brief Must be equal to MAGIC
+    std::array<char, 8> magic;
+    /// @brief Must be equal to CURRENT_VERSION
+    u32 version;
+    /// @brief The size of the language abbreviation
+    u16 lang_abrv_size;
+    /// @brief The size of the language name
+    u16 language_size;
+    /// @brief The offset of the language abbreviation
+    u32 lang_abrv_offset;
+    /// @brief The offset of the language name
+    u32 language_offset;
+    /// @brief The number of entries of each index (indexed by ReportKind)
+    std::array<u32, 3> index_count;
+    /// @brief The offset of the first index (the others follow)
+    u32 index_offset;
+    /// @brief The offset of the text of the diagnostics
+    u32 text_offset;
+    /// @brief The size of the text of the diagnostics
+    u32 text_size;
+  };
+
+  /// @brief Represents a parsed '.colt.diag' (or '.colt.diagbin') file.
+  /// The diagnostics are never copied: they are views over the mapped file.
   class DiagnosticDatabase
   {
-    u8StringView lang_abrv;
-    u8StringView language;
+    /// @brief The mapped file
+    ViewOfFile file;
+    /// @brief The index built when parsing a '.colt.diag' file (indexed by ReportKind)
+    std::array<std::vector<DiagnosticIndex>, 3> owned_index = {};
+    /// @brief The index of each kind of diagnostic (indexed by ReportKind).
+    /// Points either to 'owned_index' or to the mapped file.
+    std::array<const DiagnosticIndex*, 3> index = {};
+    /// @brief The number of entries of each index (indexed by ReportKind)
+    std::array<u32, 3> index_count = {};
+    /// @brief The beginning of the text of the diagnostics
+    const Char8* text = nullptr;
+    /// @brief The size of the text of the diagnostics
+    u64 text_size = 0;
+    /// @brief The ISO 639-1 abbreviation of the language
+    u8StringView lang_abrv_ = {};
+    /// @brief The language name
+    u8StringView language_ = {};
+
+    /// @brief Constructor
+    /// @param file The mapped file
+    DiagnosticDatabase(ViewOfFile&& file) noexcept
+        : file(std::move(file))
+    {
+    }
+
+  public:
+    /// @brief Possible failure on loading a database
+    enum class LoadError : u8
+    {
+      /// @brief The file could not be opened or mapped
+      OS_ERR,
+      /// @brief The 'COLTCDIAG:{ISO 639-1}:{Language}' header is invalid
+      INVALID_HEADER,
+      /// @brief An entry does not respect the '[MWE][0-9]{4}:' format
+      INVALID_ENTRY,
+      /// @brief An entry is defined twice
+      DUPLICATE_ENTRY,
+      /// @brief The '.colt.diagbin' file is corrupted or of the wrong version
+      INVALID_BINARY,
+    };
+
+  private:
+    /// @brief Builds the index of a '.colt.diag' file in a single pass
+    /// @param content The content of the file
+    /// @return None on success, else the error
+    Option<LoadError> parse_text(View<u8> content) noexcept;
+
+    /// @brief Uses the index of a '.colt.diagbin' file in place
+    /// @param content The content of the file
+    /// @return None on success, else the error
+    Option<LoadError> parse_binary(View<u8> content) noexcept;
+
+  public:
+    DiagnosticDatabase()                                         = delete;
+    DiagnosticDatabase(DiagnosticDatabase&&) noexcept            = default;
+    DiagnosticDatabase& operator=(DiagnosticDatabase&&) noexcept = default;
+
+    /// @brief Loads a '.colt.diag' or '.colt.diagbin' file.
+    /// The kind of file is detected using its content.
+    /// @param path The path to the file
+    /// @return The database or an error
+    static Expect<DiagnosticDatabase, LoadError> load(const char* path) noexcept;
+
+    /// @brief Search for a diagnostic
+    /// @param kind The kind of the diagnostic
+    /// @param id The ID of the diagnostic
+    /// @return None if the diagnostic does not exist
+    Option<DiagnosticEntry> find(ReportKind kind, u16 id) const noexcept
+    {
+      const auto kind_idx = static_cast<u8>(kind);
+      if (id >= index_count[kind_idx] || !index[kind_idx][id].is_present)
+        return None;
+      auto& entry = index[kind_idx][id];
+      // Entries of '.colt.diagbin' files are only checked on use
+      if (static_cast<u64>(entry.offset) + entry.size > text_size)
+        return None;
+      return DiagnosticEntry{
+          kind, entry.arg_count, id,
+          u8StringView{text + entry.offset, static_cast<size_t>(entry.size)}};
+    }
+
+    /// @brief Returns the diagnostic string or a fallback
+    /// @param kind The kind of the diagnostic
+    /// @param id The ID of the diagnostic
+    /// @param fallback The string to return if the diagnostic does not exist
+    /// @return The diagnostic string or 'fallback'
+    u8StringView get_or(ReportKind kind, u16 id, u8StringView fallback) const noexcept
+    {
+      auto entry = find(kind, id);
+      return entry.is_value() ? entry->diagnostic : fallback;
+    }
+
+    /// @brief Returns the ISO 639-1 abbreviation of the language
+    /// @return The language abbreviation (example: 'en')
+    u8StringView lang_abrv() const noexcept { return lang_abrv_; }
+    /// @brief Returns the name of the language
+    /// @return The language name (example: 'English')
+    u8StringView language() const noexcept { return language_; }
+
+    /// @brief Returns the number of diagnostics of a kind.
+    /// This iterates over the index, and should not be used in hot paths.
+    /// @param kind The kind of diagnostic
+    /// @return The number of diagnostics of that kind
+    u32 count(ReportKind kind) const noexcept
+    {
+      u32 count = 0;
+      for (u32 i = 0; i < index_count[static_cast<u8>(kind)]; i++)
+        count += index[static_cast<u8>(kind)][i].is_present;
+      return count;
+    }
+
+    /// @brief Writes the database as a '.colt.diagbin' file
+    /// @param path The path of the file to write
+    /// @return True on success
+    bool compile_to(const char* path) const noexcept;
   };
-}
+} // namespace clt::lng
+
+ADD_REFLECTION_FOR_CONSECUTIVE_ENUM(
+    clt::lng::DiagnosticDatabase, LoadError, OS_ERR, INVALID_HEADER, INVALID_ENTRY,
+    DUPLICATE_ENTRY, INVALID_BINARY);
 
 #endif // !HG_COLTC_CLT_DIAG_PARSER
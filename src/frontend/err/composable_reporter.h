@@ -8,6 +8,10 @@
 #ifndef HG_COLTC_COMPOSABLE_REPORTER
 #define HG_COLTC_COMPOSABLE_REPORTER
 
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <colt/dsa/vector.h>
 #include "error_reporter.h"
 
 namespace clt::lng
@@ -251,6 +255,209 @@ namespace clt::lng
       Rep::error("No more errors will be reported.", None, None);
     }
   };
+
+  template<Reporter Rep>
+  /// @brief Removes duplicate reports.
+  /// Two reports are duplicates if they have the same kind, the same report
+  /// number, the same normalized string (numbers and quoted text are ignored)
+  /// and the same location class (no location, single line, multiple lines).
+  /// An apostrophe inside a word ("can't") or without a closing quote does
+  /// not start quoted text.
+  /// The first occurrences are forwarded, the others are only counted:
+  /// 'flush' (called at the end of each phase) forwards "... N more like
+  /// this", before flushing 'Rep'.
+  /// @tparam Rep The reporter to forward reports to
+  class DedupReporter : public Rep
+  {
+    /// @brief A group of duplicate reports
+    struct Group
+    {
+      /// @brief The string of the first occurrence
+      std::string first;
+      /// @brief The number of occurrences
+      u64 count;
+      /// @brief The report number of the group
+      Option<ReportNumber> nb;
+      /// @brief The kind of the group
+      ReportKind kind;
+    };
+
+    /// @brief The groups, in order of first occurrence
+    Vector<Group> groups = make_vector<Group>();
+    /// @brief Maps a key (see 'make_key') to its index in 'groups'
+    std::unordered_map<std::string, u32> index = {};
+    /// @brief Scratch buffer used to build keys without allocating
+    std::string key = {};
+    /// @brief The number of occurrences forwarded per group
+    u32 keep;
+
+    /// @brief Check if a character is part of a word (ASCII letter or digit)
+    /// @param chr The character
+    /// @return True if 'chr' is a letter or a digit
+    static constexpr bool is_word_char(char chr) noexcept
+    {
+      return ('a' <= chr && chr <= 'z') || ('A' <= chr && chr <= 'Z')
+             || ('0' <= chr && chr <= '9');
+    }
+
+    /// @brief Builds the key of a report into 'key'
+    /// @param kind The kind of the report
+    /// @param str The report string
+    /// @param src_info The source information if it exist
+    /// @param nb The report number if it exist
+    void make_key(
+        ReportKind kind, u8StringView str, const Option<SourceInfo>& src_info,
+        const Option<ReportNumber>& nb) noexcept
+    {
+      key.clear();
+      key.push_back(static_cast<char>(kind));
+      key.push_back(
+          src_info.is_none() ? 'N' : (src_info->is_single_line() ? 'S' : 'M'));
+      if (nb.is_value())
+        key.append(reinterpret_cast<const char*>(&*nb), sizeof(ReportNumber));
+      key.push_back(':');
+
+      const auto begin = reinterpret_cast<const char*>(str.data());
+      const auto end   = begin + str.unit_len();
+      auto ptr         = begin;
+      char quote       = 0;
+      bool prev_number = false;
+      for (; ptr != end; ptr++)
+      {
+        const char chr = *ptr;
+        if (quote != 0)
+        {
+          // Quoted text is collapsed: "unknown 'a'" == "unknown 'b'"
+          if (chr == quote)
+          {
+            key.push_back(chr);
+            quote = 0;
+          }
+          continue;
+        }
+        if ('0' <= chr && chr <= '9')
+        {
+          // Numbers are collapsed: "line 10" == "line 2"
+          if (!prev_number)
+            key.push_back('#');
+          prev_number = true;
+          continue;
+        }
+        const bool in_word = ptr != begin && is_word_char(ptr[-1]);
+        prev_number        = false;
+        // Only a quote that is closed starts quoted text
+        if ((chr == '"' || chr == '`' || (chr == '\'' && !in_word))
+            && std::find(ptr + 1, end, chr) != end)
+          quote = chr;
+        key.push_back(chr);
+      }
+    }
+
+    /// @brief Returns true if a report should be forwarded
+    /// @param kind The kind of the report
+    /// @param str The report string
+    /// @param src_info The source information if it exist
+    /// @param nb The report number if it exist
+    /// @return True if the report is one of the first 'keep' of its group
+    bool should_forward(
+        ReportKind kind, u8StringView str, const Option<SourceInfo>& src_info,
+        const Option<ReportNumber>& nb) noexcept
+    {
+      make_key(kind, str, src_info, nb);
+      if (auto it = index.find(key); it != index.end())
+        return ++groups[it->second].count <= keep;
+      index.emplace(key, static_cast<u32>(groups.size()));
+      groups.push_back(Group{
+          std::string{reinterpret_cast<const char*>(str.data()), str.unit_len()}, 1,
+          nb, kind});
+      return true;
+    }
+
+  public:
+    DedupReporter()                     = delete;
+    DedupReporter(DedupReporter&&)      = delete;
+    DedupReporter(const DedupReporter&) = delete;
+
+    template<typename... Args>
+    /// @brief Constructor
+    /// @param keep The number of occurrences to forward for each group (at least 1)
+    /// @param args Arguments to forward to the constructor of 'Rep'
+    DedupReporter(u32 keep, Args&&... args) noexcept(
+        std::is_nothrow_constructible_v<Rep, Args...>)
+        : Rep(std::forward<Args>(args)...)
+        , keep(keep)
+    {
+      assert_true("Invalid arguments for DedupReporter!", keep != 0);
+    }
+
+    /// @brief Forwards "... N more like this" for each group that had
+    ///        more than 'keep' occurrences, forgets all the groups, then
+    ///        flushes 'Rep' if it is a FlushableReporter.
+    void flush() noexcept
+    {
+      for (auto& group : groups)
+      {
+        if (group.count <= keep)
+          continue;
+        auto str = fmt::format(
+            "... {} more like this: {}", group.count - keep, group.first);
+        auto strv =
+            u8StringView{reinterpret_cast<const Char8*>(str.data()), str.size()};
+        switch_no_default(group.kind)
+        {
+        case ReportKind::MESSAGE:
+          Rep::message(strv, None, group.nb);
+          break;
+        case ReportKind::WARNING:
+          Rep::warn(strv, None, group.nb);
+          break;
+        case ReportKind::ERROR:
+          Rep::error(strv, None, group.nb);
+          break;
+        }
+      }
+      groups.clear();
+      index.clear();
+      if constexpr (FlushableReporter<Rep>)
+        Rep::flush();
+    }
+
+    /// @brief Forward the message to 'Rep' if it is not a duplicate
+    /// @param str The message
+    /// @param src_info The source information if it exist
+    /// @param msg_nb The report information if it exist
+    void message(
+        u8StringView str, const Option<SourceInfo>& src_info = None,
+        const Option<ReportNumber>& msg_nb = None) noexcept
+    {
+      if (should_forward(ReportKind::MESSAGE, str, src_info, msg_nb))
+        Rep::message(str, src_info, msg_nb);
+    }
+
+    /// @brief Forward the warning to 'Rep' if it is not a duplicate
+    /// @param str The warning
+    /// @param src_info The source information if it exist
+    /// @param msg_nb The report information if it exist
+    void warn(
+        u8StringView str, const Option<SourceInfo>& src_info = None,
+        const Option<ReportNumber>& msg_nb = None) noexcept
+    {
+      if (should_forward(ReportKind::WARNING, str, src_info, msg_nb))
+        Rep::warn(str, src_info, msg_nb);
+    }
+
+    /// @brief Forward the error to 'Rep' if it is not a duplicate
+    /// @param str The error
+    /// @param src_info The source information if it exist
+    /// @param msg_nb The report information if it exist
+    void error(
+        u8StringView str, const Option<SourceInfo>& src_info = None,
+        const Option<ReportNumber>& msg_nb = None) noexcept
+    {
+      if (should_forward(ReportKind::ERROR, str, src_info, msg_nb))
+        Rep::error(str, src_info, msg_nb);
+    }
+  };
 } // namespace clt::lng
 
 #endif // !HG_COLTC_COMPOSABLE_REPORTER
@@ -0,0 +1,357 @@
+/*****************************************************************/ /**
+ * @file   concurrent_reporter.h
+ * @brief  Contains ConcurrentReporter, an error reporter that can be
+ *         shared by multiple workers.
+ * Each worker reports to its own shard: a BufferReporter that saves
+ * the diagnostics and has its own counters, so that workers never
+ * contend on a lock or a shared cache line.
+ * At the end of a phase, 'flush' merges the shards, ordering the
+ * diagnostics by file then by source position. As a file is always
+ * processed by a single worker, the output does not depend on the
+ * number of workers.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_COLTC_CONCURRENT_REPORTER
+#define HG_COLTC_CONCURRENT_REPORTER
+
+#include <algorithm>
+#include <colt/dsa/vector.h>
+#include "error_reporter.h"
+#include "machine_reporter.h"
+
+namespace clt::lng
+{
+  /// @brief A report saved by a BufferReporter, waiting to be merged
+  struct BufferedReport
+  {
+    /// @brief The byte offset of the expression in its file.
+    /// Reports without source information inherit the offset of the
+    /// previous report of the same file.
+    u64 byte_offset;
+    /// @brief The ID of the file that generated the report
+    u32 file_id;
+    /// @brief The index of the report in its file (used to break ties)
+    u32 sequence;
+    /// @brief The offset of the report string in the shard's text
+    u32 text_offset;
+    /// @brief The size of the report string in the shard's text
+    u32 text_size;
+    /// @brief The source information of the report
+    Option<SourceInfo> src_info;
+    /// @brief The report number
+    Option<ReportNumber> nb;
+    /// @brief The kind of report
+    ReportKind kind;
+  };
+
+  /// @brief Saves all reports to be forwarded later on.
+  /// The strings of the reports are copied into a single buffer,
+  /// the source informations must outlive the call to 'clear'.
+  class BufferReporter
+  {
+    /// @brief The saved reports
+    Vector<BufferedReport> reports = make_vector<BufferedReport>();
+    /// @brief The text of all the saved reports
+    std::string text = {};
+    /// @brief The beginning of the current file (or nullptr)
+    const u8* file_begin = nullptr;
+    /// @brief The size of the current file
+    u64 file_size = 0;
+    /// @brief The offset of the last report of the current file
+    u64 last_offset = 0;
+    /// @brief The ID of the current file
+    u32 file_id = 0;
+    /// @brief The number of reports of the current file
+    u32 sequence = 0;
+    /// @brief The files begun since the last 'clear', with their ID
+    std::vector<std::pair<u32, SourceFile>> files = {};
+
+    /// @brief Saves a report
+    /// @param kind The kind of the report
+    /// @param str The report string
+    /// @param src_info The source information if it exist
+    /// @param nb The report number if it exist
+    void push(
+        ReportKind kind, u8StringView str, const Option<SourceInfo>& src_info,
+        const Option<ReportNumber>& nb) noexcept
+    {
+      if (src_info.is_value() && file_begin != nullptr)
+      {
+        auto ptr = reinterpret_cast<const u8*>(src_info->expr.data());
+        if (file_begin <= ptr && ptr <= file_begin + file_size)
+          last_offset = static_cast<u64>(ptr - file_begin);
+      }
+      reports.push_back(BufferedReport{
+          last_offset, file_id, sequence++, static_cast<u32>(text.size()),
+          static_cast<u32>(str.size()), src_info, nb, kind});
+      text.append(reinterpret_cast<const char*>(str.data()), str.size());
+    }
+
+  public:
+    /// @brief Starts saving reports for a new file.
+    /// @param id The ID of the file (used for ordering)
+    /// @param content The content of the file (used to compute offsets)
+    /// @param path The path of the file (forwarded to file aware reporters)
+    void begin_file(u32 id, View<u8> content, std::string_view path = {}) noexcept
+    {
+      file_begin  = content.data();
+      file_size   = content.size();
+      last_offset = 0;
+      file_id     = id;
+      sequence    = 0;
+      files.emplace_back(id, SourceFile{path, content});
+    }
+
+    /// @brief Saves a message
+    /// @param str The message
+    /// @param src_info The source information if it exist
+    /// @param nb The report information if it exist
+    void message(
+        u8StringView str, const Option<SourceInfo>& src_info,
+        const Option<ReportNumber>& nb) noexcept
+    {
+      push(ReportKind::MESSAGE, str, src_info, nb);
+    }
+
+    /// @brief Saves a warning
+    /// @param str The warning
+    /// @param src_info The source information if it exist
+    /// @param nb The report information if it exist
+    void warn(
+        u8StringView str, const Option<SourceInfo>& src_info,
+        const Option<ReportNumber>& nb) noexcept
+    {
+      push(ReportKind::WARNING, str, src_info, nb);
+    }
+
+    /// @brief Saves an error
+    /// @param str The error
+    /// @param src_info The source information if it exist
+    /// @param nb The report information if it exist
+    void error(
+        u8StringView str, const Option<SourceInfo>& src_info,
+        const Option<ReportNumber>& nb) noexcept
+    {
+      push(ReportKind::ERROR, str, src_info, nb);
+    }
+
+    /// @brief Returns the saved reports
+    /// @return The saved reports
+    const Vector<BufferedReport>& buffered() const noexcept { return reports; }
+
+    /// @brief Returns the files begun since the last 'clear'
+    /// @return The files and their ID
+    const std::vector<std::pair<u32, SourceFile>>& begun() const noexcept
+    {
+      return files;
+    }
+
+    /// @brief Returns the string of a saved report
+    /// @param report The report (owned by this reporter)
+    /// @return The string of the report
+    u8StringView text_of(const BufferedReport& report) const noexcept
+    {
+      return u8StringView{
+          reinterpret_cast<const Char8*>(text.data()) + report.text_offset,
+          report.text_size};
+    }
+
+    /// @brief Clears all the saved reports
+    void clear() noexcept
+    {
+      reports.clear();
+      text.clear();
+      files.clear();
+    }
+  };
+
+  template<Reporter Rep>
+  /// @brief Reporter that can be shared by multiple workers.
+  /// Workers must only use the shard whose index is their worker index.
+  /// 'flush' and the count methods must only be called when no worker
+  /// is reporting (usually at the end of a phase).
+  /// @tparam Rep The reporter to which to forward the merged reports
+  class ConcurrentReporter : public Rep
+  {
+    /// @brief The type of the shards
+    using Shard = details::ToErrorReporter<BufferReporter>;
+
+    /// @brief The shards (one per worker).
+    /// Each shard is allocated separately to avoid false sharing.
+    Vector<UniquePtr<Shard>> shards = make_vector<UniquePtr<Shard>>();
+    /// @brief The error limit of each file (0 for no limit)
+    u64 error_limit = 0;
+
+  public:
+    ConcurrentReporter()                          = delete;
+    ConcurrentReporter(ConcurrentReporter&&)      = default;
+    ConcurrentReporter(const ConcurrentReporter&) = delete;
+
+    template<typename... Args>
+    /// @brief Constructor
+    /// @param workers The number of workers (at least 1)
+    /// @param args Arguments to forward to the constructor of 'Rep'
+    ConcurrentReporter(u32 workers, Args&&... args) noexcept(
+        std::is_nothrow_constructible_v<Rep, Args...>)
+        : Rep(std::forward<Args>(args)...)
+    {
+      assert_true("ConcurrentReporter requires at least 1 worker!", workers != 0);
+      for (u32 i = 0; i < workers; i++)
+        shards.push_back(make_error_reporter<BufferReporter>());
+    }
+
+    /// @brief Flushes the reports on destruction
+    ~ConcurrentReporter() noexcept { flush(); }
+
+    /// @brief Returns the number of workers
+    /// @return The number of workers
+    u32 worker_count() const noexcept { return static_cast<u32>(shards.size()); }
+
+    /// @brief Returns the reporter to use for worker 'worker'
+    /// @param worker The worker index
+    /// @return The reporter to use for that worker
+    ErrorReporter& shard(u32 worker) noexcept
+    {
+      assert_true("Invalid worker index!", worker < shards.size());
+      return *shards[worker];
+    }
+
+    /// @brief Sets the number of errors after which a file is abandoned.
+    /// This must be called before any worker starts.
+    /// @param limit The error limit (or 0 for no limit)
+    void set_error_limit(u64 limit) noexcept { error_limit = limit; }
+
+    /// @brief Must be called by a worker before processing a file.
+    /// This also resets the error limit of the worker's shard.
+    /// The content of the file must outlive the next call to 'flush'.
+    /// @param worker The worker index
+    /// @param file_id The ID of the file (determines the output order)
+    /// @param content The content of the file
+    /// @param path The path of the file (forwarded to 'Rep' if it is
+    ///             a FileAwareReporter)
+    void begin_file(
+        u32 worker, u32 file_id, View<u8> content,
+        std::string_view path = {}) noexcept
+    {
+      assert_true("Invalid worker index!", worker < shards.size());
+      shards[worker]->begin_file(file_id, content, path);
+      shards[worker]->set_error_limit(error_limit);
+    }
+
+    /// @brief Returns the count of errors generated by all the workers
+    /// @return The count of errors
+    u64 error_count() const noexcept
+    {
+      u64 count = 0;
+      for (auto& i : shards)
+        count += i->error_count();
+      return count;
+    }
+
+    /// @brief Returns the count of warnings generated by all the workers
+    /// @return The count of warnings
+    u64 warn_count() const noexcept
+    {
+      u64 count = 0;
+      for (auto& i : shards)
+        count += i->warn_count();
+      return count;
+    }
+
+    /// @brief Returns the count of messages generated by all the workers
+    /// @return The count of messages
+    u64 message_count() const noexcept
+    {
+      u64 count = 0;
+      for (auto& i : shards)
+        count += i->message_count();
+      return count;
+    }
+
+    /// @brief Merges the reports of all the workers, and forwards them
+    /// to 'Rep' ordered by file, source position, then generation order.
+    /// 'Rep' is then flushed if it is a FlushableReporter.
+    void flush() noexcept
+    {
+      COLT_TRACE_FN_C(clt::Color::Gold);
+      using Entry = std::pair<const BufferReporter*, const BufferedReport*>;
+
+      size_t total = 0;
+      for (auto& i : shards)
+        total += i->buffered().size();
+      if (total == 0)
+      {
+        // The files registered by 'begin_file' are forgotten all the same
+        for (auto& i : shards)
+          i->clear();
+        if constexpr (FlushableReporter<Rep>)
+          Rep::flush();
+        return;
+      }
+
+      std::vector<Entry> merged;
+      merged.reserve(total);
+      for (auto& i : shards)
+        for (auto& report : i->buffered())
+          merged.emplace_back(&*i, &report);
+
+      std::sort(
+          merged.begin(), merged.end(),
+          [](const Entry& a, const Entry& b)
+          {
+            const auto& ra = *a.second;
+            const auto& rb = *b.second;
+            if (ra.file_id != rb.file_id)
+              return ra.file_id < rb.file_id;
+            if (ra.byte_offset != rb.byte_offset)
+              return ra.byte_offset < rb.byte_offset;
+            return ra.sequence < rb.sequence;
+          });
+
+      // The files of the reports, ordered like the reports
+      std::vector<std::pair<u32, SourceFile>> files;
+      if constexpr (FileAwareReporter<Rep>)
+      {
+        for (auto& i : shards)
+          files.insert(files.end(), i->begun().begin(), i->begun().end());
+        std::sort(
+            files.begin(), files.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+      }
+      auto file = files.begin();
+
+      for (auto& [shard, report] : merged)
+      {
+        if constexpr (FileAwareReporter<Rep>)
+        {
+          // Skips the files without reports, then switches file once
+          while (file != files.end() && file->first < report->file_id)
+            ++file;
+          if (file != files.end() && file->first == report->file_id)
+            Rep::set_file((file++)->second);
+        }
+        auto str = shard->text_of(*report);
+        switch_no_default(report->kind)
+        {
+        case ReportKind::MESSAGE:
+          Rep::message(str, report->src_info, report->nb);
+          break;
+        case ReportKind::WARNING:
+          Rep::warn(str, report->src_info, report->nb);
+          break;
+        case ReportKind::ERROR:
+          Rep::error(str, report->src_info, report->nb);
+          break;
+        }
+      }
+      for (auto& i : shards)
+        i->clear();
+      if constexpr (FlushableReporter<Rep>)
+        Rep::flush();
+    }
+  };
+} // namespace clt::lng
+
+#endif // !HG_COLTC_CONCURRENT_REPORTER
@@ -8,6 +8,7 @@
 #ifndef HG_COLTC_ERROR_REPORTER
 #define HG_COLTC_ERROR_REPORTER
 
+#include <limits>
 #include <colt/dsa/option.h>
 #include <colt/dsa/string_view.h>
 #include <colt/dsa/smart_pointers.h>
@@ -31,6 +32,10 @@ namespace clt::lng
     } -> std::same_as<void>;
   };
 
+  /// @brief A reporter that holds reports back until 'flush' is called
+  template<typename T>
+  concept FlushableReporter = requires(T reporter) { reporter.flush(); };
+
   /// @brief What is the diagnostic type
   enum class ReportKind : u8
   {
@@ -60,6 +65,10 @@ namespace clt::lng
     u64 _warn_count = 0;
     /// @brief The message count
     u64 _message_count = 0;
+    /// @brief The error count at which cancellation is requested
+    u64 _error_limit = std::numeric_limits<u64>::max();
+    /// @brief True if the current compilation unit should be abandoned
+    bool _cancelled = false;
 
   public:
     /// @brief Reports a message
@@ -94,6 +103,26 @@ namespace clt::lng
     /// @return The count of messages
     u64 message_count() const noexcept { return _message_count; }
 
+    /// @brief Sets the number of errors after which cancellation is requested.
+    /// The limit is relative to the current error count, and resets
+    /// the cancellation flag.
+    /// @param limit The error limit (or 0 for no limit)
+    void set_error_limit(u64 limit) noexcept
+    {
+      _cancelled   = false;
+      _error_limit = limit == 0 ? std::numeric_limits<u64>::max()
+                                : _error_count + limit;
+    }
+
+    /// @brief Requests the current compilation unit to be abandoned
+    void cancel() noexcept { _cancelled = true; }
+
+    /// @brief Check if the current compilation unit should be abandoned.
+    /// This is set once the error limit is reached, and is cheap enough
+    /// to be checked in the dispatch loops of the compiler phases.
+    /// @return True if the compilation unit should be abandoned
+    bool is_cancelled() const noexcept { return _cancelled; }
+
     /// @brief Destructor
     virtual ~ErrorReporter() noexcept {};
   };
@@ -133,8 +162,9 @@ namespace clt::lng
           u8StringView str, const Option<SourceInfo>& src_info = None,
           const Option<ReportNumber>& msg_nb = None) noexcept override
       {
-        ++ErrorReporter::_error_count;
         Rep::error(str, src_info, msg_nb);
+        if (++ErrorReporter::_error_count == ErrorReporter::_error_limit)
+          ErrorReporter::_cancelled = true;
       }
 
       ~ToErrorReporter() override{};
@@ -149,7 +179,8 @@ namespace clt::lng
   auto make_error_reporter(Args&&... args) noexcept(
       std::is_nothrow_constructible_v<Rep, Args...>)
   {
-    return make_unique<details::ToErrorReporter<Rep>>(std::forward<Args>(args)...);
+    return clt::make_unique<details::ToErrorReporter<Rep>>(
+        std::forward<Args>(args)...);
   }
 } // namespace clt::lng
 
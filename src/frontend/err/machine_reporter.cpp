@@ -0,0 +1,290 @@
+/*****************************************************************/ /**
+ * @file   machine_reporter.cpp
+ * @brief  Implementation of JSONLinesReporter and SARIFReporter.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include <charconv>
+#include <colt/versions.h>
+#include <colt_config.h>
+#include "machine_reporter.h"
+
+namespace clt::lng
+{
+  void BufferedWriter::flush() noexcept
+  {
+    if (used == 0)
+      return;
+    std::fwrite(buffer.get(), 1, used, file);
+    std::fflush(file);
+    used = 0;
+  }
+
+  void BufferedWriter::write_u64(u64 value) noexcept
+  {
+    char str[24];
+    auto [ptr, _] = std::to_chars(str, str + sizeof(str), value);
+    write(std::string_view{str, static_cast<size_t>(ptr - str)});
+  }
+
+  void BufferedWriter::write_json_string(std::string_view str) noexcept
+  {
+    static constexpr char HEX[] = "0123456789abcdef";
+    // Most strings are valid UTF8: only escape bytes >= 0x80 if not
+    const bool is_valid_utf8 = simdutf::validate_utf8(str.data(), str.size());
+
+    write('"');
+    const char* run = str.data();
+    for (const char* ptr = str.data(); ptr != str.data() + str.size(); ptr++)
+    {
+      const auto chr = static_cast<u8>(*ptr);
+      if (chr >= 0x20 && chr != '"' && chr != '\\' && (chr < 0x80 || is_valid_utf8))
+        continue;
+      // Write the run of characters that do not require escaping
+      write(std::string_view{run, static_cast<size_t>(ptr - run)});
+      run = ptr + 1;
+      switch (chr)
+      {
+      case '"':
+        write("\\\"");
+        break;
+      case '\\':
+        write("\\\\");
+        break;
+      case '\n':
+        write("\\n");
+        break;
+      case '\r':
+        write("\\r");
+        break;
+      case '\t':
+        write("\\t");
+        break;
+      default:
+        write("\\u00");
+        write(HEX[chr >> 4]);
+        write(HEX[chr & 0xF]);
+      }
+    }
+    write(std::string_view{run, static_cast<size_t>(str.data() + str.size() - run)});
+    write('"');
+  }
+
+  namespace details
+  {
+    ReportLocation compute_location(
+        const SourceInfo& src_info, const SourceFile& file) noexcept
+    {
+      const auto lines     = to_strv(src_info.lines);
+      const auto expr      = to_strv(src_info.expr);
+      const char* expr_end = expr.data() + expr.size();
+
+      // The expression may span multiple lines: the end column is
+      // computed from the beginning of the last line of the expression.
+      const char* last_line = lines.data();
+      for (const char* ptr = expr.data(); ptr != expr_end; ptr++)
+        if (*ptr == '\n')
+          last_line = ptr + 1;
+
+      ReportLocation loc = {
+          None,
+          src_info.line_begin,
+          static_cast<u32>(expr.data() - lines.data()) + 1,
+          src_info.line_end,
+          static_cast<u32>(expr_end - last_line) + 1};
+
+      auto begin = reinterpret_cast<const char*>(file.content.data());
+      if (begin != nullptr && begin <= expr.data()
+          && expr_end <= begin + file.content.size())
+        loc.byte_offset = static_cast<u64>(expr.data() - begin);
+      return loc;
+    }
+
+    void write_report_id(
+        BufferedWriter& out, ReportKind kind, const Option<ReportNumber>& nb) noexcept
+    {
+      if (nb.is_none())
+      {
+        out.write("null");
+        return;
+      }
+      static constexpr char KIND[] = {'M', 'W', 'E'};
+      char str[16]                 = {'"', KIND[static_cast<u8>(kind)]};
+      auto [ptr, _] = std::to_chars(str + 2, str + sizeof(str) - 1, *nb);
+      // Pad to DiagnosticEntry::ENTRY_ID_DIGITS like in '.colt.diag' files
+      if (const auto digits = ptr - (str + 2); digits < 4)
+      {
+        std::memmove(str + 2 + (4 - digits), str + 2, static_cast<size_t>(digits));
+        std::memset(str + 2, '0', static_cast<size_t>(4 - digits));
+        ptr += 4 - digits;
+      }
+      *ptr++ = '"';
+      out.write(std::string_view{str, static_cast<size_t>(ptr - str)});
+    }
+
+    std::string path_to_uri(std::string_view path)
+    {
+      static constexpr char HEX[] = "0123456789ABCDEF";
+      std::string uri;
+      uri.reserve(path.size() + 8);
+#ifdef COLT_WINDOWS
+      // 'C:\dir', '\dir' and '\\server\share' are absolute
+      const bool has_drive = path.size() >= 2 && path[1] == ':';
+      const bool absolute =
+          has_drive || path.starts_with('/') || path.starts_with('\\');
+#else
+      const bool absolute = path.starts_with('/');
+#endif // COLT_WINDOWS
+      if (absolute)
+        uri = "file://";
+#ifdef COLT_WINDOWS
+      if (has_drive)
+      {
+        uri += '/';
+        uri += path.substr(0, 2);
+        path.remove_prefix(2);
+      }
+#endif // COLT_WINDOWS
+      for (char chr : path)
+      {
+        const auto byte = static_cast<u8>(chr);
+        if (('a' <= chr && chr <= 'z') || ('A' <= chr && chr <= 'Z')
+            || ('0' <= chr && chr <= '9') || chr == '-' || chr == '.'
+            || chr == '_' || chr == '~' || chr == '/')
+          uri += chr;
+#ifdef COLT_WINDOWS
+        else if (chr == '\\')
+          uri += '/';
+#endif // COLT_WINDOWS
+        else
+        {
+          uri += '%';
+          uri += HEX[byte >> 4];
+          uri += HEX[byte & 0xF];
+        }
+      }
+      return uri;
+    }
+
+    /// @brief Returns the severity of a report as a string
+    /// @param kind The kind of report
+    /// @param sarif True to use the names of SARIF levels
+    /// @return The severity
+    static std::string_view severity_of(ReportKind kind, bool sarif) noexcept
+    {
+      switch_no_default(kind)
+      {
+      case ReportKind::MESSAGE:
+        return sarif ? "note" : "message";
+      case ReportKind::WARNING:
+        return "warning";
+      case ReportKind::ERROR:
+        return "error";
+      }
+    }
+  } // namespace details
+
+  void JSONLinesReporter::write(
+      ReportKind kind, u8StringView str, const Option<SourceInfo>& src_info,
+      const Option<ReportNumber>& nb) noexcept
+  {
+    using namespace details;
+
+    out.write("{\"id\":");
+    write_report_id(out, kind, nb);
+    out.write(",\"severity\":\"");
+    out.write(severity_of(kind, false));
+    out.write("\",\"file\":");
+    out.write_json_string(file.path);
+    if (src_info.is_value())
+    {
+      auto loc = compute_location(*src_info, file);
+      out.write(",\"offset\":");
+      if (loc.byte_offset.is_value())
+        out.write_u64(*loc.byte_offset);
+      else
+        out.write("null");
+      out.write(",\"length\":");
+      out.write_u64(src_info->expr.unit_len());
+      out.write(",\"line\":");
+      out.write_u64(loc.line_begin);
+      out.write(",\"column\":");
+      out.write_u64(loc.column_begin);
+      out.write(",\"end_line\":");
+      out.write_u64(loc.line_end);
+      out.write(",\"end_column\":");
+      out.write_u64(loc.column_end);
+    }
+    out.write(",\"message\":");
+    out.write_json_string(to_strv(str));
+    if (src_info.is_value())
+    {
+      out.write(",\"expr\":");
+      out.write_json_string(to_strv(src_info->expr));
+    }
+    out.write("}\n");
+  }
+
+  SARIFReporter::SARIFReporter(std::FILE* output) noexcept
+      : out(output)
+  {
+    out.write(
+        "{\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\","
+        "\"version\":\"2.1.0\",\"runs\":[{\"tool\":{\"driver\":{"
+        "\"name\":\"coltc\",\"version\":\"");
+    out.write(fmt::format("{}", vers::ColtcVersion));
+    out.write("\"}},\"results\":[");
+  }
+
+  SARIFReporter::~SARIFReporter() noexcept
+  {
+    out.write("]}]}\n");
+  }
+
+  void SARIFReporter::write(
+      ReportKind kind, u8StringView str, const Option<SourceInfo>& src_info,
+      const Option<ReportNumber>& nb) noexcept
+  {
+    using namespace details;
+
+    out.write(is_first ? "{" : ",\n{");
+    is_first = false;
+    if (nb.is_value())
+    {
+      out.write("\"ruleId\":");
+      write_report_id(out, kind, nb);
+      out.write(',');
+    }
+    out.write("\"level\":\"");
+    out.write(severity_of(kind, true));
+    out.write("\",\"message\":{\"text\":");
+    out.write_json_string(to_strv(str));
+    out.write("},\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":");
+    out.write_json_string(path_to_uri(file.path));
+    out.write('}');
+    if (src_info.is_value())
+    {
+      auto loc = compute_location(*src_info, file);
+      out.write(",\"region\":{\"startLine\":");
+      out.write_u64(loc.line_begin);
+      out.write(",\"startColumn\":");
+      out.write_u64(loc.column_begin);
+      out.write(",\"endLine\":");
+      out.write_u64(loc.line_end);
+      out.write(",\"endColumn\":");
+      out.write_u64(loc.column_end);
+      if (loc.byte_offset.is_value())
+      {
+        out.write(",\"byteOffset\":");
+        out.write_u64(*loc.byte_offset);
+        out.write(",\"byteLength\":");
+        out.write_u64(src_info->expr.unit_len());
+      }
+      out.write(",\"snippet\":{\"text\":");
+      out.write_json_string(to_strv(src_info->expr));
+      out.write("}}");
+    }
+    out.write("}}]}");
+  }
+} // namespace clt::lng
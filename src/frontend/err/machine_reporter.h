@@ -0,0 +1,266 @@
+/*****************************************************************/ /**
+ * @file   machine_reporter.h
+ * @brief  Contains reporters whose output is meant to be consumed
+ *         by tools (CI, IDEs) rather than by humans.
+ * JSONLinesReporter writes one JSON object per line for each report.
+ * SARIFReporter writes a SARIF 2.1.0 log.
+ * Both stream their output through a BufferedWriter: no DOM is built,
+ * and each report costs a few appends to a buffer.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_COLTC_MACHINE_REPORTER
+#define HG_COLTC_MACHINE_REPORTER
+
+#include <cstdio>
+#include <memory>
+#include "error_reporter.h"
+
+namespace clt::lng
+{
+  /// @brief A source file, used by reporters that need to know
+  ///        the file from which a report originates.
+  struct SourceFile
+  {
+    /// @brief The path of the file
+    std::string_view path;
+    /// @brief The content of the file
+    View<u8> content;
+  };
+
+  /// @brief A reporter that needs to know the file being processed
+  template<typename T>
+  concept FileAwareReporter =
+      requires(T reporter, const SourceFile& file) { reporter.set_file(file); };
+
+  /// @brief Buffered writer over a FILE*.
+  /// The buffer is only flushed when full, on 'flush', and on destruction.
+  class BufferedWriter
+  {
+    /// @brief The size of the buffer
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    /// @brief The file to which to write
+    std::FILE* file;
+    /// @brief The buffer
+    std::unique_ptr<char[]> buffer = std::make_unique<char[]>(BUFFER_SIZE);
+    /// @brief The number of bytes used in the buffer
+    size_t used = 0;
+
+  public:
+    /// @brief Constructor
+    /// @param file The file to which to write (not owned)
+    BufferedWriter(std::FILE* file) noexcept
+        : file(file)
+    {
+    }
+
+    BufferedWriter(BufferedWriter&&)                 = delete;
+    BufferedWriter(const BufferedWriter&)            = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    /// @brief Flushes the buffer
+    ~BufferedWriter() noexcept { flush(); }
+
+    /// @brief Writes the content of the buffer to the file
+    void flush() noexcept;
+
+    /// @brief Writes a string
+    /// @param str The string to write
+    void write(std::string_view str) noexcept
+    {
+      if (used + str.size() > BUFFER_SIZE)
+      {
+        flush();
+        if (str.size() > BUFFER_SIZE)
+        {
+          std::fwrite(str.data(), 1, str.size(), file);
+          return;
+        }
+      }
+      std::memcpy(buffer.get() + used, str.data(), str.size());
+      used += str.size();
+    }
+
+    /// @brief Writes a character
+    /// @param chr The character to write
+    void write(char chr) noexcept
+    {
+      if (used == BUFFER_SIZE)
+        flush();
+      buffer[used++] = chr;
+    }
+
+    /// @brief Writes an integer
+    /// @param value The integer to write
+    void write_u64(u64 value) noexcept;
+
+    /// @brief Writes a JSON string (including the quotes).
+    /// Bytes that are not part of valid UTF8 are escaped as if
+    /// they were Latin-1, so that the output is always valid JSON.
+    /// @param str The string to escape and write
+    void write_json_string(std::string_view str) noexcept;
+  };
+
+  namespace details
+  {
+    /// @brief The location of a report, computed from its SourceInfo
+    struct ReportLocation
+    {
+      /// @brief The byte offset of the expression in the file (or None)
+      Option<u64> byte_offset;
+      /// @brief The 1-based beginning line
+      u32 line_begin;
+      /// @brief The 1-based beginning column (in bytes)
+      u32 column_begin;
+      /// @brief The 1-based end line
+      u32 line_end;
+      /// @brief The 1-based end column (in bytes, exclusive)
+      u32 column_end;
+    };
+
+    /// @brief Computes the location of a report
+    /// @param src_info The source information of the report
+    /// @param file The file in which the report was generated
+    /// @return The location of the report
+    ReportLocation compute_location(
+        const SourceInfo& src_info, const SourceFile& file) noexcept;
+
+    /// @brief Converts a u8StringView to a std::string_view
+    /// @param strv The string to convert
+    /// @return std::string_view over the same bytes
+    inline std::string_view to_strv(u8StringView strv) noexcept
+    {
+      return std::string_view{
+          reinterpret_cast<const char*>(strv.data()), strv.unit_len()};
+    }
+
+    /// @brief Writes the ID of a report ([MWE][0-9]{4} or null)
+    /// @param out The writer
+    /// @param kind The kind of the report
+    /// @param nb The report number
+    void write_report_id(
+        BufferedWriter& out, ReportKind kind, const Option<ReportNumber>& nb) noexcept;
+
+    /// @brief Converts a path to the URI expected by SARIF.
+    /// Relative paths become relative URI references, absolute paths
+    /// become 'file://' URIs. Bytes outside of the unreserved set of
+    /// RFC 3986 (and '/') are percent-encoded.
+    /// @param path The path to convert
+    /// @return The URI
+    std::string path_to_uri(std::string_view path);
+  } // namespace details
+
+  /// @brief Writes each report as a single JSON object on its own line.
+  /// Example:
+  /// {"id":"E0001","severity":"error","file":"a.ct","offset":4,"length":1,
+  ///  "line":1,"column":5,"end_line":1,"end_column":6,"message":"...","expr":"$"}
+  class JSONLinesReporter
+  {
+    /// @brief The output
+    BufferedWriter out;
+    /// @brief The current file
+    SourceFile file = {};
+
+    /// @brief Writes a report
+    void write(
+        ReportKind kind, u8StringView str, const Option<SourceInfo>& src_info,
+        const Option<ReportNumber>& nb) noexcept;
+
+  public:
+    /// @brief Constructor
+    /// @param output The file to which to write (not owned)
+    JSONLinesReporter(std::FILE* output = stdout) noexcept
+        : out(output)
+    {
+    }
+
+    /// @brief Sets the file in which the next reports are generated
+    /// @param src The source file
+    void set_file(const SourceFile& src) noexcept { file = src; }
+
+    /// @brief Writes a message
+    void message(
+        u8StringView str, const Option<SourceInfo>& src_info,
+        const Option<ReportNumber>& nb) noexcept
+    {
+      write(ReportKind::MESSAGE, str, src_info, nb);
+    }
+
+    /// @brief Writes a warning
+    void warn(
+        u8StringView str, const Option<SourceInfo>& src_info,
+        const Option<ReportNumber>& nb) noexcept
+    {
+      write(ReportKind::WARNING, str, src_info, nb);
+    }
+
+    /// @brief Writes an error
+    void error(
+        u8StringView str, const Option<SourceInfo>& src_info,
+        const Option<ReportNumber>& nb) noexcept
+    {
+      write(ReportKind::ERROR, str, src_info, nb);
+    }
+  };
+
+  /// @brief Writes the reports as a SARIF 2.1.0 log.
+  /// The beginning of the log is written on construction, each report
+  /// is appended to the 'results' array, and the log is closed on destruction.
+  class SARIFReporter
+  {
+    /// @brief The output
+    BufferedWriter out;
+    /// @brief The current file
+    SourceFile file = {};
+    /// @brief True if no result was written yet
+    bool is_first = true;
+
+    /// @brief Writes a report
+    void write(
+        ReportKind kind, u8StringView str, const Option<SourceInfo>& src_info,
+        const Option<ReportNumber>& nb) noexcept;
+
+  public:
+    /// @brief Constructor, writes the beginning of the log
+    /// @param output The file to which to write (not owned)
+    SARIFReporter(std::FILE* output = stdout) noexcept;
+
+    SARIFReporter(SARIFReporter&&)      = delete;
+    SARIFReporter(const SARIFReporter&) = delete;
+
+    /// @brief Destructor, writes the end of the log
+    ~SARIFReporter() noexcept;
+
+    /// @brief Sets the file in which the next reports are generated
+    /// @param src The source file
+    void set_file(const SourceFile& src) noexcept { file = src; }
+
+    /// @brief Writes a message
+    void message(
+        u8StringView str, const Option<SourceInfo>& src_info,
+        const Option<ReportNumber>& nb) noexcept
+    {
+      write(ReportKind::MESSAGE, str, src_info, nb);
+    }
+
+    /// @brief Writes a warning
+    void warn(
+        u8StringView str, const Option<SourceInfo>& src_info,
+        const Option<ReportNumber>& nb) noexcept
+    {
+      write(ReportKind::WARNING, str, src_info, nb);
+    }
+
+    /// @brief Writes an error
+    void error(
+        u8StringView str, const Option<SourceInfo>& src_info,
+        const Option<ReportNumber>& nb) noexcept
+    {
+      write(ReportKind::ERROR, str, src_info, nb);
+    }
+  };
+} // namespace clt::lng
+
+#endif // !HG_COLTC_MACHINE_REPORTER
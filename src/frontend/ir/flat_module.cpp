@@ -0,0 +1,139 @@
+/*****************************************************************/ /**
+ * @file   flat_module.cpp
+ * @brief  Implementation of the flat module format.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include "flat_module.h"
+#include <unordered_map>
+
+namespace clt::lng
+{
+  FlatModuleWriter::FlatModuleWriter() noexcept
+  {
+    // The header is written by 'finish'
+    buffer.resize(sizeof(FlatHeader));
+  }
+
+  u64 FlatModuleWriter::append(const void* data, size_t size) noexcept
+  {
+    const u64 offset =
+        (buffer.size() + FlatHeader::ALIGNMENT - 1) & ~(FlatHeader::ALIGNMENT - 1);
+    buffer.resize(offset + size);
+    if (size != 0)
+      std::memcpy(buffer.data() + offset, data, size);
+    return offset;
+  }
+
+  std::vector<u8> FlatModuleWriter::finish() && noexcept
+  {
+    auto table_offset =
+        append(sections.data(), sections.size() * sizeof(FlatSection));
+    // The total size is aligned so that modules can be concatenated
+    buffer.resize(
+        (buffer.size() + FlatHeader::ALIGNMENT - 1) & ~(FlatHeader::ALIGNMENT - 1));
+
+    FlatHeader header;
+    header.magic         = FlatHeader::MAGIC;
+    header.version       = FlatHeader::CURRENT_VERSION;
+    header.endian_marker = FlatHeader::ENDIAN_MARKER;
+    header.total_size    = buffer.size();
+    header.table_offset  = table_offset;
+    header.section_count = static_cast<u32>(sections.size());
+    header.reserved      = 0;
+    std::memcpy(buffer.data(), &header, sizeof(FlatHeader));
+    return std::move(buffer);
+  }
+
+  Expect<FlatModule, FlatError> FlatModule::open(View<u8> bytes) noexcept
+  {
+    COLT_TRACE_FN_C(clt::Color::Gold);
+    if (bytes.size() < sizeof(FlatHeader)
+        || reinterpret_cast<uintptr_t>(bytes.data()) % FlatHeader::BUFFER_ALIGNMENT
+               != 0)
+      return {Error, FlatError::INVALID_BUFFER};
+
+    auto& header = *reinterpret_cast<const FlatHeader*>(bytes.data());
+    if (header.magic != FlatHeader::MAGIC)
+      return {Error, FlatError::INVALID_MAGIC};
+    if (header.version != FlatHeader::CURRENT_VERSION
+        || header.endian_marker != FlatHeader::ENDIAN_MARKER)
+      return {Error, FlatError::UNSUPPORTED_VERSION};
+    if (header.total_size > bytes.size())
+      return {Error, FlatError::INVALID_BUFFER};
+
+    const u64 size = header.total_size;
+    // Divisions avoid overflows on malicious inputs
+    if (header.table_offset % alignof(FlatSection) != 0 || header.table_offset > size
+        || header.section_count > (size - header.table_offset) / sizeof(FlatSection))
+      return {Error, FlatError::INVALID_SECTION};
+
+    auto flat = FlatModule{View<u8>{bytes.data(), static_cast<size_t>(size)}};
+    for (auto& sec : flat.sections())
+    {
+      if (sec.offset % FlatHeader::ALIGNMENT != 0 || sec.offset > size
+          || sec.element_size == 0
+          || sec.count > (size - sec.offset) / sec.element_size)
+        return {Error, FlatError::INVALID_SECTION};
+    }
+    return {std::move(flat)};
+  }
+
+  std::vector<u8> write_flat_lexemes(
+      const LexemesContext& ctx, View<u8> source) noexcept
+  {
+    COLT_TRACE_FN_C(clt::Color::Gold);
+    const auto* begin = reinterpret_cast<const Char8*>(source.data());
+
+    std::vector<FlatString> lines;
+    lines.reserve(ctx.line_buffer().size());
+    for (auto& line : ctx.line_buffer())
+      lines.push_back(
+          FlatString{static_cast<u64>(line.data() - begin), line.unit_len()});
+
+    std::vector<u8> strings;
+    std::vector<FlatString> identifiers;
+    // Each distinct identifier is stored once, whatever its occurrences
+    std::unordered_map<std::string_view, u32> interned;
+    std::vector<FlatToken> tokens;
+    tokens.reserve(ctx.token_buffer().size());
+    for (auto& token : ctx.token_buffer())
+    {
+      auto info = ctx.info(token);
+      FlatToken flat{
+          info.line_start, info.line_end, info.column_nb, info.size, 0,
+          static_cast<u8>(token.lexeme()), {}};
+      if (token.lexeme() == Lexeme::TKN_IDENTIFIER)
+      {
+        auto name = ctx.extract_identifier(token);
+        auto key  = std::string_view{
+            reinterpret_cast<const char*>(name.data()), name.unit_len()};
+        auto [it, inserted] =
+            interned.try_emplace(key, static_cast<u32>(identifiers.size()));
+        if (inserted)
+        {
+          identifiers.push_back(FlatString{strings.size(), key.size()});
+          strings.insert(strings.end(), key.begin(), key.end());
+        }
+        flat.literal = it->second;
+      }
+      tokens.push_back(flat);
+    }
+
+    FlatModuleWriter writer;
+    writer.add_section(
+        FlatSectionKind::SOURCE, Span<const u8>{source.data(), source.size()});
+    writer.add_section(
+        FlatSectionKind::LINES, Span<const FlatString>{lines.data(), lines.size()});
+    writer.add_section(
+        FlatSectionKind::STRINGS, Span<const u8>{strings.data(), strings.size()});
+    writer.add_section(
+        FlatSectionKind::IDENTIFIERS,
+        Span<const FlatString>{identifiers.data(), identifiers.size()});
+    writer.add_section(
+        FlatSectionKind::TOKENS,
+        Span<const FlatToken>{tokens.data(), tokens.size()});
+    return std::move(writer).finish();
+  }
+} // namespace clt::lng
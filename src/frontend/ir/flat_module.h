@@ -0,0 +1,250 @@
+/*****************************************************************/ /**
+ * @file   flat_module.h
+ * @brief  Contains the flat module format, used to hand the output of
+ *         the compiler to backends.
+ * A flat module is a single buffer that does not contain any pointer:
+ * it starts with a FlatHeader, followed by sections (arrays of plain
+ * structs aligned to FlatHeader::ALIGNMENT), followed by the section table.
+ * Sections refer to each other through indices and offsets only, so
+ * the same bytes can be passed in memory to a BACKEND plugin or saved
+ * to a file and mapped by an out-of-tree backend, without any
+ * (de)serialization step: FlatModule only validates the bounds once,
+ * then exposes each section as a Span over the buffer.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_COLTC_FLAT_MODULE
+#define HG_COLTC_FLAT_MODULE
+
+#include <vector>
+#include <frontend/lex/lexemes_context.h>
+
+namespace clt::lng
+{
+  /// @brief The kind of a section
+  enum class FlatSectionKind : u32
+  {
+    /// @brief The bytes of the source file (u8)
+    SOURCE,
+    /// @brief The bytes of the strings referenced by other sections (u8)
+    STRINGS,
+    /// @brief The tokens of the source file (FlatToken)
+    TOKENS,
+    /// @brief The distinct identifiers (FlatString into STRINGS)
+    IDENTIFIERS,
+    /// @brief The lines of the source file (FlatString into SOURCE)
+    LINES,
+  };
+
+  /// @brief The header of a flat module.
+  /// All offsets are from the beginning of the module, and all integers
+  /// are stored using the endianness of the machine that wrote the module.
+  struct FlatHeader
+  {
+    /// @brief The expected magic number
+    static constexpr std::array<char, 8> MAGIC = {'C', 'O', 'L', 'T',
+                                                  'F', 'L', 'A', 'T'};
+    /// @brief The current version of the format
+    static constexpr u32 CURRENT_VERSION = 1;
+    /// @brief The expected value of 'endian_marker'
+    static constexpr u32 ENDIAN_MARKER = 0x01020304;
+    /// @brief The alignment of each section (relative to the module)
+    static constexpr u64 ALIGNMENT = 16;
+    /// @brief The alignment required of the buffer of a module: that of
+    ///        the structs of the format, which any allocation provides
+    static constexpr u64 BUFFER_ALIGNMENT = alignof(u64);
+
+    /// @brief Must be equal to MAGIC
+    std::array<char, 8> magic;
+    /// @brief Must be equal to CURRENT_VERSION
+    u32 version;
+    /// @brief Must be equal to ENDIAN_MARKER (detects endianness mismatches)
+    u32 endian_marker;
+    /// @brief The size of the whole module in bytes
+    u64 total_size;
+    /// @brief The offset of the section table
+    u64 table_offset;
+    /// @brief The number of entries in the section table
+    u32 section_count;
+    /// @brief Reserved (0)
+    u32 reserved;
+  };
+
+  /// @brief An entry of the section table
+  struct FlatSection
+  {
+    /// @brief The kind of the section
+    FlatSectionKind kind;
+    /// @brief The size of an element of the section
+    u32 element_size;
+    /// @brief The offset of the section (multiple of FlatHeader::ALIGNMENT)
+    u64 offset;
+    /// @brief The number of elements of the section
+    u64 count;
+  };
+
+  /// @brief A string stored in another section
+  struct FlatString
+  {
+    /// @brief The offset of the string in its section
+    u64 offset;
+    /// @brief The size of the string in bytes
+    u64 size;
+  };
+
+  /// @brief A token of the TOKENS section
+  struct FlatToken
+  {
+    /// @brief The 0-based beginning line of the token
+    u32 line;
+    /// @brief The 0-based end line of the token
+    u32 line_end;
+    /// @brief The 0-based column of the token
+    u32 column;
+    /// @brief The size of the token in bytes
+    u32 size;
+    /// @brief The index of the identifier in IDENTIFIERS (if an identifier)
+    u32 literal;
+    /// @brief The Lexeme of the token
+    u8 lexeme;
+    /// @brief Reserved (0)
+    u8 reserved[3];
+  };
+
+  static_assert(sizeof(FlatHeader) == 40 && sizeof(FlatSection) == 24);
+  static_assert(sizeof(FlatString) == 16 && sizeof(FlatToken) == 24);
+  static_assert(
+      alignof(FlatHeader) <= FlatHeader::BUFFER_ALIGNMENT
+      && alignof(FlatSection) <= FlatHeader::BUFFER_ALIGNMENT
+      && alignof(FlatString) <= FlatHeader::BUFFER_ALIGNMENT
+      && alignof(FlatToken) <= FlatHeader::BUFFER_ALIGNMENT);
+
+  /// @brief Writes a flat module.
+  /// The sections are appended to a single buffer as they are added,
+  /// and the header is patched by 'finish': each section is copied once.
+  class FlatModuleWriter
+  {
+    /// @brief The module being written
+    std::vector<u8> buffer;
+    /// @brief The section table
+    std::vector<FlatSection> sections;
+
+    /// @brief Appends bytes to the buffer, after aligning it
+    /// @param data The bytes
+    /// @param size The number of bytes
+    /// @return The offset of the bytes
+    u64 append(const void* data, size_t size) noexcept;
+
+  public:
+    /// @brief Constructor
+    FlatModuleWriter() noexcept;
+
+    template<typename T>
+    /// @brief Adds a section
+    /// @tparam T The type of the elements (must be trivially copyable)
+    /// @param kind The kind of the section
+    /// @param elements The elements of the section
+    void add_section(FlatSectionKind kind, Span<const T> elements) noexcept
+    {
+      static_assert(std::is_trivially_copyable_v<T>);
+      auto offset = append(elements.data(), elements.size() * sizeof(T));
+      sections.push_back(
+          FlatSection{kind, static_cast<u32>(sizeof(T)), offset, elements.size()});
+    }
+
+    /// @brief Appends the section table and writes the header
+    /// @return The module
+    std::vector<u8> finish() && noexcept;
+  };
+
+  /// @brief Possible errors when opening a flat module
+  enum class FlatError : u8
+  {
+    /// @brief The buffer is too small or not aligned
+    INVALID_BUFFER,
+    /// @brief The magic number does not match
+    INVALID_MAGIC,
+    /// @brief The version or byte order is not supported
+    UNSUPPORTED_VERSION,
+    /// @brief A section or the table is out of bounds
+    INVALID_SECTION,
+  };
+
+  /// @brief A read-only view over a flat module.
+  /// The module is validated once on opening: accessing a section
+  /// does not perform any copy.
+  class FlatModule
+  {
+    /// @brief The bytes of the module
+    View<u8> bytes;
+
+    /// @brief Constructor
+    FlatModule(View<u8> bytes) noexcept
+        : bytes(bytes)
+    {
+    }
+
+  public:
+    /// @brief Validates and opens a flat module
+    /// @param bytes The bytes of the module (aligned to
+    ///              FlatHeader::BUFFER_ALIGNMENT)
+    /// @return The module or an error
+    static Expect<FlatModule, FlatError> open(View<u8> bytes) noexcept;
+
+    /// @brief Returns the header of the module
+    /// @return The header
+    const FlatHeader& header() const noexcept
+    {
+      return *reinterpret_cast<const FlatHeader*>(bytes.data());
+    }
+
+    /// @brief Returns the section table
+    /// @return The section table
+    Span<const FlatSection> sections() const noexcept
+    {
+      return Span<const FlatSection>{
+          reinterpret_cast<const FlatSection*>(
+              bytes.data() + header().table_offset),
+          header().section_count};
+    }
+
+    template<typename T>
+    /// @brief Returns the first section of kind 'kind'
+    /// @tparam T The type of the elements of the section
+    /// @param kind The kind of the section
+    /// @return The elements or None if the section does not exist
+    ///         (or its elements are not of size 'sizeof(T)')
+    Option<Span<const T>> section(FlatSectionKind kind) const noexcept
+    {
+      for (auto& sec : sections())
+      {
+        if (sec.kind != kind)
+          continue;
+        if (sec.element_size != sizeof(T))
+          return None;
+        return Span<const T>{
+            reinterpret_cast<const T*>(bytes.data() + sec.offset),
+            static_cast<size_t>(sec.count)};
+      }
+      return None;
+    }
+
+    /// @brief Returns the bytes of the module
+    /// @return The bytes of the module
+    View<u8> data() const noexcept { return bytes; }
+  };
+
+  /// @brief Writes the lexemes of a file as a flat module
+  /// @param ctx The lexemes of the file
+  /// @param source The content of the file
+  /// @return The module
+  std::vector<u8> write_flat_lexemes(
+      const LexemesContext& ctx, View<u8> source) noexcept;
+} // namespace clt::lng
+
+ADD_REFLECTION_FOR_CONSECUTIVE_ENUM(
+    clt::lng, FlatError, INVALID_BUFFER, INVALID_MAGIC, UNSUPPORTED_VERSION,
+    INVALID_SECTION);
+
+#endif // !HG_COLTC_FLAT_MODULE
@@ -66,12 +66,14 @@ namespace clt::lng
     {
     }
 
-    /// @brief Parses all lexemes and populates the context
+    /// @brief Parses all lexemes and populates the context.
+    /// Parsing stops early if the reporter requests cancellation
+    /// (which happens once the error limit is reached).
     void parse() noexcept
     {
       COLT_TRACE_FN_C(clt::Color::DarkCyan);
       _next = next();
-      while (_next != U8_EOF)
+      while (_next != U8_EOF && !reporter.is_cancelled())
         Lexer::LexingTable[_next](*this);
     }
 
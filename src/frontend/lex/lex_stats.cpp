@@ -0,0 +1,120 @@
+/*****************************************************************/ /**
+ * @file   lex_stats.cpp
+ * @brief  Implementation of LexStats.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include "lex_stats.h"
+#include <algorithm>
+#include <unordered_set>
+
+namespace clt::lng
+{
+  namespace details
+  {
+    template<typename T>
+    /// @brief Returns the usage of an array of a LexemesContext
+    /// @param name The name of the array
+    /// @param array The array
+    /// @return The usage of the array
+    static ArrayUsage usage_of(
+        std::string_view name, const Vector<T>& array) noexcept
+    {
+      return ArrayUsage{name, array.size(), array.capacity(), sizeof(T)};
+    }
+
+    /// @brief Returns 'num / den' (or 0 if 'den' is 0)
+    static double ratio(u64 num, u64 den) noexcept
+    {
+      return den == 0 ? 0.0 : static_cast<double>(num) / den;
+    }
+  } // namespace details
+
+  LexStats LexStats::compute(const LexemesContext& ctx, u64 bytes) noexcept
+  {
+    COLT_TRACE_FN();
+    using namespace details;
+
+    LexStats stats;
+    stats.bytes  = bytes;
+    stats.lines  = ctx.lines.size();
+    stats.tokens = ctx.tokens.size();
+
+    // The kinds of literals, in the order of 'literals'
+    static constexpr std::array<Lexeme, LITERAL_COUNT> LITERALS = {
+        Lexeme::TKN_BOOL_L, Lexeme::TKN_CHAR_L, Lexeme::TKN_INT_L,
+        Lexeme::TKN_FLOAT_L, Lexeme::TKN_STRING_L};
+    stats.literals = {
+        LiteralUsage{"bool"}, LiteralUsage{"char"}, LiteralUsage{"int"},
+        LiteralUsage{"float"}, LiteralUsage{"string"}};
+    for (auto tkn : ctx.tokens)
+    {
+      const auto lexeme = tkn.lexeme();
+      ++stats.per_lexeme[static_cast<size_t>(lexeme)];
+      auto it = std::find(LITERALS.begin(), LITERALS.end(), lexeme);
+      if (it == LITERALS.end())
+        continue;
+      auto& literal = stats.literals[it - LITERALS.begin()];
+      ++literal.count;
+      literal.bytes += ctx.info(tkn).size;
+    }
+
+    stats.identifiers = ctx.identifiers.size();
+    std::unordered_set<std::u8string_view> distinct;
+    distinct.reserve(ctx.identifiers.size());
+    for (auto& identifier : ctx.identifiers)
+      distinct.emplace(identifier.data(), identifier.size());
+    stats.distinct_identifiers = distinct.size();
+
+    stats.arrays = {
+        usage_of("tokens", ctx.tokens),
+        usage_of("tokens_info", ctx.tokens_info),
+        usage_of("lines", ctx.lines),
+        usage_of("identifiers", ctx.identifiers),
+        usage_of("int", ctx.int_literals),
+        usage_of("float", ctx.float_literals),
+        usage_of("char", ctx.char_literals),
+        usage_of("string", ctx.str_literals)};
+    return stats;
+  }
+
+  void LexStats::print(std::string_view path) const noexcept
+  {
+    using namespace details;
+
+    clt::print("Lexing statistics for '{}':", path);
+    clt::print(
+        "  {} bytes, {} lines, {} tokens: {:.2f} tokens/line, {:.2f} bytes/token",
+        bytes, lines, tokens, ratio(tokens, lines), ratio(bytes, tokens));
+    clt::print(
+        "  {} identifiers, {} distinct ({:.1f}%)", identifiers,
+        distinct_identifiers, 100 * ratio(distinct_identifiers, identifiers));
+
+    clt::print("  {:<24} {:>10} {:>7}", "lexeme", "count", "%");
+    for (size_t i = 0; i < LEXEME_COUNT; i++)
+    {
+      if (per_lexeme[i] == 0)
+        continue;
+      clt::print(
+          "  {:<24} {:>10} {:>7.2f}",
+          meta::reflect<Lexeme>::to_str(static_cast<Lexeme>(i)), per_lexeme[i],
+          100 * ratio(per_lexeme[i], tokens));
+    }
+
+    clt::print("  {:<24} {:>10} {:>12} {:>10}", "literal", "count", "bytes", "avg");
+    for (auto& literal : literals)
+      clt::print(
+          "  {:<24} {:>10} {:>12} {:>10.2f}", literal.name, literal.count,
+          literal.bytes, ratio(literal.bytes, literal.count));
+
+    clt::print(
+        "  {:<24} {:>10} {:>12} {:>7} {:>12}", "array", "size", "capacity", "use%",
+        "reserved (B)");
+    for (auto& array : arrays)
+      clt::print(
+          "  {:<24} {:>10} {:>12} {:>7.1f} {:>12}", array.name, array.size,
+          array.capacity, 100 * ratio(array.size, array.capacity),
+          array.capacity * array.element_size);
+  }
+} // namespace clt::lng
@@ -0,0 +1,84 @@
+/*****************************************************************/ /**
+ * @file   lex_stats.h
+ * @brief  Contains LexStats, the statistics printed by '--stats'.
+ * The statistics are computed in a single pass over the arrays of a
+ * LexemesContext, after lexing: the lexer itself does not count anything.
+ * They are used to choose the reservation factors of the arrays and to
+ * explain throughput differences between codebases.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_COLTC_LEX_STATS
+#define HG_COLTC_LEX_STATS
+
+#include <array>
+#include <string_view>
+#include <frontend/lex/lexemes_context.h>
+
+namespace clt::lng
+{
+  /// @brief The size and capacity of an array of a LexemesContext
+  struct ArrayUsage
+  {
+    /// @brief The name of the array
+    std::string_view name;
+    /// @brief The number of elements
+    u64 size;
+    /// @brief The number of elements reserved
+    u64 capacity;
+    /// @brief The size of an element
+    u64 element_size;
+  };
+
+  /// @brief The number and source bytes of a kind of literal
+  struct LiteralUsage
+  {
+    /// @brief The name of the kind of literal
+    std::string_view name;
+    /// @brief The number of literals
+    u64 count;
+    /// @brief The bytes of source code of the literals
+    u64 bytes;
+  };
+
+  /// @brief Statistics about the result of lexing a file
+  struct LexStats
+  {
+    /// @brief The number of Lexeme
+    static constexpr size_t LEXEME_COUNT = meta::reflect<Lexeme>::max() + 1;
+    /// @brief The number of arrays of a LexemesContext
+    static constexpr size_t ARRAY_COUNT = 8;
+    /// @brief The number of kinds of literals
+    static constexpr size_t LITERAL_COUNT = 5;
+
+    /// @brief The bytes of the file
+    u64 bytes = 0;
+    /// @brief The number of lines
+    u64 lines = 0;
+    /// @brief The number of tokens (including the EOF token)
+    u64 tokens = 0;
+    /// @brief The number of tokens of each Lexeme
+    std::array<u64, LEXEME_COUNT> per_lexeme = {};
+    /// @brief The number of identifiers
+    u64 identifiers = 0;
+    /// @brief The number of distinct identifiers
+    u64 distinct_identifiers = 0;
+    /// @brief The literals of each kind
+    std::array<LiteralUsage, LITERAL_COUNT> literals = {};
+    /// @brief The arrays of the LexemesContext
+    std::array<ArrayUsage, ARRAY_COUNT> arrays = {};
+
+    /// @brief Computes the statistics of the result of lexing a file
+    /// @param ctx The result of lexing
+    /// @param bytes The bytes of the file that was lexed
+    /// @return The statistics
+    static LexStats compute(const LexemesContext& ctx, u64 bytes) noexcept;
+
+    /// @brief Prints the statistics
+    /// @param path The path of the file that was lexed
+    void print(std::string_view path) const noexcept;
+  };
+} // namespace clt::lng
+
+#endif // !HG_COLTC_LEX_STATS
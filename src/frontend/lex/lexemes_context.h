@@ -16,6 +16,8 @@ namespace clt::lng
   class LexemesContext;
   // Forward declaration
   struct Lexer;
+  // Forward declaration
+  struct LexStats;
 
   /// @brief Lexes 'to_parse'.
   /// 'to_parse' is a byte view as the lexer has to handle invalid unicode.
@@ -146,6 +148,8 @@ namespace clt::lng
 
     // Friend declaration to use add_token
     friend struct Lexer;
+    // Friend declaration to read the arrays
+    friend struct LexStats;
 
   public:
     /// @brief Default constructor
@@ -167,6 +171,28 @@ namespace clt::lng
       tokens.clear();
     }
 
+    /// @brief Returns the bytes reserved by the token, line and identifier arrays
+    /// @return The bytes reserved by the arrays
+    size_t array_bytes() const noexcept
+    {
+      return tokens.capacity() * sizeof(LexemeToken)
+             + tokens_info.capacity() * sizeof(LexemeInfo)
+             + lines.capacity() * sizeof(u8StringView)
+             + identifiers.capacity() * sizeof(u8StringView);
+    }
+
+    /// @brief Returns the bytes reserved by the arrays of literals.
+    /// The heap storage owned by each BigInt, BigRational or string
+    /// is not included.
+    /// @return The bytes reserved by the arrays of literals
+    size_t literal_bytes() const noexcept
+    {
+      return int_literals.capacity() * sizeof(num::BigInt)
+             + float_literals.capacity() * sizeof(num::BigRational)
+             + char_literals.capacity() * sizeof(u32)
+             + str_literals.capacity() * sizeof(u8String);
+    }
+
     /// @brief Adds a line
     /// @param line The line to save
     void add_line(u8StringView line) noexcept { lines.push_back(line); }
@@ -12,6 +12,7 @@
 #include <colt/bit/endian.h>
 #include <colt/meta/reflect.h>
 #include <colt/num/math.h>
+#include <bit>
 
 DECLARE_ENUM_WITH_TYPE(
     u8, clt::lng, PrimitiveType,
@@ -82,6 +83,24 @@ namespace clt::lng
     {
       return void_ptr_info();
     }
+
+    /// @brief Returns the information of the machine running the compiler.
+    /// This is the only target for now.
+    /// @return Information about the host
+    static constexpr TargetInfo host() noexcept
+    {
+      return TargetInfo{
+          std::endian::native == std::endian::little ? Endianess::little_endian
+                                                     : Endianess::big_endian,
+          {{{sizeof(u8), alignof(u8)},
+            {sizeof(u16), alignof(u16)},
+            {sizeof(u32), alignof(u32)},
+            {sizeof(u64), alignof(u64)},
+            {sizeof(float), alignof(float)},
+            {sizeof(double), alignof(double)},
+            {sizeof(void*), alignof(void*)},
+            {sizeof(void (*)()), alignof(void (*)())}}}};
+    }
   };
 } // namespace clt::lng
 
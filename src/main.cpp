@@ -1,11 +1,552 @@
 #include <colt_pch.h>
 #include <util/args.h>
 #include <frontend/lex/lex.h>
+#include <frontend/lex/lex_stats.h>
 #include <frontend/err/composable_reporter.h>
+#include <frontend/err/concurrent_reporter.h>
+#include <frontend/err/clt_diag_parser.h>
+#include <frontend/err/machine_reporter.h>
+#include <frontend/ir/flat_module.h>
+#include <util/ffi/plugin_registry.h>
+#include <util/ffi/plugin_reporter.h>
+#include <util/lua/lua_pool.h>
+#include <util/phase_timer.h>
+#include <util/mem_report.h>
+#include <util/input_files.h>
+#include <util/build_cache.h>
+#include <util/scheduler.h>
+#include <util/daemon.h>
+#include <mutex>
+
+#ifndef COLTC_BUILD_ID
+  /// @brief Identifies the sources of the compiler (set by CMake)
+  #define COLTC_BUILD_ID "unknown"
+#endif // !COLTC_BUILD_ID
 
 using namespace clt;
 
+/// @brief Compiles a '.colt.diag' file to a '.colt.diagbin' file
+/// @param path The path to the '.colt.diag' file
+/// @return The exit code
+static int compile_diag_file(std::string_view path)
+{
+  COLT_TRACE_FN();
+  auto input  = std::string{path};
+  auto output = input + "bin";
+  auto db     = lng::DiagnosticDatabase::load(input.c_str());
+  if (db.is_error())
+  {
+    print_error("Could not load '{}' ({:h})!", input, db.error());
+    return 1;
+  }
+  if (!db->compile_to(output.c_str()))
+  {
+    print_error("Could not write '{}'!", output);
+    return 1;
+  }
+  print_message("Compiled '{}' to '{}'.", input, output);
+  return 0;
+}
+
+/// @brief Declares the plugin purposes listed in 'purposes'
+/// @param registry The registry in which to declare the purposes
+/// @param purposes Comma separated list of purposes
+/// @return False if a purpose is unknown
+static bool declare_plugins(ffi::PluginRegistry& registry, std::string_view purposes)
+{
+  using enum ffi::ColtPlugin::PluginType;
+  while (!purposes.empty())
+  {
+    auto pos     = purposes.find(',');
+    auto purpose = purposes.substr(0, pos);
+    purposes.remove_prefix(
+        pos == std::string_view::npos ? purposes.size() : pos + 1);
+    if (purpose == "reporter")
+      registry.declare(REPORTER);
+    else if (purpose == "highlight")
+      registry.declare(HIGHLIGHT);
+    else if (purpose == "backend")
+      registry.declare(BACKEND);
+    else
+    {
+      print_error("Unknown plugin purpose '{}'!", purpose);
+      return false;
+    }
+  }
+  return true;
+}
+
+/// @brief The backend entry points of the BACKEND plugins
+static std::vector<ffi::ColtPlugin::fn_backend_t> BackendFns;
+/// @brief The time spent in each phase (only recorded for '--time-report')
+static PhaseTimes Times;
+/// @brief The build cache (only enabled by '--cache-dir')
+static BuildCache Cache;
+/// @brief The number of workers compiling files
+static u32 Workers = 1;
+/// @brief The number of files whose diagnostics are flushed together.
+/// The files of a batch stay mapped until their diagnostics are flushed.
+static constexpr u32 FILES_PER_BATCH = 256;
+
+/// @brief Hands the flat module of a file to '--emit-flat' and the backends
+/// @param flat The flat module
+/// @return The exit code
+static int hand_off(View<u8> flat)
+{
+  COLT_TRACE_FN();
+  if (!EmitFlatFile.empty())
+  {
+    auto path = std::string{EmitFlatFile};
+    auto file = std::fopen(path.c_str(), "wb");
+    bool ok   = file != nullptr
+              && std::fwrite(flat.data(), 1, flat.size(), file) == flat.size();
+    if (file != nullptr)
+      ok = (std::fclose(file) == 0) && ok;
+    if (!ok)
+    {
+      print_error("Could not write '{}'!", path);
+      return 1;
+    }
+  }
+  // Backend plugins are not required to be thread safe
+  static std::mutex BACKEND_LOCK;
+  std::scoped_lock guard{BACKEND_LOCK};
+  for (auto backend : BackendFns)
+  {
+    if (auto code = backend(flat.data(), flat.size()); code != 0)
+    {
+      print_error("Backend plugin failed (code {})!", code);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/// @brief Returns the key of the tokens of a file in the build cache
+/// @param content The content of the file
+/// @return The key of the flat module of the file
+static CacheKey tokens_key(View<u8> content)
+{
+  // Only files without diagnostics are cached, so no flag changes their
+  // tokens. Compilers built from other commits get other keys, but the
+  // build ID (set by CMake when configuring) only tells uncommitted
+  // changes apart by its '-dirty' suffix: such builds should use their
+  // own '--cache-dir'.
+  static const CacheKeyHasher BASE = []
+  {
+    CacheKeyHasher hasher;
+    hasher.add(fmt::format(
+        "{} {} {}", vers::ColtcVersion, COLT_CONFIG_STRING, COLTC_BUILD_ID));
+    hasher.add(static_cast<u64>(lng::FlatHeader::CURRENT_VERSION));
+    hasher.add(lng::TargetInfo::host());
+    return hasher;
+  }();
+  auto hasher = BASE;
+  hasher.add(content);
+  return hasher.finish();
+}
+
+/// @brief Returns the Lua states, one per worker, and the compiled chunks
+/// @return The pool of Lua states
+static lua::LuaStatePool& lua_pool()
+{
+  static lua::LuaStatePool POOL{
+      Workers, LuaMemoryLimit == 0 ? lua::LuaArena::NO_LIMIT
+                                   : static_cast<u64>(LuaMemoryLimit) * 1024};
+  return POOL;
+}
+
+/// @brief Loads and compiles the script of 'LuaHookFile', once per build
+/// @param chunk Where to write the chunk (nullptr if there is no hook)
+/// @return False if the script could not be loaded (after printing an error)
+static bool load_lua_hook(const lua::LuaChunk*& chunk)
+{
+  COLT_TRACE_FN();
+  chunk = nullptr;
+  if (LuaHookFile.empty())
+    return true;
+  auto path   = std::string{LuaHookFile};
+  auto script = ViewOfFile::open(path.c_str());
+  if (script.is_none())
+  {
+    print_error("Could not open '{}'!", path);
+    return false;
+  }
+  auto source = *script->view();
+  std::string error;
+  auto result = lua_pool().chunks().compile(
+      path,
+      std::string_view{reinterpret_cast<const char*>(source.data()), source.size()},
+      error);
+  if (result.is_error())
+  {
+    print_error("Lua hook '{}' ({:h}): {}", path, result.error(), error);
+    return false;
+  }
+  chunk = *result;
+  return true;
+}
+
+/// @brief Runs the Lua hook over the tokens of a file
+/// @param chunk The chunk of the hook (nullptr if there is no hook)
+/// @param ctx The lexemes of the file
+/// @param worker The worker compiling the file
+/// @param times The times of the file
+/// @return The exit code
+static int run_lua_hook(
+    const lua::LuaChunk* chunk, const lng::LexemesContext& ctx, u32 worker,
+    PhaseTimes& times)
+{
+  COLT_TRACE_FN();
+  if (chunk == nullptr)
+    return 0;
+  PhaseScope phase{times, Phase::LUA_HOOK};
+  phase.processed(0, ctx.token_buffer().size());
+  auto& state = lua_pool().state(worker);
+  auto result = state.run(*chunk, ctx);
+  if (result.is_error())
+  {
+    print_error(
+        "Lua hook '{}' ({:h}): {}", LuaHookFile, result.error(),
+        state.last_error());
+    // Whatever the script kept alive (globals) is released at once
+    if (result.error() == lua::LuaError::MEMORY_ERR)
+      state.reset();
+    return 1;
+  }
+  return static_cast<int>(*result != 0);
+}
+
+/// @brief Prints the memory used by the runs of the Lua hook, on all workers
+/// @param chunk The chunk of the hook
+static void print_lua_usage(const lua::LuaChunk& chunk)
+{
+  lua::LuaUsage total;
+  for (u32 i = 0; i < lua_pool().size(); i++)
+  {
+    auto use = lua_pool().state(i).usage_of(chunk);
+    total.runs += use.runs;
+    total.allocated += use.allocated;
+    total.peak = std::max(total.peak, use.peak);
+    total.over_budget += use.over_budget;
+  }
+  print(
+      "Lua hook '{}': {} runs, {:.1f} KiB allocated, {:.1f} KiB peak per run, "
+      "{} over budget",
+      LuaHookFile, total.runs, static_cast<double>(total.allocated) / 1024.0,
+      static_cast<double>(total.peak) / 1024.0, total.over_budget);
+}
+
+/// @brief Prints and writes the time, memory and cache reports (if requested)
+/// @param code The exit code of the compilation
+/// @param verbose If false, the tables are not printed (as the output is
+///                meant to be consumed by tools)
+/// @return The exit code
+static int print_reports(int code, bool verbose)
+{
+  if (verbose && PrintMemReport)
+    MemAccounting::print();
+  if (verbose && PrintCacheStats && Cache.is_enabled())
+    Cache.print_stats();
+  if (!Times.is_enabled())
+    return code;
+  if (verbose && PrintTimeReport)
+    Times.print();
+  if (!TimeReportFile.empty())
+  {
+    auto path = std::string{TimeReportFile};
+    if (!Times.write_json(path.c_str()))
+    {
+      print_error("Could not write '{}'!", path);
+      return code == 0 ? 1 : code;
+    }
+  }
+  return code;
+}
+
+/// @brief Enables the file tracer, writing the trace to 'TraceFile' at exit
+static void enable_trace_file()
+{
+#ifdef COLT_ENABLE_TRACING
+  print_warn("'--trace-file' is inactive as the compiler executable was "
+             "compiled with Tracy support!");
+#else
+  FileTracer::enable();
+  // Written at exit, so that every return path of 'colt_main' is covered
+  std::atexit(
+      []
+      {
+        auto path = std::string{TraceFile};
+        if (!FileTracer::write(path.c_str()))
+          print_error("Could not write '{}'!", path);
+        else if (auto dropped = FileTracer::dropped(); dropped != 0)
+          print_warn("{} zones were dropped from '{}'!", dropped, path);
+      });
+#endif // COLT_ENABLE_TRACING
+}
+
+/// @brief The result of compiling a file.
+/// Results are reported once all the files of a batch are compiled, in
+/// the order of the inputs: the output does not depend on the workers.
+struct FileResult
+{
+  /// @brief The mapped file (which must outlive its diagnostics)
+  Option<ViewOfFile> file = None;
+  /// @brief The statistics of the file (only computed for '--stats')
+  Option<lng::LexStats> stats = None;
+  /// @brief The time spent in each phase
+  PhaseTimes times = {};
+  /// @brief The exit code of the Lua hook and backends
+  int code = 0;
+  /// @brief True if the file generated errors
+  bool has_errors = false;
+  /// @brief True if the error limit was reached
+  bool cancelled = false;
+};
+
+template<lng::Reporter Rep>
+/// @brief Compiles a file on a worker
+/// @tparam Rep The reporter to which the diagnostics are forwarded
+/// @param reporter The reporter shared by the workers
+/// @param worker The worker compiling the file
+/// @param file_id The index of the file in the inputs
+/// @param path The path to the file
+/// @param print_tokens If true, the tokens of the file are printed
+/// @param hook The chunk of the Lua hook (nullptr if there is no hook)
+/// @param result Where to write the result
+static void compile_file(
+    lng::ConcurrentReporter<Rep>& reporter, u32 worker, u32 file_id,
+    const char* path, bool print_tokens, const lua::LuaChunk* hook,
+    FileResult& result)
+{
+  COLT_TRACE_FN();
+  auto& times = result.times;
+  times.enable(Times.is_enabled());
+  times.begin_file(path);
+  PhaseScope map_phase{times, Phase::MAP_FILE};
+  result.file = COLT_TRACE_EXPR(ViewOfFile::open(path));
+  map_phase.stop();
+  if (result.file.is_none())
+    return;
+  auto content = *result.file->view();
+  if (print_tokens)
+    print_message("Opened '{}'!", path);
+
+  // The cache stores flat modules: it cannot be used when the lexemes
+  // themselves are needed
+  const bool use_cache = Cache.is_enabled() && !print_tokens && !PrintLexStats
+                         && hook == nullptr;
+  CacheKey key = {};
+  if (use_cache)
+  {
+    PhaseScope cache_phase{times, Phase::CACHE};
+    cache_phase.processed(content.size());
+    key       = tokens_key(content);
+    auto flat = Cache.load(CachePhase::TOKENS, key);
+    if (flat.is_value()
+        && lng::FlatModule::open(View<u8>{flat->data(), flat->size()}).is_value())
+    {
+      cache_phase.stop();
+      PhaseScope phase{times, Phase::BACKEND};
+      phase.processed(flat->size());
+      result.code = hand_off(View<u8>{flat->data(), flat->size()});
+      return;
+    }
+  }
+
+  auto& shard = reporter.shard(worker);
+  reporter.begin_file(worker, file_id, content, path);
+  const u64 errors   = shard.error_count();
+  const u64 warnings = shard.warn_count();
+  const u64 messages = shard.message_count();
+  PhaseScope lex_phase{times, Phase::LEX};
+  auto value = lng::lex(shard, content);
+  lex_phase.processed(content.size(), value.token_buffer().size());
+  lex_phase.stop();
+  // The arrays of the lexer are allocated by colt-cpp: they are charged
+  // once lexing is done, until they are freed
+  MemCharge lexer_memory{MemTag::LEXER, value.array_bytes()};
+  MemCharge literal_memory{MemTag::LITERALS, value.literal_bytes()};
+  result.has_errors = shard.error_count() != errors;
+  if (shard.is_cancelled())
+  {
+    result.cancelled = true;
+    return;
+  }
+  if (print_tokens)
+  {
+    PhaseScope phase{times, Phase::REPORT};
+    phase.processed(0, value.token_buffer().size());
+    COLT_TRACE_BLOCK_C("print_token", clt::Color::Chartreuse3)
+    {
+      for (auto& i : value.token_buffer())
+        lng::print_token(i, value);
+    };
+  }
+  if (PrintLexStats)
+    result.stats = lng::LexStats::compute(value, content.size());
+  if (result.has_errors)
+    return;
+  result.code = run_lua_hook(hook, value, worker, times);
+  if (result.code != 0)
+    return;
+  // Only files without diagnostics are cached, as a hit reports nothing
+  const bool store = use_cache && shard.warn_count() == warnings
+                     && shard.message_count() == messages;
+  if (!store && EmitFlatFile.empty() && BackendFns.empty())
+    return;
+
+  PhaseScope phase{times, Phase::BACKEND};
+  // The module is written once: the backends, the file and the cache
+  // share the same bytes
+  auto flat = lng::write_flat_lexemes(value, content);
+  MemCharge flat_memory{MemTag::BACKEND, flat.capacity()};
+  phase.processed(flat.size(), value.token_buffer().size());
+  result.code = hand_off(View<u8>{flat.data(), flat.size()});
+  phase.stop();
+  if (store)
+  {
+    PhaseScope cache_phase{times, Phase::CACHE};
+    Cache.store(CachePhase::TOKENS, key, View<u8>{flat.data(), flat.size()});
+  }
+}
+
+template<lng::Reporter Rep, typename... Args>
+/// @brief Compiles files on 'Workers' workers, reporting through 'Rep'
+/// @tparam Rep The reporter to use
+/// @param inputs The paths to the files
+/// @param verbose If false, only the reporter writes to the output
+///                (used for machine-readable formats)
+/// @param args The arguments to forward to the constructor of 'Rep'
+/// @return The exit code
+static int compile_files(
+    const std::vector<std::string>& inputs, bool verbose, Args&&... args)
+{
+  // A coarse zone (unlike COLT_TRACE_FN, also written to '--trace-file')
+  COLT_TRACE_ZONE("compile_files");
+  // The hook is compiled before any file: a script that does not load is
+  // reported once
+  const lua::LuaChunk* hook = nullptr;
+  if (!load_lua_hook(hook))
+    return 1;
+  lng::ConcurrentReporter<Rep> reporter{Workers, std::forward<Args>(args)...};
+  reporter.set_error_limit(ErrorLimit);
+  // The tokens of files compiled in parallel would be interleaved
+  const bool print_tokens = verbose && inputs.size() == 1;
+
+  int code        = 0;
+  bool has_errors = false;
+  std::vector<FileResult> results(inputs.size());
+  // Reports the results of a batch of files, in order, once all of them
+  // were compiled: this is the only task writing to the output
+  auto report_batch = [&](size_t first, size_t last)
+  {
+    {
+      // The diagnostics of a batch are flushed at once: the time is
+      // counted in the first file of the batch
+      PhaseScope phase{results[first].times, Phase::REPORT};
+      reporter.flush();
+    }
+    for (size_t i = first; i < last; i++)
+    {
+      auto& result = results[i];
+      auto& path   = inputs[i];
+      Times.append(std::move(result.times));
+      if (result.file.is_none())
+      {
+        // Written to stderr: stdout may be consumed by tools (jsonl, sarif)
+        print_error(File::get_stderr(), "Could not open '{}'!", path);
+        code = code == 0 ? 1 : code;
+        continue;
+      }
+      // The diagnostics of the file were flushed: it can be unmapped
+      result.file = None;
+      has_errors |= result.has_errors;
+      if (result.cancelled)
+      {
+        if (verbose)
+          print_error(
+              "Error limit ({}) reached: abandoned compilation of '{}'!",
+              ErrorLimit, path);
+        code = code == 0 ? 1 : code;
+      }
+      if (verbose && result.stats.is_value())
+        result.stats->print(path);
+      if (code == 0)
+        code = result.code;
+    }
+  };
+
+  // The files of a batch are compiled by any worker, then reported by
+  // a task on which the files of the next batch depend
+  TaskGraph graph;
+  Option<TaskID> previous_report = None;
+  for (size_t first = 0; first < inputs.size(); first += FILES_PER_BATCH)
+  {
+    const size_t last = std::min(first + FILES_PER_BATCH, inputs.size());
+    auto report       = graph.add(
+        "report_batch",
+        [&report_batch, first, last](TaskContext&)
+        { report_batch(first, last); });
+    for (size_t i = first; i < last; i++)
+    {
+      auto file = graph.add(
+          "compile_file",
+          [&, i](TaskContext& ctx)
+          {
+            compile_file(
+                reporter, ctx.worker(), static_cast<u32>(i), inputs[i].c_str(),
+                print_tokens, hook, results[i]);
+          });
+      if (previous_report.is_value())
+        graph.precede(*previous_report, file);
+      graph.precede(file, report);
+    }
+    previous_report = report;
+  }
+  Scheduler scheduler{Workers};
+  scheduler.run(graph);
+  if (Cache.is_enabled())
+    Cache.trim();
+  if (verbose && PrintMemReport && hook != nullptr)
+    print_lua_usage(*hook);
+
+  // Tools consuming machine-readable output rely on the exit code
+  if (code == 0 && !verbose && has_errors)
+    return 1;
+  return code;
+}
+
 /// @brief This is the main entry point of the compiler.
+int colt_main(Span<const char8_t*> argv);
+
+/// @brief Compiles a request of 'coltc-client', in a forked daemon
+/// @param argv The arguments of the request
+/// @return The exit code
+static int serve_request(Span<const char8_t*> argv)
+{
+  // A request behaves like 'coltc' run with the same arguments: the
+  // options of the daemon are not inherited
+  reset_options();
+  return colt_main(argv);
+}
+
+/// @brief Serves the requests of 'coltc-client' (see '--daemon')
+/// @return The exit code
+static int serve_daemon()
+{
+  // Mapped once: the forked requests still discover and set up their
+  // plugins, but find their libraries already loaded and relocated
+  ffi::PluginRegistry plugins;
+  if (plugins.discover())
+  {
+    for (size_t i = 0; i < plugins.plugins().size(); i++)
+      if (plugins.plugins()[i].info.is_valid)
+        plugins.open(i);
+  }
+  return run_daemon(DaemonSocket, &serve_request);
+}
+
 /// The true main function is defined by `true_main.cpp`, which
 /// converts command line arguments to UTF8 and sets up
 /// console support for Unicode on Windows.
@@ -14,23 +555,99 @@ using namespace clt;
 int colt_main(Span<const char8_t*> argv)
 {
   COLT_TRACE_FN_C(clt::Color::Crimson);
+  std::vector<const char8_t*> options;
+  std::vector<std::string_view> positional;
+  // The parser only accepts a single input: all of them are expanded below
+  split_positional(argv, options, positional);
   COLT_TRACE_EXPR(cl::parse_command_line_options<CMDs>(
-      argv, COLTC_EXECUTABLE_NAME, "The Colt compiler."));
-  auto val = COLT_TRACE_EXPR(ViewOfFile::open("test.txt"));
-  if (val.is_value())
+      Span<const char8_t*>{options.data(), options.size()},
+      COLTC_EXECUTABLE_NAME, "The Colt compiler."));
+  if (RunDaemon)
+    return serve_daemon();
+  if (!CompileDiagFile.empty())
+    return compile_diag_file(CompileDiagFile);
+  std::vector<std::string> inputs;
+  if (!expand_inputs(positional, inputs))
+    return 1;
+  if (inputs.empty())
   {
-    print_message("Opened 'test.txt'!");
-    auto reporter = lng::make_error_reporter<lng::ConsoleReporter>();
-    auto value    = lng::lex(*reporter, *val->view());
-    COLT_TRACE_BLOCK_C("print_token", clt::Color::Chartreuse3)
-    {
-      for (auto& i : value.token_buffer())
-        lng::print_token(i, value);
-    };
+    print_warn("REPL is not implemented.");
+    return 0;
+  }
+  if (inputs.size() > 1 && !EmitFlatFile.empty())
+  {
+    print_error("'--emit-flat' requires a single input file!");
+    return 1;
+  }
+  Workers = worker_count(Jobs, inputs.size());
+  if (!CacheDir.empty()
+      && !Cache.enable(CacheDir, static_cast<u64>(CacheSizeLimit) * 1024 * 1024))
+    return 1;
+  if (PrintCacheStats && CacheDir.empty())
+    print_warn("'--cache-stats' is inactive without '--cache-dir'!");
+  Times.enable(PrintTimeReport || !TimeReportFile.empty());
+  MemAccounting::enable(PrintMemReport);
+  if (!TraceFile.empty())
+    enable_trace_file();
+  // Plugins are only opened when their purpose is first required, and
+  // are shut down (in reverse order) when 'plugins' is destroyed
+  ffi::PluginRegistry plugins;
+  if (!declare_plugins(plugins, PluginPurposes))
+    return 1;
+  std::vector<ffi::ColtPlugin::fn_report_t> report_fns;
+  for (auto i : plugins.require(ffi::ColtPlugin::PluginType::REPORTER))
+  {
+    auto& entry = plugins.plugins()[i].entry;
+    if (entry.has(ffi::ColtPlugin::Capability::REPORT) && entry.report != nullptr)
+      report_fns.push_back(entry.report);
+    else
+      print_warn(
+          "Plugin '{}' does not provide reporting entry points!",
+          plugins.plugins()[i].info.name);
   }
+  for (auto i : plugins.require(ffi::ColtPlugin::PluginType::BACKEND))
+  {
+    auto& entry = plugins.plugins()[i].entry;
+    if (entry.has(ffi::ColtPlugin::Capability::BACKEND) && entry.backend != nullptr)
+      BackendFns.push_back(entry.backend);
+    else
+      print_warn(
+          "Plugin '{}' does not provide backend entry points!",
+          plugins.plugins()[i].info.name);
+  }
+  using PluginJSONLines = ffi::PluginReporter<lng::JSONLinesReporter>;
+  using PluginSARIF     = ffi::PluginReporter<lng::SARIFReporter>;
+  if (DiagFormat == "jsonl" && !report_fns.empty())
+    return print_reports(
+        compile_files<PluginJSONLines>(inputs, false, std::move(report_fns)),
+        false);
+  if (DiagFormat == "jsonl")
+    return print_reports(
+        compile_files<lng::JSONLinesReporter>(inputs, false), false);
+  if (DiagFormat == "sarif" && !report_fns.empty())
+    return print_reports(
+        compile_files<PluginSARIF>(inputs, false, std::move(report_fns)), false);
+  if (DiagFormat == "sarif")
+    return print_reports(compile_files<lng::SARIFReporter>(inputs, false), false);
+  if (DiagFormat != "console")
+  {
+    print_error("Unknown diagnostic format '{}'!", DiagFormat);
+    return 1;
+  }
+  // Plugins receive every diagnostic: deduplication only applies to the console
+  using PluginConsole = ffi::PluginReporter<lng::ConsoleReporter>;
+  using PluginDedup =
+      ffi::PluginReporter<lng::DedupReporter<lng::ConsoleReporter>>;
+  int code = 0;
+  if (!report_fns.empty() && DiagRepeat == 0)
+    code = compile_files<PluginConsole>(inputs, true, std::move(report_fns));
+  else if (!report_fns.empty())
+    code = compile_files<PluginDedup>(
+        inputs, true, std::move(report_fns), DiagRepeat);
+  else if (DiagRepeat == 0)
+    code = compile_files<lng::ConsoleReporter>(inputs, true);
   else
-    print_warn("Could not open 'test.txt'!");
-
-  print_warn("REPL is not implemented.");
-  return 0;
-}
\ No newline at end of file
+    code = compile_files<lng::DedupReporter<lng::ConsoleReporter>>(
+        inputs, true, DiagRepeat);
+  return print_reports(code, true);
+}
@@ -1,6 +1,8 @@
 #ifndef HG_COLTC_ARGS
 #define HG_COLTC_ARGS
 
+#include <algorithm>
+#include <vector>
 #include <fmt/ranges.h>
 #include <colt/io/print.h>
 #include <colt/versions.h>
@@ -65,6 +67,76 @@ namespace clt
   inline std::string_view OutputFile = {};
   /// @brief The input file name
   inline std::string_view InputFile = {};
+  /// @brief The number of errors after which a file is abandoned (0 for no limit)
+  inline u32 ErrorLimit = 0;
+  /// @brief The '.colt.diag' file to compile to a '.colt.diagbin' file
+  inline std::string_view CompileDiagFile = {};
+  /// @brief The format of the diagnostics ('console', 'jsonl' or 'sarif')
+  inline std::string_view DiagFormat = "console";
+  /// @brief The number of identical diagnostics printed before being summarized
+  ///        (0 to print all of them)
+  inline u32 DiagRepeat = 1;
+  /// @brief Comma separated purposes of the plugins the invocation may need
+  inline std::string_view PluginPurposes = {};
+  /// @brief The file to which to write the flat module (empty for none)
+  inline std::string_view EmitFlatFile = {};
+  /// @brief The Lua script whose hook is run over the tokens (empty for none)
+  inline std::string_view LuaHookFile = {};
+  /// @brief The KiB a single run of the Lua hook may allocate (0 for no limit)
+  inline u32 LuaMemoryLimit = 0;
+  /// @brief Flag to print the time spent in each phase of the compilation
+  inline bool PrintTimeReport = false;
+  /// @brief The file to which to write the time report as JSON (empty for none)
+  inline std::string_view TimeReportFile = {};
+  /// @brief Flag to print the memory used by each subsystem
+  inline bool PrintMemReport = false;
+  /// @brief Flag to print statistics about the result of lexing
+  inline bool PrintLexStats = false;
+  /// @brief The file to which to write the trace (empty for none)
+  inline std::string_view TraceFile = {};
+  /// @brief The number of files compiled in parallel (0 for the number of
+  ///        hardware threads)
+  inline u32 Jobs = 0;
+  /// @brief The directory of the build cache (empty for no cache)
+  inline std::string_view CacheDir = {};
+  /// @brief The MiB above which the build cache is trimmed (0 for no limit)
+  inline u32 CacheSizeLimit = 1024;
+  /// @brief Flag to print the hits, misses and size of the build cache
+  inline bool PrintCacheStats = false;
+  /// @brief Flag to serve the requests of 'coltc-client' instead of compiling
+  inline bool RunDaemon = false;
+  /// @brief The socket on which the daemon listens (empty for the default)
+  inline std::string_view DaemonSocket = {};
+
+  /// @brief Restores the default value of all the options above.
+  /// This must be kept in sync with their definitions.
+  inline void reset_options() noexcept
+  {
+    WaitForUserInput = true;
+    OutputFile       = {};
+    InputFile        = {};
+    ErrorLimit       = 0;
+    CompileDiagFile  = {};
+    DiagFormat       = "console";
+    DiagRepeat       = 1;
+    PluginPurposes   = {};
+    EmitFlatFile     = {};
+    LuaHookFile      = {};
+    LuaMemoryLimit   = 0;
+    PrintTimeReport  = false;
+    TimeReportFile   = {};
+    PrintMemReport   = false;
+    PrintLexStats    = false;
+    TraceFile        = {};
+    Jobs             = 0;
+    CacheDir         = {};
+    CacheSizeLimit   = 1024;
+    PrintCacheStats  = false;
+    RunDaemon        = false;
+    DaemonSocket     = {};
+    // Set by '--nocolor' (the option is defined by colt-cpp)
+    io::OutputColor = true;
+  }
 
   /// @brief Prints the current version of Colt and exits
   [[noreturn]] inline void print_version() noexcept
@@ -88,8 +160,11 @@ namespace clt
 
       // -o <output>
       cl::Opt<"o", cl::desc<"Output file name">, cl::location<OutputFile>>,
-      // <input_file>
-      cl::OptPos<"input_file", cl::desc<"The input file">, cl::location<InputFile>>,
+      // <input_file>...
+      cl::OptPos<
+          "input_file",
+          cl::desc<"The input files: paths, globs or @response files">,
+          cl::location<InputFile>>,
 
       ///////////////////////////////////////////
 
@@ -103,6 +178,76 @@ namespace clt
       cl::Opt<"-nowait", cl::desc<"Do not wait for user input">, cl::callback<[] {
                 clt::WaitForUserInput = false;
               }>>,
+      // -j <N>
+      cl::Opt<
+          "j",
+          cl::desc<"Compiles N files in parallel (0 for the number of hardware "
+                   "threads)">,
+          cl::location<Jobs>>,
+      // -ferror-limit <N>
+      cl::Opt<
+          "ferror-limit",
+          cl::desc<"Stops compiling a file after N errors (0 for no limit)">,
+          cl::location<ErrorLimit>>,
+      // --compile-diag <file>
+      cl::Opt<
+          "-compile-diag",
+          cl::desc<"Compiles a '.colt.diag' file to a '.colt.diagbin' file">,
+          cl::location<CompileDiagFile>>,
+      // --diag-format <console|jsonl|sarif>
+      cl::Opt<
+          "-diag-format",
+          cl::desc<"Format of the diagnostics: 'console', 'jsonl' or 'sarif'">,
+          cl::location<DiagFormat>>,
+      // --emit-flat <file>
+      cl::Opt<
+          "-emit-flat",
+          cl::desc<"Writes the compiled module to a file, in the format read by "
+                   "backends">,
+          cl::location<EmitFlatFile>>,
+      // --lua-hook <file>
+      cl::Opt<
+          "-lua-hook",
+          cl::desc<"Runs the hook returned by a Lua script over the tokens of "
+                   "each file">,
+          cl::location<LuaHookFile>>,
+      // -flua-memory-limit <KiB>
+      cl::Opt<
+          "flua-memory-limit",
+          cl::desc<"Fails a Lua hook allocating more than N KiB in a single run (0 "
+                   "for no limit)">,
+          cl::location<LuaMemoryLimit>>,
+      // -fdiag-repeat <N>
+      cl::Opt<
+          "fdiag-repeat",
+          cl::desc<"Prints N identical diagnostics before summarizing them "
+                   "(defaults to 1, 0 prints all)">,
+          cl::location<DiagRepeat>>,
+      // --cache-dir <dir>
+      cl::Opt<
+          "-cache-dir",
+          cl::desc<"Reuses the results of unchanged files, stored in a "
+                   "directory shared by compiler invocations">,
+          cl::location<CacheDir>>,
+      // -fcache-size-limit <MiB>
+      cl::Opt<
+          "fcache-size-limit",
+          cl::desc<"Evicts the least recently used results once the cache "
+                   "exceeds N MiB (0 for no limit)">,
+          cl::location<CacheSizeLimit>>,
+      // --daemon
+      cl::Opt<
+          "-daemon",
+          cl::desc<"Serves the compilations requested by 'coltc-client' "
+                   "(POSIX only); the requests ignore the other options">,
+          cl::callback<[] { clt::RunDaemon = true; }>>,
+      // --daemon-socket <path>
+      cl::Opt<
+          "-daemon-socket",
+          cl::desc<"The socket of '--daemon' (defaults to $COLTC_DAEMON_SOCKET, "
+                   "then $XDG_RUNTIME_DIR/coltc.sock, then "
+                   "/tmp/coltc-<uid>/coltc.sock)">,
+          cl::location<DaemonSocket>>,
 
       ///////////////////////////////////////////
 
@@ -114,6 +259,12 @@ namespace clt
           "-enum-plugins", cl::alias<"ep">,
           cl::desc<"Enumerates the compiler's plugins">,
           cl::callback<&ffi::print_plugins>>,
+      // --plugins <reporter,highlight,backend>
+      cl::Opt<
+          "-plugins",
+          cl::desc<"Comma separated plugin purposes to load on demand: 'reporter', "
+                   "'highlight' or 'backend'">,
+          cl::location<PluginPurposes>>,
 
       ///////////////////////////////////////////
 
@@ -125,11 +276,90 @@ namespace clt
           cl::callback<[]() { /*handled in `true_main.cpp`*/ }>>,
       cl::Opt<
           "-enable-tracing", cl::desc<"Enables tracing of the compiler.">,
-          cl::callback<[]() { /*handled in `true_main.cpp`*/ }>>
+          cl::callback<[]() { /*handled in `true_main.cpp`*/ }>>,
+      // --time-report
+      cl::Opt<
+          "-time-report",
+          cl::desc<"Prints the time spent in each phase, for each file">,
+          cl::callback<[] { clt::PrintTimeReport = true; }>>,
+      // --time-report-json <file>
+      cl::Opt<
+          "-time-report-json",
+          cl::desc<"Writes the time spent in each phase to a JSON file">,
+          cl::location<TimeReportFile>>,
+      // --mem-report
+      cl::Opt<
+          "-mem-report",
+          cl::desc<"Prints the memory used by each subsystem and the peak RSS">,
+          cl::callback<[] { clt::PrintMemReport = true; }>>,
+      // --stats
+      cl::Opt<
+          "-stats",
+          cl::desc<"Prints token, identifier, literal and array statistics">,
+          cl::callback<[] { clt::PrintLexStats = true; }>>,
+      // --cache-stats
+      cl::Opt<
+          "-cache-stats",
+          cl::desc<"Prints the hits, misses and size of the build cache">,
+          cl::callback<[] { clt::PrintCacheStats = true; }>>,
+      // --trace-file <file>
+      cl::Opt<
+          "-trace-file",
+          cl::desc<"Writes the traced zones to a Chrome trace-event JSON file">,
+          cl::location<TraceFile>>
 
       ///////////////////////////////////////////
 
       >;
+
+  /// @brief The spelling of the options of 'CMDs' that take a value.
+  /// This must be kept in sync with 'CMDs'.
+  static constexpr std::array<std::string_view, 15> ValueOptions = {
+      "-o",
+      "-j",
+      "-ferror-limit",
+      "--compile-diag",
+      "--diag-format",
+      "--emit-flat",
+      "--lua-hook",
+      "-flua-memory-limit",
+      "-fdiag-repeat",
+      "--cache-dir",
+      "-fcache-size-limit",
+      "--daemon-socket",
+      "--plugins",
+      "--time-report-json",
+      "--trace-file"};
+
+  /// @brief Separates the positional arguments from the options.
+  /// The command line parser accepts a single positional argument:
+  /// only the first one is kept in 'options', but all of them are
+  /// appended to 'positional'.
+  /// @param argv The arguments
+  /// @param options Where to append the arguments to parse
+  /// @param positional Where to append the positional arguments
+  inline void split_positional(
+      Span<const char8_t*> argv, std::vector<const char8_t*>& options,
+      std::vector<std::string_view>& positional) noexcept
+  {
+    for (size_t i = 0; i < argv.size(); i++)
+    {
+      auto arg = std::string_view{reinterpret_cast<const char*>(argv[i])};
+      // The name of the executable, the options and their values
+      if (i == 0 || arg.starts_with('-')
+          || std::ranges::find(
+                 ValueOptions,
+                 std::string_view{reinterpret_cast<const char*>(argv[i - 1])})
+                 != ValueOptions.end())
+      {
+        options.push_back(argv[i]);
+        continue;
+      }
+      if (positional.empty())
+        options.push_back(argv[i]);
+      positional.push_back(arg);
+    }
+  }
 } // namespace clt
 
 #endif // !HG_COLTC_ARGS
\ No newline at end of file
@@ -0,0 +1,343 @@
+/*****************************************************************/ /**
+ * @file   build_cache.cpp
+ * @brief  Implementation of BuildCache and CacheKeyHasher.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include "build_cache.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+namespace clt
+{
+  namespace details
+  {
+    namespace fs = std::filesystem;
+
+    /// @brief The names of the phases (used in the names of the entries)
+    static constexpr std::array<std::string_view, 1> CACHE_PHASE_NAMES = {
+        "tokens"};
+
+    /// @brief The header of an entry of the cache
+    struct CacheEntryHeader
+    {
+      /// @brief The expected magic number
+      static constexpr std::array<char, 8> MAGIC = {'C', 'O', 'L', 'T',
+                                                    'C', 'A', 'C', 'H'};
+      /// @brief The current version of the format of the entries
+      static constexpr u32 CURRENT_VERSION = 1;
+
+      /// @brief Must be equal to MAGIC
+      std::array<char, 8> magic;
+      /// @brief Must be equal to CURRENT_VERSION
+      u32 version;
+      /// @brief The CachePhase that produced the entry
+      u32 phase;
+      /// @brief The key of the entry (detects renamed entries)
+      CacheKey key;
+      /// @brief The size of the bytes following the header
+      u64 size;
+    };
+
+    static_assert(sizeof(CacheEntryHeader) == 40);
+
+    /// @brief Finalizes a lane of CacheKeyHasher (from MurmurHash3)
+    static u64 avalanche(u64 value) noexcept
+    {
+      value ^= value >> 33;
+      value *= 0xFF51AFD7ED558CCDULL;
+      value ^= value >> 33;
+      value *= 0xC4CEB9FE1A85EC53ULL;
+      value ^= value >> 33;
+      return value;
+    }
+
+    /// @brief Reads and validates an entry
+    /// @param path The path of the entry
+    /// @param phase The expected phase
+    /// @param key The expected key
+    /// @return The bytes of the entry, or None if it is missing or invalid
+    static Option<std::vector<u8>> read_entry(
+        const fs::path& path, CachePhase phase, const CacheKey& key) noexcept
+    {
+      std::error_code error;
+      const u64 file_size = fs::file_size(path, error);
+      if (error || file_size < sizeof(CacheEntryHeader))
+        return None;
+      std::ifstream file{path, std::ios::binary};
+      CacheEntryHeader header;
+      if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return None;
+      // A truncated or corrupted entry is a miss (it is replaced on store)
+      if (header.magic != CacheEntryHeader::MAGIC
+          || header.version != CacheEntryHeader::CURRENT_VERSION
+          || header.phase != static_cast<u32>(phase) || header.key != key
+          || header.size != file_size - sizeof(header))
+        return None;
+      std::vector<u8> bytes(header.size);
+      if (!file.read(reinterpret_cast<char*>(bytes.data()), bytes.size()))
+        return None;
+      return bytes;
+    }
+  } // namespace details
+
+  std::string CacheKey::to_string() const noexcept
+  {
+    static constexpr std::string_view DIGITS = "0123456789abcdef";
+    std::string str(32, '0');
+    for (size_t i = 0; i < 16; i++)
+    {
+      str[15 - i] = DIGITS[(high >> (4 * i)) & 0xF];
+      str[31 - i] = DIGITS[(low >> (4 * i)) & 0xF];
+    }
+    return str;
+  }
+
+  void CacheKeyHasher::mix(u64 word) noexcept
+  {
+    low  = std::rotl((low ^ word) * 0x9FB21C651E98DF25ULL, 29);
+    high = std::rotl((high + word) * 0xD6E8FEB86659FD93ULL, 37);
+  }
+
+  void CacheKeyHasher::add(View<u8> bytes) noexcept
+  {
+    const u8* data = bytes.data();
+    const u64 size = bytes.size();
+    size_t i       = 0;
+    for (; i + sizeof(u64) <= size; i += sizeof(u64))
+    {
+      u64 word;
+      std::memcpy(&word, data + i, sizeof(u64));
+      mix(word);
+    }
+    u64 tail = 0;
+    if (i != size)
+      std::memcpy(&tail, data + i, size - i);
+    mix(tail);
+    mix(size);
+    length += size;
+  }
+
+  void CacheKeyHasher::add(std::string_view str) noexcept
+  {
+    add(View<u8>{reinterpret_cast<const u8*>(str.data()), str.size()});
+  }
+
+  void CacheKeyHasher::add(u64 value) noexcept
+  {
+    mix(value);
+    length += sizeof(u64);
+  }
+
+  void CacheKeyHasher::add(const lng::TargetInfo& target) noexcept
+  {
+    add(static_cast<u64>(target.endian));
+    for (auto& info : target.primitive_infos)
+      add(static_cast<u64>(info.size) << 8 | info.align);
+  }
+
+  CacheKey CacheKeyHasher::finish() const noexcept
+  {
+    return CacheKey{
+        details::avalanche(low ^ length),
+        details::avalanche(high ^ std::rotl(length, 32))};
+  }
+
+  std::filesystem::path BuildCache::path_of(
+      CachePhase phase, const CacheKey& key) const
+  {
+    auto name = std::string{
+        details::CACHE_PHASE_NAMES[static_cast<size_t>(phase)]};
+    name += '-';
+    name += key.to_string();
+    name += ENTRY_EXTENSION;
+    return dir / name;
+  }
+
+  bool BuildCache::enable(std::string_view directory, u64 limit) noexcept
+  {
+    namespace fs = std::filesystem;
+    std::error_code error;
+    auto path = fs::path{directory};
+    fs::create_directories(path, error);
+    if (error)
+    {
+      print_error(
+          "Could not create the cache directory '{}' ({})!", directory,
+          error.message());
+      return false;
+    }
+    dir        = std::move(path);
+    size_limit = limit;
+    std::random_device device;
+    process_tag = static_cast<u64>(device()) << 32 | device();
+    return true;
+  }
+
+  Option<std::vector<u8>> BuildCache::load(
+      CachePhase phase, const CacheKey& key) noexcept
+  {
+    COLT_TRACE_FN();
+    namespace fs = std::filesystem;
+    auto path  = path_of(phase, key);
+    auto bytes = details::read_entry(path, phase, key);
+    if (bytes.is_none())
+    {
+      misses.fetch_add(1, std::memory_order_relaxed);
+      return None;
+    }
+    // Marks the entry as recently used (an error only affects 'trim')
+    std::error_code error;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+    hits.fetch_add(1, std::memory_order_relaxed);
+    bytes_loaded.fetch_add(bytes->size(), std::memory_order_relaxed);
+    return bytes;
+  }
+
+  bool BuildCache::store(
+      CachePhase phase, const CacheKey& key, View<u8> bytes) noexcept
+  {
+    COLT_TRACE_FN();
+    namespace fs = std::filesystem;
+    auto path = path_of(phase, key);
+    // Unique to the process and the call: concurrent writers of the same
+    // entry never share a temporary file
+    auto temporary = path;
+    temporary += '.' + std::to_string(process_tag) + '-'
+                 + std::to_string(temporaries.fetch_add(1))
+                 + std::string{TEMPORARY_EXTENSION};
+
+    details::CacheEntryHeader header{
+        details::CacheEntryHeader::MAGIC, details::CacheEntryHeader::CURRENT_VERSION,
+        static_cast<u32>(phase), key, bytes.size()};
+    bool ok;
+    {
+      std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+      ok = file.write(reinterpret_cast<const char*>(&header), sizeof(header))
+           && file.write(
+               reinterpret_cast<const char*>(bytes.data()), bytes.size());
+      file.close();
+      ok = ok && !file.fail();
+    }
+    // Renaming is atomic: readers see the old entry or the new one
+    std::error_code error;
+    if (ok)
+      fs::rename(temporary, path, error);
+    if (!ok || error)
+    {
+      fs::remove(temporary, error);
+      store_failures.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    stores.fetch_add(1, std::memory_order_relaxed);
+    bytes_stored.fetch_add(bytes.size(), std::memory_order_relaxed);
+    return true;
+  }
+
+  void BuildCache::trim() noexcept
+  {
+    COLT_TRACE_FN();
+    namespace fs = std::filesystem;
+    /// @brief An entry of the cache
+    struct Entry
+    {
+      /// @brief The last time the entry was used
+      fs::file_time_type time;
+      /// @brief The size of the entry
+      u64 size;
+      /// @brief The path of the entry
+      fs::path path;
+    };
+
+    const auto now = fs::file_time_type::clock::now();
+    std::vector<Entry> entries;
+    u64 total = 0;
+    std::error_code error;
+    for (auto it = fs::directory_iterator{dir, error};
+         !error && it != fs::directory_iterator{}; it.increment(error))
+    {
+      std::error_code entry_error;
+      auto& path = it->path();
+      auto time  = it->last_write_time(entry_error);
+      if (entry_error)
+        continue;
+      // Left behind by a process that was killed while writing an entry
+      if (path.extension() == TEMPORARY_EXTENSION)
+      {
+        if (now - time > std::chrono::hours{1})
+          fs::remove(path, entry_error);
+        continue;
+      }
+      if (path.extension() != ENTRY_EXTENSION)
+        continue;
+      auto size = it->file_size(entry_error);
+      if (entry_error)
+        continue;
+      total += size;
+      entries.push_back(Entry{time, size, path});
+    }
+    if (size_limit == 0 || total <= size_limit)
+      return;
+
+    // Evicts down to 90% of the limit, so that the next stores do not
+    // each require a trim
+    const u64 target = size_limit - size_limit / 10;
+    std::sort(
+        entries.begin(), entries.end(),
+        [](const Entry& a, const Entry& b) { return a.time < b.time; });
+    for (auto& entry : entries)
+    {
+      if (total <= target)
+        break;
+      // Another process may have evicted the entry already
+      if (fs::remove(entry.path, error))
+        ++evictions;
+      total -= entry.size;
+    }
+  }
+
+  u64 BuildCache::disk_usage() const noexcept
+  {
+    namespace fs = std::filesystem;
+    u64 total = 0;
+    std::error_code error;
+    for (auto it = fs::directory_iterator{dir, error};
+         !error && it != fs::directory_iterator{}; it.increment(error))
+    {
+      std::error_code entry_error;
+      if (it->path().extension() != ENTRY_EXTENSION)
+        continue;
+      if (auto size = it->file_size(entry_error); !entry_error)
+        total += size;
+    }
+    return total;
+  }
+
+  void BuildCache::print_stats() const noexcept
+  {
+    const u64 hit_count  = hits.load(std::memory_order_relaxed);
+    const u64 miss_count = misses.load(std::memory_order_relaxed);
+    const u64 lookups    = hit_count + miss_count;
+    clt::print("Build cache '{}':", dir.string());
+    clt::print(
+        "  {} hits, {} misses ({:.1f}% hit rate), {} bytes loaded", hit_count,
+        miss_count, lookups == 0 ? 0.0 : 100.0 * hit_count / lookups,
+        bytes_loaded.load(std::memory_order_relaxed));
+    clt::print(
+        "  {} entries stored ({} bytes), {} could not be stored",
+        stores.load(std::memory_order_relaxed),
+        bytes_stored.load(std::memory_order_relaxed),
+        store_failures.load(std::memory_order_relaxed));
+    if (size_limit == 0)
+      clt::print("  {} evicted, {} bytes used (no limit)", evictions, disk_usage());
+    else
+      clt::print(
+          "  {} evicted, {} bytes used (limit: {} bytes)", evictions,
+          disk_usage(), size_limit);
+  }
+} // namespace clt
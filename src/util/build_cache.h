@@ -0,0 +1,168 @@
+/*****************************************************************/ /**
+ * @file   build_cache.h
+ * @brief  Contains BuildCache, the content-addressed cache of the
+ *         results of the phases of the compilation ('--cache-dir').
+ * An entry is keyed by a hash of everything that determines the result
+ * of a phase: the content of the file, the version and configuration
+ * of the compiler, the TargetInfo and the relevant flags (see
+ * CacheKeyHasher). The key does not depend on the path of the file, so
+ * identical files share an entry.
+ *
+ * The cache is a directory shared by concurrent compiler processes:
+ * - entries are written to a temporary file then renamed, so readers
+ *   see either no entry or a complete one;
+ * - a hit updates the modification time of the entry, and once the
+ *   size of the directory exceeds the limit, the least recently used
+ *   entries are evicted ('trim');
+ * - entries are validated when loaded: a corrupted entry is a miss.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_COLTC_BUILD_CACHE
+#define HG_COLTC_BUILD_CACHE
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <frontend/target_info.h>
+
+namespace clt
+{
+  /// @brief The phases whose results are cached
+  enum class CachePhase : u32
+  {
+    /// @brief The tokens of a file, as a flat module
+    TOKENS,
+  };
+
+  /// @brief The key of an entry of the build cache (128 bits)
+  struct CacheKey
+  {
+    /// @brief The low 64 bits
+    u64 low;
+    /// @brief The high 64 bits
+    u64 high;
+
+    /// @brief Converts the key to 32 hexadecimal digits
+    /// @return The key, as used in the names of the entries
+    std::string to_string() const noexcept;
+
+    friend bool operator==(const CacheKey&, const CacheKey&) = default;
+  };
+
+  /// @brief Computes a CacheKey from the inputs of a phase.
+  /// This is a fast non-cryptographic hash (two independent 64-bit
+  /// lanes): the cache is local, and is not meant to resist tampering.
+  /// Each input is hashed with its size, so that ("ab", "c") and
+  /// ("a", "bc") produce different keys.
+  class CacheKeyHasher
+  {
+    /// @brief The first lane
+    u64 low = 0x9E3779B97F4A7C15ULL;
+    /// @brief The second lane
+    u64 high = 0xC2B2AE3D27D4EB4FULL;
+    /// @brief The number of bytes hashed
+    u64 length = 0;
+
+    /// @brief Mixes a 64-bit word into both lanes
+    /// @param word The word
+    void mix(u64 word) noexcept;
+
+  public:
+    /// @brief Hashes bytes
+    /// @param bytes The bytes
+    void add(View<u8> bytes) noexcept;
+    /// @brief Hashes a string
+    /// @param str The string
+    void add(std::string_view str) noexcept;
+    /// @brief Hashes an integer
+    /// @param value The integer
+    void add(u64 value) noexcept;
+    /// @brief Hashes the description of a target
+    /// @param target The target
+    void add(const lng::TargetInfo& target) noexcept;
+
+    /// @brief Returns the key of everything hashed so far
+    /// @return The key
+    CacheKey finish() const noexcept;
+  };
+
+  /// @brief A directory storing the results of phases, shared by
+  ///        concurrent compiler processes.
+  /// 'load' and 'store' are thread safe: they can be called by all the
+  /// workers of a Scheduler.
+  class BuildCache
+  {
+    /// @brief The directory of the cache (empty if disabled)
+    std::filesystem::path dir = {};
+    /// @brief The maximum size of the directory in bytes (0 for no limit)
+    u64 size_limit = 0;
+    /// @brief Makes the temporary files of this process unique
+    u64 process_tag = 0;
+    /// @brief The number of temporary files created by this process
+    std::atomic<u64> temporaries = 0;
+
+    /// @brief The number of entries found
+    std::atomic<u64> hits = 0;
+    /// @brief The number of entries not found (or invalid)
+    std::atomic<u64> misses = 0;
+    /// @brief The number of entries stored
+    std::atomic<u64> stores = 0;
+    /// @brief The number of entries that could not be stored
+    std::atomic<u64> store_failures = 0;
+    /// @brief The bytes loaded from the cache
+    std::atomic<u64> bytes_loaded = 0;
+    /// @brief The bytes stored in the cache
+    std::atomic<u64> bytes_stored = 0;
+    /// @brief The number of entries evicted by 'trim'
+    u64 evictions = 0;
+
+    /// @brief Returns the path of an entry
+    std::filesystem::path path_of(CachePhase phase, const CacheKey& key) const;
+
+  public:
+    /// @brief The extension of the entries
+    static constexpr std::string_view ENTRY_EXTENSION = ".ctc";
+    /// @brief The extension of the entries being written
+    static constexpr std::string_view TEMPORARY_EXTENSION = ".tmp";
+
+    /// @brief Enables the cache, creating its directory if needed
+    /// @param directory The directory of the cache
+    /// @param limit The maximum size of the cache in bytes (0 for no limit)
+    /// @return False (after printing an error) if the directory could not
+    ///         be created
+    bool enable(std::string_view directory, u64 limit) noexcept;
+
+    /// @brief Check if the cache is enabled
+    /// @return True if 'enable' succeeded
+    bool is_enabled() const noexcept { return !dir.empty(); }
+
+    /// @brief Loads an entry, marking it as recently used
+    /// @param phase The phase that produced the entry
+    /// @param key The key of the entry
+    /// @return The bytes of the entry, or None on misses
+    Option<std::vector<u8>> load(CachePhase phase, const CacheKey& key) noexcept;
+
+    /// @brief Stores an entry (replacing any existing entry)
+    /// @param phase The phase that produced the entry
+    /// @param key The key of the entry
+    /// @param bytes The bytes of the entry
+    /// @return False if the entry could not be written
+    bool store(CachePhase phase, const CacheKey& key, View<u8> bytes) noexcept;
+
+    /// @brief Evicts the least recently used entries until the cache fits
+    ///        in its size limit, and removes abandoned temporary files
+    void trim() noexcept;
+
+    /// @brief Returns the size of the entries of the cache
+    /// @return The size of the entries in bytes
+    u64 disk_usage() const noexcept;
+
+    /// @brief Prints the statistics of the cache ('--cache-stats')
+    void print_stats() const noexcept;
+  };
+} // namespace clt
+
+#endif // !HG_COLTC_BUILD_CACHE
@@ -0,0 +1,302 @@
+/*****************************************************************/ /**
+ * @file   daemon.cpp
+ * @brief  Implementation of 'run_daemon'.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include "daemon.h"
+
+#ifdef COLT_WINDOWS
+
+namespace clt
+{
+  int run_daemon(std::string_view, fn_request_t) noexcept
+  {
+    print_error("'--daemon' is only supported on POSIX systems!");
+    return 1;
+  }
+} // namespace clt
+
+#else
+
+  #include <csignal>
+  #include <string>
+  #include <unordered_map>
+  #include <vector>
+  #include <fcntl.h>
+  #include <poll.h>
+  #include <sys/socket.h>
+  #include <sys/stat.h>
+  #include <sys/time.h>
+  #include <sys/un.h>
+  #include <sys/wait.h>
+  #include "daemon_protocol.h"
+
+namespace clt
+{
+  namespace details
+  {
+    /// @brief Written to by the signal handlers to wake up the daemon
+    static int SignalPipe[2] = {-1, -1};
+    /// @brief Set once SIGINT or SIGTERM is received
+    static volatile std::sig_atomic_t StopRequested = 0;
+    /// @brief The exit code of a request that could not be read
+    static constexpr int INVALID_REQUEST_CODE = 2;
+    /// @brief The seconds a client has to send its request
+    static constexpr int REQUEST_TIMEOUT = 10;
+    /// @brief The milliseconds the requests have to stop on shutdown,
+    ///        before being killed
+    static constexpr int STOP_TIMEOUT = 2000;
+
+    /// @brief Handles SIGCHLD, SIGINT and SIGTERM
+    /// @param signal The signal
+    static void on_signal(int signal) noexcept
+    {
+      if (signal != SIGCHLD)
+        StopRequested = 1;
+      const int saved = errno;
+      const char byte = 0;
+      (void)::write(SignalPipe[1], &byte, 1);
+      errno = saved;
+    }
+
+    /// @brief Sets the handler of the signals the daemon reacts to
+    /// @param handler The handler (SIG_DFL to restore the default)
+    static void set_signal_handlers(void (*handler)(int)) noexcept
+    {
+      struct sigaction action = {};
+      action.sa_handler       = handler;
+      action.sa_flags         = SA_RESTART | SA_NOCLDSTOP;
+      sigemptyset(&action.sa_mask);
+      for (int signal : {SIGCHLD, SIGINT, SIGTERM})
+        ::sigaction(signal, &action, nullptr);
+    }
+
+    /// @brief Creates the socket of the daemon
+    /// @param path The path of the socket
+    /// @return The listening socket, or -1 (after printing an error)
+    static int listen_on(const std::string& path) noexcept
+    {
+      sockaddr_un address = {};
+      address.sun_family  = AF_UNIX;
+      if (path.size() >= sizeof(address.sun_path))
+      {
+        print_error("The path of the daemon socket is too long ('{}')!", path);
+        return -1;
+      }
+      std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+      auto socket_address = reinterpret_cast<const sockaddr*>(&address);
+
+      // The fallback directory is shared with the other users of '/tmp':
+      // it must have been created by the current user, and kept private
+      if (auto dir = daemon::fallback_socket_dir(); path.starts_with(dir + '/'))
+      {
+        if (::mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST)
+        {
+          print_error("Could not create '{}' ({})!", dir, std::strerror(errno));
+          return -1;
+        }
+        if (!daemon::is_private_dir(dir))
+        {
+          print_error(
+              "'{}' must be a directory only accessible by its owner!", dir);
+          return -1;
+        }
+      }
+
+      // A socket refusing connections was left by a daemon that died
+      if (int probe = ::socket(AF_UNIX, SOCK_STREAM, 0); probe >= 0)
+      {
+        const bool alive = ::connect(probe, socket_address, sizeof(address)) == 0;
+        ::close(probe);
+        if (alive)
+        {
+          print_error("A daemon is already listening on '{}'!", path);
+          return -1;
+        }
+        ::unlink(path.c_str());
+      }
+
+      int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+      if (fd < 0)
+      {
+        print_error(
+            "Could not create the daemon socket ({})!", std::strerror(errno));
+        return -1;
+      }
+      ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+      // Only the user running the daemon can connect to it
+      const auto mask = ::umask(0077);
+      const bool ok   = ::bind(fd, socket_address, sizeof(address)) == 0
+                      && ::listen(fd, SOMAXCONN) == 0;
+      ::umask(mask);
+      if (!ok)
+      {
+        print_error("Could not listen on '{}' ({})!", path, std::strerror(errno));
+        ::close(fd);
+        return -1;
+      }
+      return fd;
+    }
+
+    /// @brief Compiles a request, in the forked process
+    /// @param client The connection to the client
+    /// @param handler The function compiling the request
+    [[noreturn]] static void serve_request(int client, fn_request_t handler) noexcept
+    {
+      // A client that never sends its request must not pin the process
+      timeval timeout = {REQUEST_TIMEOUT, 0};
+      ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+      std::vector<std::string> strings;
+      if (!daemon::is_peer_trusted(client)
+          || !daemon::read_request(client, strings) || strings.size() < 2
+          || ::chdir(strings[0].c_str()) != 0)
+        std::_Exit(INVALID_REQUEST_CODE);
+      // The output of the compilation is streamed to the client
+      if (int null = ::open("/dev/null", O_RDONLY); null >= 0)
+      {
+        ::dup2(null, STDIN_FILENO);
+        ::close(null);
+      }
+      ::dup2(client, STDOUT_FILENO);
+      ::dup2(client, STDERR_FILENO);
+      ::close(client);
+
+      std::vector<const char8_t*> argv;
+      argv.reserve(strings.size() - 1);
+      for (size_t i = 1; i < strings.size(); i++)
+        argv.push_back(reinterpret_cast<const char8_t*>(strings[i].c_str()));
+      const int code = handler(Span<const char8_t*>{argv.data(), argv.size()});
+      // Flushes the output and runs the exit handlers of the request
+      std::exit(code);
+    }
+
+    /// @brief Sends the trailer of a response and closes the connection
+    /// @param client The connection to the client
+    /// @param status The status of the process that compiled the request
+    static void finish_request(int client, int status) noexcept
+    {
+      const int code = WIFEXITED(status)     ? WEXITSTATUS(status)
+                       : WIFSIGNALED(status) ? 128 + WTERMSIG(status)
+                                             : 1;
+      auto trailer   = daemon::encode_trailer(code);
+      // The client may have disconnected: errors are ignored
+      (void)daemon::write_all(client, trailer.data(), trailer.size());
+      ::close(client);
+    }
+
+    /// @brief Completes the requests whose process exited
+    /// @param clients The connections of the requests, by process
+    static void reap_requests(std::unordered_map<pid_t, int>& clients) noexcept
+    {
+      int status;
+      for (pid_t pid; (pid = ::waitpid(-1, &status, WNOHANG)) > 0;)
+      {
+        if (auto it = clients.find(pid); it != clients.end())
+        {
+          finish_request(it->second, status);
+          clients.erase(it);
+        }
+      }
+    }
+  } // namespace details
+
+  int run_daemon(std::string_view socket_path, fn_request_t handler) noexcept
+  {
+    using namespace details;
+
+    auto path = socket_path.empty() ? daemon::default_socket_path()
+                                    : std::string{socket_path};
+    if (::pipe(SignalPipe) != 0)
+    {
+      print_error("Could not create the daemon pipe ({})!", std::strerror(errno));
+      return 1;
+    }
+    for (int fd : SignalPipe)
+    {
+      ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+      ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+    const int server = listen_on(path);
+    if (server < 0)
+      return 1;
+    set_signal_handlers(&on_signal);
+    // A client disconnecting early must not kill the daemon
+    std::signal(SIGPIPE, SIG_IGN);
+    print_message("Listening on '{}'.", path);
+
+    // The connections of the requests being compiled, by process
+    std::unordered_map<pid_t, int> clients;
+    while (StopRequested == 0)
+    {
+      pollfd fds[2] = {{server, POLLIN, 0}, {SignalPipe[0], POLLIN, 0}};
+      if (::poll(fds, 2, -1) < 0 && errno != EINTR)
+      {
+        print_error("Could not wait for requests ({})!", std::strerror(errno));
+        break;
+      }
+      if (fds[1].revents & POLLIN)
+      {
+        char buffer[64];
+        while (::read(SignalPipe[0], buffer, sizeof(buffer)) > 0)
+          ;
+      }
+      reap_requests(clients);
+      if ((fds[0].revents & POLLIN) == 0)
+        continue;
+
+      const int client = ::accept(server, nullptr, nullptr);
+      if (client < 0)
+        continue;
+      ::fcntl(client, F_SETFD, FD_CLOEXEC);
+      // Buffered output would be written again by the forked process
+      std::fflush(nullptr);
+      const pid_t pid = ::fork();
+      if (pid == 0)
+      {
+        ::close(server);
+        ::close(SignalPipe[0]);
+        ::close(SignalPipe[1]);
+        // The client of another request only sees the end of its output
+        // once every process holding its connection closed it
+        for (auto [other, connection] : clients)
+          ::close(connection);
+        set_signal_handlers(SIG_DFL);
+        std::signal(SIGPIPE, SIG_DFL);
+        serve_request(client, handler);
+      }
+      if (pid < 0)
+      {
+        print_error("Could not fork the daemon ({})!", std::strerror(errno));
+        finish_request(client, 1 << 8);
+        continue;
+      }
+      clients.emplace(pid, client);
+    }
+
+    // The requests being compiled are stopped, then killed if they do
+    // not stop in time
+    for (auto [pid, client] : clients)
+      ::kill(pid, SIGTERM);
+    for (int waited = 0; !clients.empty(); waited += 10)
+    {
+      reap_requests(clients);
+      if (waited == STOP_TIMEOUT)
+      {
+        for (auto [pid, client] : clients)
+          ::kill(pid, SIGKILL);
+      }
+      if (!clients.empty())
+        ::poll(nullptr, 0, 10);
+    }
+    ::close(server);
+    ::unlink(path.c_str());
+    ::close(SignalPipe[0]);
+    ::close(SignalPipe[1]);
+    print_message("Daemon stopped.");
+    return 0;
+  }
+} // namespace clt
+
+#endif // COLT_WINDOWS
@@ -0,0 +1,40 @@
+/*****************************************************************/ /**
+ * @file   daemon.h
+ * @brief  Contains 'run_daemon', the server of 'coltc --daemon'.
+ * The daemon listens on a Unix socket (see daemon_protocol.h) and
+ * forks itself for each request: the compilation starts from a process
+ * whose shared libraries, including those of the plugins, are already
+ * loaded and relocated. The forked process runs in the working
+ * directory of the client, and its output is written to the
+ * connection: a crash only affects a single request.
+ * A request is compiled as if 'coltc' was run with its arguments: the
+ * options given to the daemon are not inherited.
+ * Only connections from processes of the user running the daemon are
+ * served, a client that does not send its request in time is
+ * disconnected, and the requests being compiled are killed when the
+ * daemon stops.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_COLTC_DAEMON
+#define HG_COLTC_DAEMON
+
+#include <string_view>
+
+namespace clt
+{
+  /// @brief The function compiling a request (colt_main)
+  using fn_request_t = int (*)(Span<const char8_t*>);
+
+  /// @brief Serves requests until SIGINT or SIGTERM is received.
+  /// This is only supported on POSIX systems.
+  /// @param socket_path The path of the socket to listen on (empty for
+  ///                    the default, see 'daemon::default_socket_path')
+  /// @param handler The function to call (in a forked process) with the
+  ///                arguments of each request
+  /// @return The exit code of the daemon
+  int run_daemon(std::string_view socket_path, fn_request_t handler) noexcept;
+} // namespace clt
+
+#endif // !HG_COLTC_DAEMON
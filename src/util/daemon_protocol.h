@@ -0,0 +1,204 @@
+/*****************************************************************/ /**
+ * @file   daemon_protocol.h
+ * @brief  Contains the protocol spoken over the Unix socket of
+ *         'coltc --daemon' and the thin client 'coltc-client'.
+ * This header does not depend on the rest of the compiler (nor on
+ * colt-cpp): the client only links the C++ standard library, so that
+ * it starts in a fraction of the time 'coltc' takes.
+ *
+ * A connection carries a single request:
+ * - the client sends REQUEST_MAGIC, PROTOCOL_VERSION, the number of
+ *   strings then each string (its size followed by its bytes): the
+ *   working directory of the client, followed by its arguments;
+ * - the daemon streams the output (stdout and stderr) of the
+ *   compilation, followed by a trailer: EXIT_MAGIC then the exit code.
+ * Integers are 32-bit, in the byte order of the machine (both ends run
+ * on the same machine).
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_COLTC_DAEMON_PROTOCOL
+#define HG_COLTC_DAEMON_PROTOCOL
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace clt::daemon
+{
+  /// @brief The first bytes of a request
+  static constexpr std::array<char, 4> REQUEST_MAGIC = {'C', 'L', 'T', 'Q'};
+  /// @brief The first bytes of the trailer of a response
+  static constexpr std::array<char, 4> EXIT_MAGIC = {'C', 'L', 'T', 'X'};
+  /// @brief The version of the protocol
+  static constexpr std::uint32_t PROTOCOL_VERSION = 1;
+  /// @brief The size of the trailer (EXIT_MAGIC + exit code)
+  static constexpr size_t TRAILER_SIZE = 8;
+  /// @brief The maximum number of strings of a request
+  static constexpr std::uint32_t MAX_STRINGS = 1U << 16;
+  /// @brief The maximum size of a string of a request
+  static constexpr std::uint32_t MAX_STRING_SIZE = 1U << 20;
+  /// @brief The environment variable overriding the path of the socket
+  static constexpr const char* SOCKET_VARIABLE = "COLTC_DAEMON_SOCKET";
+
+  /// @brief Returns the directory of the socket when the system provides
+  ///        no private directory: '/tmp/coltc-<uid>'.
+  /// It is created by the daemon, and must only be accessible by its owner.
+  /// @return The path of the directory
+  inline std::string fallback_socket_dir()
+  {
+    return "/tmp/coltc-" + std::to_string(getuid());
+  }
+
+  /// @brief Returns the path of the socket used when none is specified:
+  ///        '$COLTC_DAEMON_SOCKET', else '$XDG_RUNTIME_DIR/coltc.sock',
+  ///        else 'fallback_socket_dir()/coltc.sock'.
+  /// @return The path of the socket
+  inline std::string default_socket_path()
+  {
+    if (auto path = std::getenv(SOCKET_VARIABLE); path != nullptr && *path != 0)
+      return path;
+    if (auto dir = std::getenv("XDG_RUNTIME_DIR"); dir != nullptr && *dir != 0)
+      return std::string{dir} + "/coltc.sock";
+    return fallback_socket_dir() + "/coltc.sock";
+  }
+
+  /// @brief Check if a directory is owned by the current user, and only
+  ///        accessible by them (symbolic links are rejected)
+  /// @param dir The path of the directory
+  /// @return True if the directory is private
+  inline bool is_private_dir(const std::string& dir) noexcept
+  {
+    struct stat info;
+    return ::lstat(dir.c_str(), &info) == 0 && S_ISDIR(info.st_mode)
+           && info.st_uid == getuid() && (info.st_mode & 077) == 0;
+  }
+
+  /// @brief Check if the process at the other end of a Unix socket runs
+  ///        as the current user
+  /// @param fd The connected socket
+  /// @return True if the peer runs as the current user
+  inline bool is_peer_trusted(int fd) noexcept
+  {
+  #ifdef SO_PEERCRED
+    struct ucred cred;
+    socklen_t size = sizeof(cred);
+    return ::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &size) == 0
+           && cred.uid == getuid();
+  #else
+    uid_t uid;
+    gid_t gid;
+    return ::getpeereid(fd, &uid, &gid) == 0 && uid == getuid();
+  #endif // SO_PEERCRED
+  }
+
+  /// @brief Writes all the bytes of a buffer to a file descriptor
+  /// @param fd The file descriptor
+  /// @param data The bytes
+  /// @param size The number of bytes
+  /// @return False on errors
+  inline bool write_all(int fd, const void* data, size_t size) noexcept
+  {
+    auto bytes = static_cast<const char*>(data);
+    while (size != 0)
+    {
+      auto written = ::write(fd, bytes, size);
+      if (written < 0 && errno == EINTR)
+        continue;
+      if (written <= 0)
+        return false;
+      bytes += written;
+      size -= static_cast<size_t>(written);
+    }
+    return true;
+  }
+
+  /// @brief Reads exactly 'size' bytes from a file descriptor
+  /// @param fd The file descriptor
+  /// @param data Where to write the bytes
+  /// @param size The number of bytes
+  /// @return False on errors or if the end of the stream was reached
+  inline bool read_all(int fd, void* data, size_t size) noexcept
+  {
+    auto bytes = static_cast<char*>(data);
+    while (size != 0)
+    {
+      auto count = ::read(fd, bytes, size);
+      if (count < 0 && errno == EINTR)
+        continue;
+      if (count <= 0)
+        return false;
+      bytes += count;
+      size -= static_cast<size_t>(count);
+    }
+    return true;
+  }
+
+  /// @brief Encodes a request
+  /// @param strings The working directory, followed by the arguments
+  /// @return The bytes of the request
+  inline std::string encode_request(const std::vector<std::string_view>& strings)
+  {
+    const auto append_u32 = [](std::string& out, std::uint32_t value)
+    { out.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+
+    std::string out{REQUEST_MAGIC.data(), REQUEST_MAGIC.size()};
+    append_u32(out, PROTOCOL_VERSION);
+    append_u32(out, static_cast<std::uint32_t>(strings.size()));
+    for (auto str : strings)
+    {
+      append_u32(out, static_cast<std::uint32_t>(str.size()));
+      out.append(str);
+    }
+    return out;
+  }
+
+  /// @brief Reads a request
+  /// @param fd The file descriptor from which to read
+  /// @param strings Where to write the working directory, followed by
+  ///                the arguments
+  /// @return False if the request is invalid
+  inline bool read_request(int fd, std::vector<std::string>& strings) noexcept
+  {
+    std::array<char, 4> magic;
+    std::uint32_t version, count;
+    if (!read_all(fd, magic.data(), magic.size()) || magic != REQUEST_MAGIC
+        || !read_all(fd, &version, sizeof(version)) || version != PROTOCOL_VERSION
+        || !read_all(fd, &count, sizeof(count)) || count == 0
+        || count > MAX_STRINGS)
+      return false;
+    strings.resize(count);
+    for (auto& str : strings)
+    {
+      std::uint32_t size;
+      if (!read_all(fd, &size, sizeof(size)) || size > MAX_STRING_SIZE)
+        return false;
+      str.resize(size);
+      if (!read_all(fd, str.data(), size))
+        return false;
+    }
+    return true;
+  }
+
+  /// @brief Encodes the trailer of a response
+  /// @param code The exit code of the compilation
+  /// @return The trailer
+  inline std::array<char, TRAILER_SIZE> encode_trailer(std::int32_t code) noexcept
+  {
+    std::array<char, TRAILER_SIZE> trailer;
+    std::memcpy(trailer.data(), EXIT_MAGIC.data(), EXIT_MAGIC.size());
+    std::memcpy(trailer.data() + EXIT_MAGIC.size(), &code, sizeof(code));
+    return trailer;
+  }
+} // namespace clt::daemon
+
+#endif // !HG_COLTC_DAEMON_PROTOCOL
@@ -0,0 +1,128 @@
+/*****************************************************************/ /**
+ * @file   ffi_caller.cpp
+ * @brief  Implementation of SignatureCache.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include <algorithm>
+#include "ffi_caller.h"
+
+namespace clt::ffi
+{
+  namespace details
+  {
+    /// @brief Check if libffi returns a type through a wider ffi_arg
+    /// @param type The return type
+    /// @return True for integral types narrower than ffi_arg
+    static bool is_widened(const ffi_type* type) noexcept
+    {
+      return type->size < sizeof(ffi_arg) && type->type != FFI_TYPE_VOID
+             && type->type != FFI_TYPE_STRUCT && type->type != FFI_TYPE_FLOAT;
+    }
+
+    /// @brief Stores the low 'size' bytes of a widened return value
+    /// @param dst Where to store the value
+    /// @param value The value returned by libffi
+    /// @param size The size of the return type
+    static void store_narrowed(void* dst, ffi_arg value, size_t size) noexcept
+    {
+      switch (size)
+      {
+      case 1:
+        *static_cast<u8*>(dst) = static_cast<u8>(value);
+        break;
+      case 2:
+        *static_cast<u16*>(dst) = static_cast<u16>(value);
+        break;
+      case 4:
+        *static_cast<u32*>(dst) = static_cast<u32>(value);
+        break;
+      default:
+        unreachable("Invalid integral size!");
+      }
+    }
+  } // namespace details
+
+  Expect<const ffi_cif*, ffi_status> SignatureCache::get(
+      ffi_type* ret, Span<ffi_type* const> args, ffi_abi abi) noexcept
+  {
+    // FNV-1a over the ABI and the addresses of the types
+    u64 hash        = 14695981039346656037ULL;
+    const auto step = [&hash](u64 value)
+    { hash = (hash ^ value) * 1099511628211ULL; };
+    step(static_cast<u64>(abi));
+    step(reinterpret_cast<uintptr_t>(ret));
+    for (size_t i = 0; i < args.size(); i++)
+      step(reinterpret_cast<uintptr_t>(args.data()[i]));
+
+    std::scoped_lock guard{lock};
+    auto& bucket = cache[hash];
+    for (auto& entry : bucket)
+    {
+      if (entry->cif.abi == abi && entry->cif.rtype == ret
+          && entry->types.size() == args.size()
+          && std::equal(entry->types.begin(), entry->types.end(), args.data()))
+        return &entry->cif;
+    }
+
+    auto entry   = std::make_unique<Entry>();
+    entry->types = std::vector<ffi_type*>{args.data(), args.data() + args.size()};
+    auto status  = ffi_prep_cif(
+        &entry->cif, abi, static_cast<unsigned>(entry->types.size()), ret,
+        entry->types.data());
+    if (status != FFI_OK)
+      return {Error, status};
+    count++;
+    return &bucket.emplace_back(std::move(entry))->cif;
+  }
+
+  void DynamicCall::call_into(void* ret, void** args) const noexcept
+  {
+    auto cif_ptr = const_cast<ffi_cif*>(cif);
+    if (!details::is_widened(cif->rtype))
+      return ffi_call(cif_ptr, FFI_FN(fn), ret, args);
+    ffi_arg value;
+    ffi_call(cif_ptr, FFI_FN(fn), &value, args);
+    details::store_narrowed(ret, value, cif->rtype->size);
+  }
+
+  void DynamicCall::batch(
+      size_t rows, RetColumn out, Span<const ArgColumn> args) const noexcept
+  {
+    assert_true("Invalid column count!", args.size() == cif->nargs);
+    static constexpr size_t INLINE_ARGS = 16;
+
+    void* inline_values[INLINE_ARGS];
+    std::vector<void*> heap_values;
+    void** values = inline_values;
+    if (args.size() > INLINE_ARGS)
+    {
+      heap_values.resize(args.size());
+      values = heap_values.data();
+    }
+    for (size_t i = 0; i < args.size(); i++)
+      values[i] = const_cast<void*>(args.data()[i].base);
+
+    auto cif_ptr      = const_cast<ffi_cif*>(cif);
+    const auto type   = cif->rtype->type;
+    const bool narrow = details::is_widened(cif->rtype);
+    auto result       = static_cast<char*>(out.base);
+
+    for (size_t row = 0; row < rows; row++)
+    {
+      if (!narrow)
+        ffi_call(
+            cif_ptr, FFI_FN(fn), type == FFI_TYPE_VOID ? nullptr : result, values);
+      else
+      {
+        ffi_arg value;
+        ffi_call(cif_ptr, FFI_FN(fn), &value, values);
+        details::store_narrowed(result, value, cif->rtype->size);
+      }
+      result += out.stride;
+      for (size_t i = 0; i < args.size(); i++)
+        values[i] = static_cast<char*>(values[i]) + args.data()[i].stride;
+    }
+  }
+} // namespace clt::ffi
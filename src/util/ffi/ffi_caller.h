@@ -10,18 +10,32 @@
 
 #include <type_traits>
 #include <concepts>
+#include <cstdlib>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include <ffi.h>
 #include <colt/typedefs.h>
 #include <colt/meta/reflect.h>
+#include <colt/dsa/expect.h>
+#include <colt/io/print.h>
 
 namespace clt::ffi
 {
+  template<typename Fn>
+  class PreparedCall;
+
   /// @brief Wrapper over libffi.
-  /// This class is NOT thread safe as type informations are stored
-  /// in a mutable global variable.
+  /// The type informations of structs are stored in mutable global
+  /// variables: they are completed once (see 'prepare_type') before
+  /// being used by any signature.
   class FFICaller
   {
+    template<typename Fn>
+    friend class PreparedCall;
+
     /// @brief Converts a C++ type to its FFI equivalent
     /// @tparam T The type
     /// @return Pointer to ffi_type
@@ -121,8 +135,38 @@ namespace clt::ffi
       return &STRUCT_FFI_TYPE<T>;
     }
 
+    /// @brief Computes the size and alignment of the ffi_type of a struct
+    ///        (and of its members) once.
+    /// libffi writes them in place when preparing a signature using the
+    /// struct: doing it once, behind a function-local static, avoids
+    /// concurrent writes when signatures are prepared by several threads.
+    /// @tparam T The type (nothing is done if it is not a struct)
+    template<typename T>
+    static void prepare_type() noexcept
+    {
+      if constexpr (
+          meta::reflectable<T> && !std::is_fundamental_v<T>
+          && !std::is_pointer_v<T>)
+      {
+        static const bool PREPARED = []
+        {
+          using namespace meta;
+          for_each(
+              Members, T{}, []<typename Ty>(const Ty&) { prepare_type<Ty>(); });
+          ffi_cif cif;
+          return ffi_prep_cif(
+                     &cif, FFI_DEFAULT_ABI, 0, &STRUCT_FFI_TYPE<T>, nullptr)
+                 == FFI_OK;
+        }();
+        (void)PREPARED;
+      }
+    }
+
   public:
-    /// @brief Calls a Foreign Function
+    /// @brief Calls a Foreign Function.
+    /// The ffi_cif of each signature is only prepared once.
+    /// If libffi cannot prepare the signature, the process is aborted:
+    /// use PreparedCall::prepare to handle the error instead.
     /// @tparam Ret The return type of the function
     /// @tparam ...Args The arguments type
     /// @param fn The address of the function
@@ -131,25 +175,256 @@ namespace clt::ffi
     template<typename Ret, typename... Args>
     static Ret call(void* fn, Args&&... args)
     {
-      constexpr size_t SIZE         = sizeof...(Args) + 1;
-      ffi_type* CONSTANT_ARGS[SIZE] = {type_to_ffi<Ret>(), type_to_ffi<Args>()...};
+      auto prepared = PreparedCall<Ret(std::decay_t<Args>...)>::prepare(fn);
+      if (prepared.is_error())
+      {
+        print_error(
+            "Could not prepare the FFI call (ffi_status: {})!",
+            static_cast<int>(prepared.error()));
+        std::abort();
+      }
+      return (*prepared)(std::forward<Args>(args)...);
+    }
+  };
 
-      std::conditional_t<(sizeof(Ret) < sizeof(long)), ffi_arg, Ret> result;
+  /// @brief A column of arguments: the argument of row 'i' is at
+  ///        'base + i * stride'.
+  struct ArgColumn
+  {
+    /// @brief The argument of the first row
+    const void* base;
+    /// @brief The distance in bytes between two rows
+    size_t stride;
+  };
 
-      ffi_cif cif;
+  /// @brief A column of return values: the result of row 'i' is written
+  ///        to 'base + i * stride'.
+  struct RetColumn
+  {
+    /// @brief The result of the first row (nullptr for void)
+    void* base;
+    /// @brief The distance in bytes between two rows
+    size_t stride;
+  };
+
+  template<typename Ret, typename... Args>
+  /// @brief Calls 'fn' for each row of the argument columns.
+  /// As the signature is known, this is a plain C++ loop (no libffi).
+  /// @param fn The function to call
+  /// @param rows The number of rows
+  /// @param out The output column ('rows' elements, ignored for void)
+  /// @param ...columns The argument columns ('rows' elements each)
+  void call_batch(Ret (*fn)(Args...), size_t rows, Ret* out, const Args*... columns)
+  {
+    if constexpr (std::is_void_v<Ret>)
+    {
+      for (size_t i = 0; i < rows; i++)
+        fn(columns[i]...);
+    }
+    else
+    {
+      for (size_t i = 0; i < rows; i++)
+        out[i] = fn(columns[i]...);
+    }
+  }
+
+  template<typename Ret, typename... Args>
+  /// @brief A call to a Foreign Function whose signature is known at
+  ///        compile time. The ffi_cif is prepared once per signature
+  ///        (on the first 'prepare'), calling only runs 'ffi_call'.
+  /// @tparam Ret The return type of the function
+  /// @tparam ...Args The arguments type
+  class PreparedCall<Ret(Args...)>
+  {
+    /// @brief The prepared signature
+    const ffi_cif* cif;
+    /// @brief The function to call
+    void* fn;
+
+    /// @brief Constructor
+    /// @param cif The prepared signature
+    /// @param fn The function to call
+    PreparedCall(const ffi_cif* cif, void* fn) noexcept
+        : cif(cif)
+        , fn(fn)
+    {
+    }
+
+  public:
+    /// @brief Prepares the signature (only once)
+    /// @return The prepared signature or the error returned by 'ffi_prep_cif'
+    static Expect<const ffi_cif*, ffi_status> signature() noexcept
+    {
+      static ffi_type* TYPES[] = {
+          FFICaller::type_to_ffi<Ret>(), FFICaller::type_to_ffi<Args>()...};
+      static ffi_cif CIF;
+      static const ffi_status STATUS = []
+      {
+        // libffi computes the size and alignment of structs in place
+        FFICaller::prepare_type<Ret>();
+        (FFICaller::prepare_type<Args>(), ...);
+        return ffi_prep_cif(
+            &CIF, FFI_DEFAULT_ABI, static_cast<unsigned>(sizeof...(Args)),
+            TYPES[0], TYPES + 1);
+      }();
+      if (STATUS != FFI_OK)
+        return {Error, STATUS};
+      return &CIF;
+    }
+    /// @brief Prepares a call to 'fn'
+    /// @param fn The function to call
+    /// @return The prepared call or the error returned by 'ffi_prep_cif'
+    static Expect<PreparedCall, ffi_status> prepare(void* fn) noexcept
+    {
+      auto cif = signature();
+      if (cif.is_error())
+        return {Error, cif.error()};
+      return PreparedCall{*cif, fn};
+    }
 
-      // Prepare the ffi_cif structure.
-      ffi_status status = ffi_prep_cif(
-          &cif, FFI_DEFAULT_ABI, SIZE - 1, CONSTANT_ARGS[0], CONSTANT_ARGS + 1);
-      if (status != FFI_OK)
+    /// @brief Calls the function
+    /// @param ...args The arguments to pass to the function
+    /// @return The return value of the function
+    Ret operator()(Args... args) const noexcept
+    {
+      // +1 as zero-sized arrays are not allowed
+      void* values[sizeof...(Args) + 1] = {
+          const_cast<void*>(static_cast<const void*>(&args))..., nullptr};
+      auto cif_ptr = const_cast<ffi_cif*>(cif);
+
+      if constexpr (std::is_void_v<Ret>)
+        ffi_call(cif_ptr, FFI_FN(fn), nullptr, values);
+      else if constexpr (std::is_integral_v<Ret> && sizeof(Ret) < sizeof(ffi_arg))
+      {
+        // Integral return values are widened to ffi_arg by libffi
+        ffi_arg result;
+        ffi_call(cif_ptr, FFI_FN(fn), &result, values);
+        return static_cast<Ret>(result);
+      }
+      else
       {
-        // Handle the ffi_status error.
+        Ret result;
+        ffi_call(cif_ptr, FFI_FN(fn), &result, values);
+        return result;
       }
-      void* arg_values[SIZE] = {((void*)&args)...};
+    }
+
+    /// @brief Returns the prepared signature
+    /// @return The prepared signature
+    const ffi_cif* prepared_signature() const noexcept { return cif; }
+
+    /// @brief Calls the function for each row of the argument columns.
+    /// The signature being known, the function is called directly (no libffi).
+    /// @param rows The number of rows
+    /// @param out The output column ('rows' elements, ignored for void)
+    /// @param ...columns The argument columns ('rows' elements each)
+    void batch(size_t rows, Ret* out, const Args*... columns) const noexcept
+    {
+      call_batch(reinterpret_cast<Ret (*)(Args...)>(fn), rows, out, columns...);
+    }
+
+    /// @brief Returns the function to call
+    /// @return The function to call
+    void* function() const noexcept { return fn; }
+  };
+
+  /// @brief Cache of ffi_cif for signatures only known at runtime.
+  /// Each distinct signature is prepared once, the returned ffi_cif
+  /// remains valid as long as the cache is alive. This class is thread safe.
+  class SignatureCache
+  {
+    /// @brief A prepared signature
+    struct Entry
+    {
+      /// @brief The prepared signature (points to 'types')
+      ffi_cif cif;
+      /// @brief The argument types
+      std::vector<ffi_type*> types;
+    };
+
+    /// @brief Protects 'cache'
+    std::mutex lock;
+    /// @brief Maps the hash of (abi, return type, argument types) to the
+    ///        entries with that hash (usually a single one)
+    std::unordered_map<u64, std::vector<std::unique_ptr<Entry>>> cache;
+    /// @brief The number of entries
+    size_t count = 0;
+
+  public:
+    /// @brief Returns the prepared signature of a function.
+    /// The types must outlive the cache.
+    /// @param ret The return type
+    /// @param args The arguments type
+    /// @param abi The ABI to use
+    /// @return The prepared signature or the error returned by 'ffi_prep_cif'
+    Expect<const ffi_cif*, ffi_status> get(
+        ffi_type* ret, Span<ffi_type* const> args,
+        ffi_abi abi = FFI_DEFAULT_ABI) noexcept;
+
+    /// @brief Returns the number of prepared signatures
+    /// @return The number of prepared signatures
+    size_t size() noexcept
+    {
+      std::scoped_lock guard{lock};
+      return count;
+    }
+
+    /// @brief Returns the global signature cache
+    /// @return The global signature cache
+    static SignatureCache& global() noexcept
+    {
+      static SignatureCache CACHE;
+      return CACHE;
+    }
+  };
+
+  /// @brief A call to a Foreign Function whose signature is only known
+  ///        at runtime (see SignatureCache).
+  class DynamicCall
+  {
+    /// @brief The prepared signature
+    const ffi_cif* cif;
+    /// @brief The function to call
+    void* fn;
 
-      ffi_call(&cif, FFI_FN(fn), &result, arg_values);
-      return static_cast<Ret>(result);
+  public:
+    /// @brief Constructor
+    /// @param cif The prepared signature (from a SignatureCache)
+    /// @param fn The function to call
+    DynamicCall(const ffi_cif* cif, void* fn) noexcept
+        : cif(cif)
+        , fn(fn)
+    {
     }
+
+    /// @brief Calls the function
+    /// @param ret Pointer to the storage of the return value (at least
+    ///            sizeof(ffi_arg) bytes for integral types), or nullptr for void
+    /// @param args Pointers to each argument
+    void operator()(void* ret, void** args) const noexcept
+    {
+      ffi_call(const_cast<ffi_cif*>(cif), FFI_FN(fn), ret, args);
+    }
+
+    /// @brief Calls the function, narrowing integral results narrower
+    ///        than ffi_arg: 'ret' only needs to be as big as the return type.
+    /// @param ret Pointer to the storage of the return value, or nullptr for void
+    /// @param args Pointers to each argument
+    void call_into(void* ret, void** args) const noexcept;
+
+    /// @brief Calls the function for each row of the argument columns.
+    /// The array of argument pointers is set up once, and only advanced
+    /// by the column strides between two calls. Integral results narrower
+    /// than ffi_arg are narrowed, so 'out' may be densely packed.
+    /// @param rows The number of rows
+    /// @param out The output column (ignored for void)
+    /// @param args The argument columns (one per argument of the signature)
+    void batch(
+        size_t rows, RetColumn out, Span<const ArgColumn> args) const noexcept;
+
+    /// @brief Returns the prepared signature
+    /// @return The prepared signature
+    const ffi_cif* prepared_signature() const noexcept { return cif; }
   };
 } // namespace clt
 
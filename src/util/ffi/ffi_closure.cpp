@@ -0,0 +1,45 @@
+/*****************************************************************/ /**
+ * @file   ffi_closure.cpp
+ * @brief  Implementation of ClosurePool.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include "ffi_closure.h"
+
+namespace clt::ffi
+{
+  ClosurePool::~ClosurePool() noexcept
+  {
+    assert_true(
+        "Callbacks are still using the pool!",
+        free_slots.size() == all_slots.size());
+    for (auto& slot : all_slots)
+      ffi_closure_free(slot.closure);
+  }
+
+  Option<ClosureSlot> ClosurePool::acquire() noexcept
+  {
+    std::scoped_lock guard{lock};
+    if (!free_slots.empty())
+    {
+      auto slot = free_slots.back();
+      free_slots.pop_back();
+      return slot;
+    }
+    void* code   = nullptr;
+    // The callable is stored after the closure
+    auto closure = static_cast<ffi_closure*>(ffi_closure_alloc(
+        ClosureSlot::STORAGE_OFFSET + ClosureSlot::STORAGE_SIZE, &code));
+    if (closure == nullptr)
+      return None;
+    all_slots.push_back(ClosureSlot{closure, code});
+    return all_slots.back();
+  }
+
+  void ClosurePool::release(ClosureSlot slot) noexcept
+  {
+    std::scoped_lock guard{lock};
+    free_slots.push_back(slot);
+  }
+} // namespace clt::ffi
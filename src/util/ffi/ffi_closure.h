@@ -0,0 +1,254 @@
+/*****************************************************************/ /**
+ * @file   ffi_closure.h
+ * @brief  Contains Callback, which turns a C++ callable into a C
+ *         function pointer using libffi closures.
+ * Plugins and compile-time code can then call back into the compiler
+ * without a hand-written C shim per callback.
+ * The executable memory of closures is owned by a ClosurePool, which
+ * reuses the closures of destroyed callbacks. The callable is stored
+ * in the closure itself: creating a callback does not allocate once
+ * the pool has a free closure.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_UTIL_FFI_CLOSURE
+#define HG_UTIL_FFI_CLOSURE
+
+#include <new>
+#include <utility>
+#include "ffi_caller.h"
+
+namespace clt::ffi
+{
+  /// @brief A closure allocated by a ClosurePool, followed by the
+  ///        storage of the callable it calls
+  struct ClosureSlot
+  {
+    /// @brief The alignment of the storage (that of 'ffi_closure_alloc')
+    static constexpr size_t STORAGE_ALIGN = 2 * sizeof(void*);
+    /// @brief The offset of the storage from the closure
+    static constexpr size_t STORAGE_OFFSET =
+        (sizeof(ffi_closure) + STORAGE_ALIGN - 1) & ~(STORAGE_ALIGN - 1);
+    /// @brief The size of the storage
+    static constexpr size_t STORAGE_SIZE = 64;
+
+    /// @brief The writable address of the closure
+    ffi_closure* closure;
+    /// @brief The executable address of the closure
+    void* code;
+
+    /// @brief Returns the storage of the callable
+    /// @return The storage of the callable (STORAGE_SIZE bytes)
+    void* storage() const noexcept
+    {
+      return reinterpret_cast<u8*>(closure) + STORAGE_OFFSET;
+    }
+  };
+
+  /// @brief Pool of libffi closures.
+  /// Closures are only freed when the pool is destroyed: released
+  /// closures are reused by the next acquisition. This class is thread safe.
+  class ClosurePool
+  {
+    /// @brief Protects all the members below
+    std::mutex lock;
+    /// @brief The released closures
+    std::vector<ClosureSlot> free_slots;
+    /// @brief All the closures allocated by the pool
+    std::vector<ClosureSlot> all_slots;
+
+  public:
+    ClosurePool() noexcept                     = default;
+    ClosurePool(ClosurePool&&)                 = delete;
+    ClosurePool(const ClosurePool&)            = delete;
+    ClosurePool& operator=(const ClosurePool&) = delete;
+
+    /// @brief Frees all the closures.
+    /// No callback using the pool may be alive.
+    ~ClosurePool() noexcept;
+
+    /// @brief Returns a released closure or allocates a new one
+    /// @return The closure or None if the allocation failed
+    Option<ClosureSlot> acquire() noexcept;
+
+    /// @brief Releases a closure to be reused
+    /// @param slot The closure (acquired from this pool)
+    void release(ClosureSlot slot) noexcept;
+
+    /// @brief Returns the number of closures allocated by the pool
+    /// @return The number of closures allocated
+    size_t allocated() noexcept
+    {
+      std::scoped_lock guard{lock};
+      return all_slots.size();
+    }
+
+    /// @brief Returns the global closure pool
+    /// @return The global closure pool
+    static ClosurePool& global() noexcept
+    {
+      static ClosurePool POOL;
+      return POOL;
+    }
+  };
+
+  template<typename Fn>
+  class Callback;
+
+  template<typename Ret, typename... Args>
+  /// @brief Owns a C function pointer of type 'Ret(*)(Args...)' that
+  ///        calls a C++ callable. The pointer is valid as long as the
+  ///        Callback is alive.
+  /// @tparam Ret The return type of the function pointer
+  /// @tparam ...Args The arguments type of the function pointer
+  class Callback<Ret(Args...)>
+  {
+  public:
+    /// @brief The type of the function pointer
+    using fn_ptr_t = Ret (*)(Args...);
+
+  private:
+    /// @brief Destroys the callable stored in a closure
+    using fn_destroy_t = void (*)(void*) noexcept;
+
+    /// @brief The pool owning the closure
+    ClosurePool* pool;
+    /// @brief The closure (which stores the callable)
+    ClosureSlot slot;
+    /// @brief Destroys the callable
+    fn_destroy_t destroy;
+
+    /// @brief Constructor
+    Callback(ClosurePool* pool, ClosureSlot slot, fn_destroy_t destroy) noexcept
+        : pool(pool)
+        , slot(slot)
+        , destroy(destroy)
+    {
+    }
+
+    template<typename Fn, size_t... I>
+    /// @brief Unpacks the arguments and calls the callable
+    static void dispatch(
+        void* ret, void** args, Fn& callable, std::index_sequence<I...>) noexcept
+    {
+      if constexpr (std::is_void_v<Ret>)
+        callable(*static_cast<std::remove_reference_t<Args>*>(args[I])...);
+      else if constexpr (std::is_integral_v<Ret> && sizeof(Ret) < sizeof(ffi_arg))
+      {
+        // Integral return values must be widened to ffi_arg
+        *static_cast<ffi_arg*>(ret) = static_cast<ffi_arg>(
+            callable(*static_cast<std::remove_reference_t<Args>*>(args[I])...));
+      }
+      else
+      {
+        *static_cast<Ret*>(ret) =
+            callable(*static_cast<std::remove_reference_t<Args>*>(args[I])...);
+      }
+    }
+
+    template<typename Fn>
+    /// @brief The function called by libffi when the closure is called
+    static void thunk(ffi_cif*, void* ret, void** args, void* user_data) noexcept
+    {
+      dispatch(
+          ret, args, *static_cast<Fn*>(user_data),
+          std::index_sequence_for<Args...>{});
+    }
+
+    template<typename Fn>
+    /// @brief Destroys the callable stored in a closure
+    static void destroy_callable(void* storage) noexcept
+    {
+      static_cast<Fn*>(storage)->~Fn();
+    }
+
+  public:
+    Callback(const Callback&)            = delete;
+    Callback& operator=(const Callback&) = delete;
+
+    /// @brief Move constructor
+    Callback(Callback&& other) noexcept
+        : pool(std::exchange(other.pool, nullptr))
+        , slot(other.slot)
+        , destroy(other.destroy)
+    {
+    }
+
+    /// @brief Move assignment operator
+    Callback& operator=(Callback&& other) noexcept
+    {
+      std::swap(pool, other.pool);
+      std::swap(slot, other.slot);
+      std::swap(destroy, other.destroy);
+      return *this;
+    }
+
+    /// @brief Destroys the callable and releases the closure to its pool
+    ~Callback() noexcept
+    {
+      if (pool == nullptr)
+        return;
+      destroy(slot.storage());
+      pool->release(slot);
+    }
+
+    /// @brief Errors that can happen when creating a callback
+    enum class CallbackError : u8
+    {
+      /// @brief The closure could not be allocated
+      ALLOC_ERR,
+      /// @brief libffi refused the signature or the closure
+      PREP_ERR,
+    };
+
+    template<typename Fn>
+    /// @brief Creates a callback.
+    /// The callable is stored in the closure: it must fit in
+    /// ClosureSlot::STORAGE_SIZE bytes (capture a pointer to bigger states).
+    /// @param fn The callable to call through the function pointer
+    /// @param pool The pool from which to acquire the closure
+    /// @return The callback or an error
+    static Expect<Callback, CallbackError> make(
+        Fn&& fn, ClosurePool& pool = ClosurePool::global()) noexcept
+    {
+      using callable_t = std::decay_t<Fn>;
+      static_assert(
+          sizeof(callable_t) <= ClosureSlot::STORAGE_SIZE
+              && alignof(callable_t) <= ClosureSlot::STORAGE_ALIGN,
+          "The callable does not fit in a closure!");
+      static_assert(
+          std::is_nothrow_constructible_v<callable_t, Fn&&>
+              && std::is_nothrow_destructible_v<callable_t>,
+          "The callable must be nothrow constructible and destructible!");
+
+      auto cif = PreparedCall<Ret(Args...)>::signature();
+      if (cif.is_error())
+        return {Error, CallbackError::PREP_ERR};
+      auto slot = pool.acquire();
+      if (slot.is_none())
+        return {Error, CallbackError::ALLOC_ERR};
+
+      auto callable = new (slot->storage()) callable_t(std::forward<Fn>(fn));
+      if (ffi_prep_closure_loc(
+              slot->closure, const_cast<ffi_cif*>(*cif), &thunk<callable_t>,
+              callable, slot->code)
+          != FFI_OK)
+      {
+        callable->~callable_t();
+        pool.release(*slot);
+        return {Error, CallbackError::PREP_ERR};
+      }
+      return Callback{&pool, *slot, &destroy_callable<callable_t>};
+    }
+
+    /// @brief Returns the function pointer
+    /// @return The function pointer (valid while the callback is alive)
+    fn_ptr_t function() const noexcept
+    {
+      return reinterpret_cast<fn_ptr_t>(slot.code);
+    }
+  };
+} // namespace clt::ffi
+
+#endif // !HG_UTIL_FFI_CLOSURE
@@ -0,0 +1,206 @@
+/*****************************************************************/ /**
+ * @file   ffi_types.cpp
+ * @brief  Implementation of TypeInterner.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include <algorithm>
+#include "ffi_types.h"
+
+namespace clt::ffi
+{
+  namespace details
+  {
+    /// @brief FNV-1a hash of a list of types
+    /// @param first The first type (return type or nullptr)
+    /// @param types The other types
+    /// @return The hash
+    static u64 hash_types(
+        const ffi_type* first, Span<ffi_type* const> types) noexcept
+    {
+      u64 hash        = 14695981039346656037ULL;
+      const auto step = [&hash](const ffi_type* value)
+      { hash = (hash ^ reinterpret_cast<uintptr_t>(value)) * 1099511628211ULL; };
+      step(first);
+      for (size_t i = 0; i < types.size(); i++)
+        step(types.data()[i]);
+      return hash;
+    }
+
+    /// @brief Aligns 'offset' to 'align'
+    /// @param offset The offset
+    /// @param align The alignment (power of 2)
+    /// @return The aligned offset
+    static constexpr u32 align_to(u32 offset, u32 align) noexcept
+    {
+      return (offset + align - 1) & ~(align - 1);
+    }
+  } // namespace details
+
+  Expect<ffi_type*, TypeInterner::InternError> TypeInterner::primitive(
+      lng::PrimitiveType type, bool is_signed) const noexcept
+  {
+    using enum lng::PrimitiveType;
+
+    const auto info  = target.primitive_infos[static_cast<u8>(type)];
+    ffi_type* result = nullptr;
+    switch_no_default(type)
+    {
+    case iw08b:
+    case iw16b:
+    case iw32b:
+    case iw64b:
+      switch (info.size)
+      {
+      case 1:
+        result = is_signed ? &ffi_type_sint8 : &ffi_type_uint8;
+        break;
+      case 2:
+        result = is_signed ? &ffi_type_sint16 : &ffi_type_uint16;
+        break;
+      case 4:
+        result = is_signed ? &ffi_type_sint32 : &ffi_type_uint32;
+        break;
+      case 8:
+        result = is_signed ? &ffi_type_sint64 : &ffi_type_uint64;
+        break;
+      }
+      break;
+    case fw32b:
+    case fw64b:
+      if (info.size == sizeof(float))
+        result = &ffi_type_float;
+      else if (info.size == sizeof(double))
+        result = &ffi_type_double;
+      break;
+    case dtptr:
+    case fnptr:
+      if (info.size == sizeof(void*))
+        result = &ffi_type_pointer;
+      break;
+    }
+    // Layouts are computed from the alignments of libffi (which are the
+    // ones of the host ABI): a target that disagrees cannot be called
+    if (result == nullptr || result->alignment != info.align)
+      return {Error, InternError::UNSUPPORTED_TYPE};
+    return result;
+  }
+
+  Expect<ffi_type*, TypeInterner::InternError> TypeInterner::structure(
+      Span<ffi_type* const> members) noexcept
+  {
+    if (members.size() == 0)
+      return {Error, InternError::EMPTY_STRUCT};
+
+    const u64 hash = details::hash_types(nullptr, members);
+    std::scoped_lock guard{lock};
+    auto& bucket = structs[hash];
+    for (auto& entry : bucket)
+    {
+      if (entry->elements.size() == members.size() + 1
+          && std::equal(members.data(), members.data() + members.size(),
+                        entry->elements.begin()))
+        return &entry->type;
+    }
+
+    auto entry = std::make_unique<StructEntry>();
+    entry->elements.reserve(members.size() + 1);
+    entry->offsets.reserve(members.size());
+    // Members are either primitives (whose size is fixed) or interned
+    // structs (whose layout was already computed): this is the C layout.
+    u32 offset = 0;
+    u32 align  = 1;
+    for (size_t i = 0; i < members.size(); i++)
+    {
+      auto member = members.data()[i];
+      offset      = details::align_to(offset, member->alignment);
+      align       = std::max<u32>(align, member->alignment);
+      entry->offsets.push_back(offset);
+      entry->elements.push_back(member);
+      offset += static_cast<u32>(member->size);
+    }
+    entry->elements.push_back(nullptr);
+    entry->type = ffi_type{
+        details::align_to(offset, align), static_cast<unsigned short>(align),
+        FFI_TYPE_STRUCT, entry->elements.data()};
+
+    auto ptr = &bucket.emplace_back(std::move(entry))->type;
+    struct_entries.emplace(ptr, bucket.back().get());
+    return ptr;
+  }
+
+  const std::vector<u32>& TypeInterner::offsets_of(const ffi_type* type) noexcept
+  {
+    std::scoped_lock guard{lock};
+    auto it = struct_entries.find(type);
+    assert_true(
+        "Type was not interned by this TypeInterner!", it != struct_entries.end());
+    return it->second->offsets;
+  }
+
+  Expect<const Signature*, TypeInterner::InternError> TypeInterner::signature(
+      ffi_type* ret, Span<ffi_type* const> args) noexcept
+  {
+    const u64 hash = details::hash_types(ret, args);
+    {
+      std::scoped_lock guard{lock};
+      auto& bucket = signatures[hash];
+      for (auto& sig : bucket)
+      {
+        if (sig->cif->rtype == ret && sig->cif->nargs == args.size()
+            && std::equal(
+                args.data(), args.data() + args.size(), sig->cif->arg_types))
+          return sig.get();
+      }
+    }
+
+    // The signature is prepared outside of the lock (SignatureCache has its own)
+    auto cif = cifs.get(ret, args);
+    if (cif.is_error())
+      return {Error, InternError::PREP_ERR};
+
+    auto sig = std::make_unique<Signature>();
+    sig->cif = *cif;
+    sig->arg_offsets.reserve(args.size());
+    u32 offset = 0;
+    u32 align  = 1;
+    for (size_t i = 0; i < args.size(); i++)
+    {
+      auto arg = args.data()[i];
+      offset   = details::align_to(offset, arg->alignment);
+      align    = std::max<u32>(align, arg->alignment);
+      sig->arg_offsets.push_back(offset);
+      offset += static_cast<u32>(arg->size);
+    }
+    sig->buffer_size  = details::align_to(offset, align);
+    sig->buffer_align = align;
+
+    std::scoped_lock guard{lock};
+    auto& bucket = signatures[hash];
+    // Another thread may have interned the same signature meanwhile
+    for (auto& other : bucket)
+      if (other->cif == sig->cif)
+        return other.get();
+    return bucket.emplace_back(std::move(sig)).get();
+  }
+
+  void TypeInterner::invoke(
+      const Signature& sig, void* fn, const void* args, void* ret) noexcept
+  {
+    static constexpr size_t INLINE_ARGS = 16;
+
+    void* inline_values[INLINE_ARGS];
+    std::vector<void*> heap_values;
+    void** values = inline_values;
+    if (sig.arg_count() > INLINE_ARGS)
+    {
+      heap_values.resize(sig.arg_count());
+      values = heap_values.data();
+    }
+    auto base = static_cast<char*>(const_cast<void*>(args));
+    for (u32 i = 0; i < sig.arg_count(); i++)
+      values[i] = base + sig.arg_offsets[i];
+    DynamicCall{sig.cif, fn}.call_into(ret, values);
+  }
+} // namespace clt::ffi
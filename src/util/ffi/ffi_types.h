@@ -0,0 +1,148 @@
+/*****************************************************************/ /**
+ * @file   ffi_types.h
+ * @brief  Contains TypeInterner, which builds libffi types and
+ *         signatures described at runtime.
+ * FFICaller can only call functions whose signature is known when
+ * compiling the compiler. 'extern' functions declared in Colt source
+ * have signatures that are only known at runtime: TypeInterner builds
+ * the ffi_type of each distinct type (and the ffi_cif of each distinct
+ * signature) once, using the layout described by a TargetInfo.
+ * As the functions are called natively, only the host ABI is supported:
+ * layouts are computed from the alignments of libffi, and primitive
+ * types whose size or alignment in the TargetInfo differs from the host
+ * are rejected (UNSUPPORTED_TYPE).
+ * As types are interned, two structurally equal types have the same
+ * address, which makes comparing signatures cheap.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_UTIL_FFI_TYPES
+#define HG_UTIL_FFI_TYPES
+
+#include <frontend/target_info.h>
+#include "ffi_caller.h"
+
+namespace clt::ffi
+{
+  /// @brief A signature interned by a TypeInterner.
+  /// Arguments are passed through a single raw buffer, in which each
+  /// argument is stored at its offset (respecting its alignment).
+  struct Signature
+  {
+    /// @brief The prepared call interface
+    const ffi_cif* cif;
+    /// @brief The offset of each argument in the argument buffer
+    std::vector<u32> arg_offsets;
+    /// @brief The size of the argument buffer
+    u32 buffer_size;
+    /// @brief The alignment of the argument buffer
+    u32 buffer_align;
+
+    /// @brief Returns the number of arguments
+    /// @return The number of arguments
+    u32 arg_count() const noexcept { return static_cast<u32>(arg_offsets.size()); }
+    /// @brief Returns the return type
+    /// @return The return type
+    const ffi_type* return_type() const noexcept { return cif->rtype; }
+  };
+
+  /// @brief Builds and interns ffi_type and signatures.
+  /// All the returned pointers remain valid as long as the interner is
+  /// alive. This class is thread safe.
+  class TypeInterner
+  {
+    /// @brief An interned struct type
+    struct StructEntry
+    {
+      /// @brief The type (whose 'elements' points to 'elements')
+      ffi_type type;
+      /// @brief The members of the struct (followed by nullptr)
+      std::vector<ffi_type*> elements;
+      /// @brief The offset of each member
+      std::vector<u32> offsets;
+    };
+
+    /// @brief The target whose layout is used
+    lng::TargetInfo target;
+    /// @brief Protects all the members below
+    std::mutex lock;
+    /// @brief Maps the hash of the members of a struct to the structs with that hash
+    std::unordered_map<u64, std::vector<std::unique_ptr<StructEntry>>> structs;
+    /// @brief Maps an interned struct type to its entry
+    std::unordered_map<const ffi_type*, const StructEntry*> struct_entries;
+    /// @brief Maps the hash of a signature to the signatures with that hash
+    std::unordered_map<u64, std::vector<std::unique_ptr<Signature>>> signatures;
+    /// @brief The prepared call interfaces of the signatures
+    SignatureCache cifs;
+
+  public:
+    /// @brief Possible failure when interning a type or signature
+    enum class InternError : u8
+    {
+      /// @brief The primitive type is not supported by the host (its size
+      ///        or alignment differs from the host ABI)
+      UNSUPPORTED_TYPE,
+      /// @brief A struct without any member was requested
+      EMPTY_STRUCT,
+      /// @brief 'ffi_prep_cif' refused the signature
+      PREP_ERR,
+    };
+
+    /// @brief Constructor
+    /// @param target The target whose layout to use (must be the host,
+    ///               as the functions are called natively)
+    TypeInterner(const lng::TargetInfo& target) noexcept
+        : target(target)
+    {
+    }
+
+    TypeInterner(TypeInterner&&)      = delete;
+    TypeInterner(const TypeInterner&) = delete;
+
+    /// @brief Returns the ffi_type of a primitive type
+    /// @param type The primitive type
+    /// @param is_signed True for signed integers (ignored for other types)
+    /// @return The type, or UNSUPPORTED_TYPE if the size or alignment of
+    ///         the type in the TargetInfo differs from the host ABI
+    Expect<ffi_type*, InternError> primitive(
+        lng::PrimitiveType type, bool is_signed = false) const noexcept;
+
+    /// @brief Returns the ffi_type representing void
+    /// @return ffi_type_void
+    static ffi_type* void_type() noexcept { return &ffi_type_void; }
+
+    /// @brief Returns the interned struct type whose members are 'members'.
+    /// The layout (offsets, size, alignment) is computed once.
+    /// @param members The members of the struct (interned or primitive types)
+    /// @return The struct type or EMPTY_STRUCT
+    Expect<ffi_type*, InternError> structure(Span<ffi_type* const> members) noexcept;
+
+    /// @brief Returns the offsets of the members of an interned struct
+    /// @param type The struct (returned by 'structure')
+    /// @return The offset of each member
+    const std::vector<u32>& offsets_of(const ffi_type* type) noexcept;
+
+    /// @brief Returns the interned signature
+    /// @param ret The return type
+    /// @param args The arguments type
+    /// @return The signature or PREP_ERR
+    Expect<const Signature*, InternError> signature(
+        ffi_type* ret, Span<ffi_type* const> args) noexcept;
+
+    /// @brief Calls a function through an interned signature.
+    /// This does not allocate for functions of less than 16 arguments.
+    /// @param sig The signature of the function
+    /// @param fn The function to call
+    /// @param args The argument buffer (see Signature)
+    /// @param ret Storage for the return value (of the size of the
+    ///            return type), or nullptr for void
+    static void invoke(
+        const Signature& sig, void* fn, const void* args, void* ret) noexcept;
+  };
+} // namespace clt::ffi
+
+ADD_REFLECTION_FOR_CONSECUTIVE_ENUM(
+    clt::ffi::TypeInterner, InternError, UNSUPPORTED_TYPE, EMPTY_STRUCT, PREP_ERR);
+
+#endif // !HG_UTIL_FFI_TYPES
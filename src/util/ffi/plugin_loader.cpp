@@ -1,39 +1,40 @@
 #include "plugin_loader.h"
+#include "plugin_registry.h"
 
 namespace clt::ffi
 {
   void print_plugins() noexcept
   {
-    std::error_code err;
-    size_t count = 0;
-    size_t valid = 0;
+    PluginRegistry registry;
     print("\n======================= Plugins =======================");
-    for (auto& i : std::filesystem::directory_iterator{"plugins", err})
+    if (!registry.discover("plugins"))
+    {
+      print_warn("'plugins' directory not found!");
+      print("=======================================================\n");
+      return;
+    }
+    size_t count = registry.plugins().size();
+    size_t valid = 0;
+    for (auto& plugin : registry.plugins())
     {
-      if (std::filesystem::is_regular_file(i, err))
+      auto filename =
+          std::filesystem::path{plugin.info.path}.filename().generic_string();
+      if (!plugin.info.is_valid)
       {
-        auto plugin = ffi::ColtPlugin::open(i.path().generic_string().c_str());
-        count++;
-        if (plugin.is_error())
-        {
-          print(
-              "{}Could not greet '{}{}{}'!{}", io::BrightYellowF, io::BrightGreenF,
-              i.path().filename().generic_string(), io::BrightYellowF, io::Reset);
-          continue;
-        }
         print(
-            "Hello '{}{}{}'! ({}{}{}, setup code {}, {:h})", io::BrightCyanF,
-            plugin->name(), io::Reset, io::BrightGreenF,
-            i.path().filename().generic_string(), io::Reset, plugin->run_setup(),
-            plugin->advertised_purpose());
-        valid++;
+            "{}Could not greet '{}{}{}'!{}", io::BrightYellowF, io::BrightGreenF,
+            filename, io::BrightYellowF, io::Reset);
+        continue;
       }
+      print(
+          "Hello '{}{}{}'! ({}{}{}, {:h}{})", io::BrightCyanF, plugin.info.name,
+          io::Reset, io::BrightGreenF, filename, io::Reset, plugin.info.purpose,
+          plugin.from_cache ? ", cached" : "");
+      valid++;
     }
     if (count != 0)
       std::fputc('\n', stdout);
-    if (err.default_error_condition().value() == ENOENT)
-      print_warn("'plugins' directory not found!");
-    else if (count == 0)
+    if (count == 0)
       print_message("No plugins to greet!");
     else if (count != valid)
       print_warn(
@@ -43,4 +44,4 @@ namespace clt::ffi
     print("=======================================================\n");
   }
 
-} // namespace clt::ffi
\ No newline at end of file
+} // namespace clt::ffi
@@ -1,30 +1,16 @@
 #ifndef HG_COLTC_PLUGIN_LOADER
 #define HG_COLTC_PLUGIN_LOADER
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <colt/io/dynamic_lib.h>
 
 namespace clt::ffi
 {
   class ColtPlugin
   {
-    template<typename Ty>
-    friend class Option;
-
-    DynamicLib lib;
-    i32 errc            = 0;
-    u8 setup_ran : 1    = false;
-    u8 shutdown_ran : 1 = false;
-
-    ColtPlugin() = delete;
-    ColtPlugin(DynamicLib&& lib) noexcept
-        : lib(std::move(lib))
-    {
-    }
-
   public:
-    ColtPlugin(ColtPlugin&&) noexcept            = default;
-    ColtPlugin& operator=(ColtPlugin&&) noexcept = default;
-
     /// @brief Possible failure on plugin opening
     enum class OpenError
     {
@@ -59,13 +45,172 @@ namespace clt::ffi
     /// @brief Function that returns the plugin type
     using fn_type_t = PluginType (*)();
 
+    /// @brief The version of the plugin ABI described by TableV1
+    static constexpr u32 ABI_V1 = 1;
+
+    /// @brief The capabilities a plugin can advertise in its table
+    enum class Capability : u64
+    {
+      /// @brief The plugin only provides the lifecycle functions
+      NONE = 0,
+      /// @brief The plugin provides the reporting entry points
+      REPORT = 1 << 0,
+      /// @brief The plugin provides the highlighting entry points
+      HIGHLIGHT = 1 << 1,
+      /// @brief The plugin provides the backend entry points
+      BACKEND = 1 << 2,
+    };
+
+    /// @brief A diagnostic delivered to REPORTER plugins.
+    /// This struct is part of the plugin ABI: its layout must not change.
+    struct Diagnostic
+    {
+      /// @brief Value of 'byte_offset' if the offset is unknown
+      static constexpr u64 NO_OFFSET = static_cast<u64>(-1);
+      /// @brief Value of 'id' for diagnostics without a report number
+      static constexpr u32 NO_ID = static_cast<u32>(-1);
+
+      /// @brief The message (not NUL-terminated, valid during the call)
+      const Char8* message;
+      /// @brief The size of the message in bytes
+      u64 message_size;
+      /// @brief The path of the file (not NUL-terminated, valid during the call)
+      const Char8* file;
+      /// @brief The size of the path in bytes
+      u64 file_size;
+      /// @brief The byte offset of the expression in the file or NO_OFFSET
+      u64 byte_offset;
+      /// @brief The size in bytes of the expression (0 if none)
+      u64 byte_size;
+      /// @brief The report number or NO_ID
+      u32 id;
+      /// @brief The 1-based beginning line (0 if no source information)
+      u32 line_begin;
+      /// @brief The 1-based end line (0 if no source information)
+      u32 line_end;
+      /// @brief The 1-based beginning column (0 if no source information)
+      u32 column_begin;
+      /// @brief The 1-based end column, exclusive (0 if no source information)
+      u32 column_end;
+      /// @brief 0 for messages, 1 for warnings, 2 for errors
+      u8 kind;
+    };
+
+    /// @brief Function called with a batch of diagnostics
+    using fn_report_t = void (*)(const Diagnostic* diagnostics, u32 count);
+    /// @brief Function called with a flat module (see 'flat_module.h').
+    /// The module is read-only, and only valid during the call.
+    /// Returns 0 on success.
+    using fn_backend_t = i32 (*)(const u8* module, u64 size);
+
+    /// @brief The function table returned by 'colt_plugin_v1'.
+    /// This struct is part of the plugin ABI: its layout must not change.
+    /// New entry points are appended at the end, and 'struct_size' tells
+    /// which of them the plugin knows about (the others are null).
+    struct TableV1
+    {
+      /// @brief Must be ABI_V1
+      u32 abi_version = ABI_V1;
+      /// @brief The size of the table as compiled in the plugin
+      u32 struct_size = sizeof(TableV1);
+      /// @brief Bit mask of Capability
+      u64 capabilities = 0;
+      /// @brief Returns the name of the plugin
+      fn_name_t name = nullptr;
+      /// @brief Returns the description of the plugin (can be null)
+      fn_name_t desc = nullptr;
+      /// @brief Returns the purpose of the plugin
+      fn_type_t purpose = nullptr;
+      /// @brief Initializes the plugin (can be null)
+      fn_setup_t setup = nullptr;
+      /// @brief Frees the resources of the plugin (can be null)
+      fn_shutdown_t shutdown = nullptr;
+      /// @brief Receives batches of diagnostics (Capability::REPORT)
+      fn_report_t report = nullptr;
+      /// @brief Receives the compiled modules (Capability::BACKEND)
+      fn_backend_t backend = nullptr;
+
+      /// @brief Check if the plugin advertises a capability
+      /// @param cap The capability
+      /// @return True if the plugin advertises 'cap'
+      bool has(Capability cap) const noexcept
+      {
+        return (capabilities & static_cast<u64>(cap)) != 0;
+      }
+    };
+
+    /// @brief Function exported by plugins as 'colt_plugin_v1'
+    using fn_plugin_v1_t = const TableV1* (*)();
+
+    template<typename Lib>
+    /// @brief Resolves the entry points of a library.
+    /// If the library exports 'colt_plugin_v1', this is the only symbol
+    /// looked up. Otherwise, the loose 'colt_*' symbols of older plugins
+    /// are looked up.
+    /// @tparam Lib DynamicLib (or any type with the same 'find' method)
+    /// @param lib The library
+    /// @return The entry points or None if the library is not a plugin
+    static Option<TableV1> resolve(const Lib& lib) noexcept
+    {
+      TableV1 table;
+      if (auto v1 = lib.template find<fn_plugin_v1_t>("colt_plugin_v1");
+          v1.is_value())
+      {
+        auto* from = (*v1)();
+        if (from == nullptr || from->abi_version != ABI_V1
+            || from->struct_size < offsetof(TableV1, shutdown) + sizeof(void*))
+          return None;
+        // Only copy the entry points known by the plugin
+        std::memcpy(
+            &table, from, std::min<size_t>(from->struct_size, sizeof(TableV1)));
+        table.struct_size = sizeof(TableV1);
+      }
+      else
+      {
+        table.name = lib.template find<fn_name_t>("colt_name").value_or(nullptr);
+        table.desc = lib.template find<fn_name_t>("colt_desc").value_or(nullptr);
+        table.purpose =
+            lib.template find<fn_type_t>("colt_purpose").value_or(nullptr);
+        table.setup =
+            lib.template find<fn_setup_t>("colt_setup").value_or(nullptr);
+        table.shutdown =
+            lib.template find<fn_shutdown_t>("colt_shutdown").value_or(nullptr);
+      }
+      if (table.name == nullptr && table.purpose == nullptr)
+        return None;
+      return table;
+    }
+
+  private:
+    template<typename Ty>
+    friend class Option;
+
+    DynamicLib lib;
+    TableV1 table;
+    i32 errc            = 0;
+    u8 setup_ran : 1    = false;
+    u8 shutdown_ran : 1 = false;
+
+    ColtPlugin() = delete;
+    ColtPlugin(DynamicLib&& lib, const TableV1& table) noexcept
+        : lib(std::move(lib))
+        , table(table)
+    {
+    }
+
+  public:
+    ColtPlugin(ColtPlugin&&) noexcept            = default;
+    ColtPlugin& operator=(ColtPlugin&&) noexcept = default;
+
+    /// @brief Returns the entry points of the plugin
+    /// @return The entry points
+    const TableV1& entry_points() const noexcept { return table; }
+
     /// @brief Returns the name of the plugin
     /// @return The name of the plugin
     u8ZStringView name() const
     {
-      return lib.find<fn_name_t>("colt_name")
-          .and_then([](fn_name_t a) { return Option<u8ZStringView>(a()); })
-          .value_or(u8ZStringView{});
+      return table.name == nullptr ? u8ZStringView{} : u8ZStringView{table.name()};
     }
 
     /// @brief The advertised purpose of the plugin.
@@ -74,24 +219,19 @@ namespace clt::ffi
     /// @return PluginType
     PluginType advertised_purpose() const
     {
-      return lib.find<fn_type_t>("colt_purpose")
-          .and_then(
-              [](fn_type_t a)
-              {
-                auto val = a();
-                if (val > PluginType::EMPTY)
-                  return Option<PluginType>(None);
-                return Option<PluginType>(val);
-              })
-          .value_or(PluginType::EMPTY);
+      if (table.purpose == nullptr)
+        return PluginType::EMPTY;
+      auto val = table.purpose();
+      return val > PluginType::EMPTY ? PluginType::EMPTY : val;
     }
 
     /// @brief Returns the description of the plugin if it exist
     /// @return The description of the plugin or None
     Option<u8ZStringView> desc() const
     {
-      return lib.find<fn_name_t>("colt_desc")
-          .and_then([](fn_name_t a) { return u8ZStringView(a()); });
+      if (table.desc == nullptr)
+        return None;
+      return u8ZStringView(table.desc());
     }
 
     /// @brief Calls 'colt_setup' if it exist.
@@ -101,9 +241,7 @@ namespace clt::ffi
     {
       if (setup_ran)
         return errc;
-      errc = lib.find<fn_setup_t>("colt_setup")
-                 .map([](fn_setup_t a) { return a(); })
-                 .value_or(0);
+      errc      = table.setup == nullptr ? 0 : table.setup();
       setup_ran = true;
       return errc;
     }
@@ -116,9 +254,8 @@ namespace clt::ffi
       if (lib.is_closed() || shutdown_ran || setup_ran == false)
         return;
       shutdown_ran = true;
-      auto find    = lib.find<fn_shutdown_t>("colt_shutdown");
-      if (find.is_value())
-        (**find)();
+      if (table.shutdown != nullptr)
+        table.shutdown();
     }
 
     /// @brief Calls run_shutdown on the plugin
@@ -137,10 +274,10 @@ namespace clt::ffi
       auto lib = DynamicLib::open(path);
       if (lib == None)
         return {Error, OpenError::OS_ERR};
-      if (lib->find_symbol("colt_name") == nullptr
-          && lib->find_symbol("colt_purpose") == nullptr)
-        return {Error, OpenError::OS_ERR};
-      auto plugin = ColtPlugin(std::move(*lib));
+      auto table = resolve(*lib);
+      if (table.is_none())
+        return {Error, OpenError::MISSING_FN};
+      auto plugin = ColtPlugin(std::move(*lib), *table);
       if (manual_setup)
         return {std::move(plugin)};
       if (auto a = plugin.run_setup(); a == 0)
@@ -0,0 +1,417 @@
+/*****************************************************************/ /**
+ * @file   plugin_registry.cpp
+ * @brief  Implementation of PluginRegistry.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <filesystem>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include "plugin_registry.h"
+
+namespace clt::ffi
+{
+  namespace details
+  {
+    /// @brief Splits 'line' on the next tab
+    /// @param line The line (modified to start after the tab)
+    /// @return The field before the tab
+    static std::string_view next_field(std::string_view& line) noexcept
+    {
+      auto pos   = line.find('\t');
+      auto field = line.substr(0, pos);
+      line.remove_prefix(pos == std::string_view::npos ? line.size() : pos + 1);
+      return field;
+    }
+
+    template<typename T>
+    /// @brief Parses an integer field
+    /// @param line The line (modified to start after the field)
+    /// @param value Where to write the integer
+    /// @return True on success
+    static bool parse_field(std::string_view& line, T& value) noexcept
+    {
+      auto field = next_field(line);
+      auto [ptr, ec] =
+          std::from_chars(field.data(), field.data() + field.size(), value);
+      return ec == std::errc{} && ptr == field.data() + field.size();
+    }
+
+    /// @brief Appends a string to the manifest, escaping the characters
+    ///        used as separators (and backslashes)
+    /// @param out The manifest
+    /// @param str The string to escape
+    static void append_escaped(std::string& out, std::string_view str)
+    {
+      for (char chr : str)
+      {
+        switch (chr)
+        {
+        case '\\':
+          out += "\\\\";
+          break;
+        case '\t':
+          out += "\\t";
+          break;
+        case '\n':
+          out += "\\n";
+          break;
+        case '\r':
+          out += "\\r";
+          break;
+        default:
+          out += chr;
+        }
+      }
+    }
+
+    /// @brief Reverts 'append_escaped'
+    /// @param str The escaped string
+    /// @param out Where to write the string
+    /// @return False if 'str' contains an invalid escape sequence
+    static bool unescape(std::string_view str, std::string& out)
+    {
+      out.clear();
+      out.reserve(str.size());
+      for (size_t i = 0; i < str.size(); i++)
+      {
+        if (str[i] != '\\')
+        {
+          out += str[i];
+          continue;
+        }
+        if (++i == str.size())
+          return false;
+        switch (str[i])
+        {
+        case '\\':
+          out += '\\';
+          break;
+        case 't':
+          out += '\t';
+          break;
+        case 'n':
+          out += '\n';
+          break;
+        case 'r':
+          out += '\r';
+          break;
+        default:
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /// @brief Converts a string returned by a plugin
+    /// @param str The string (or nullptr)
+    /// @return The string or an empty string
+    static std::string from_plugin(const Char8* str) noexcept
+    {
+      return str == nullptr ? std::string{}
+                            : std::string{reinterpret_cast<const char*>(str)};
+    }
+  } // namespace details
+
+  bool PluginRegistry::load(RegisteredPlugin& plugin) noexcept
+  {
+    COLT_TRACE_FN_C(clt::Color::DarkOrange);
+    using enum ColtPlugin::PluginType;
+
+    auto lib = DynamicLib::open(plugin.info.path.c_str());
+    if (lib == None)
+      return false;
+
+    auto resolved = ColtPlugin::resolve(*lib);
+    if (resolved.is_none())
+      return false;
+    const auto& entry = *resolved;
+
+    plugin.info.name =
+        details::from_plugin(entry.name == nullptr ? nullptr : entry.name());
+    plugin.info.desc =
+        details::from_plugin(entry.desc == nullptr ? nullptr : entry.desc());
+    plugin.info.purpose = EMPTY;
+    if (entry.purpose != nullptr)
+    {
+      auto purpose = entry.purpose();
+      if (purpose <= EMPTY)
+        plugin.info.purpose = purpose;
+    }
+    plugin.entry = entry;
+    plugin.lib   = std::move(*lib);
+    return true;
+  }
+
+  bool PluginRegistry::discover(std::string_view directory, u32 threads) noexcept
+  {
+    COLT_TRACE_FN_C(clt::Color::DarkOrange);
+    namespace fs = std::filesystem;
+
+    discovered_ = true;
+    std::error_code err;
+    if (!fs::is_directory(directory, err))
+      return false;
+
+    const auto manifest_path =
+        (fs::path{directory} / MANIFEST_NAME).generic_string();
+    std::unordered_map<std::string, PluginManifestEntry> cached;
+    for (auto& entry : read_manifest(manifest_path.c_str()))
+      cached.emplace(entry.path, std::move(entry));
+
+    shutdown();
+    plugins_.clear();
+    for (auto& file : fs::directory_iterator{directory, err})
+    {
+      // Skips the manifest and the temporary files of 'write_manifest'
+      if (!file.is_regular_file(err)
+          || file.path().filename().generic_string().starts_with(MANIFEST_NAME))
+        continue;
+      PluginManifestEntry info;
+      info.path  = file.path().generic_string();
+      info.size  = static_cast<u64>(file.file_size(err));
+      info.mtime = static_cast<i64>(
+          file.last_write_time(err).time_since_epoch().count());
+      plugins_.push_back(RegisteredPlugin{std::move(info)});
+    }
+    // Sort to have the same order whatever the file system
+    std::sort(
+        plugins_.begin(), plugins_.end(),
+        [](const RegisteredPlugin& a, const RegisteredPlugin& b)
+        { return a.info.path < b.info.path; });
+
+    std::vector<size_t> to_load;
+    for (size_t i = 0; i < plugins_.size(); i++)
+    {
+      auto& plugin = plugins_[i];
+      auto it      = cached.find(plugin.info.path);
+      if (it != cached.end() && it->second.size == plugin.info.size
+          && it->second.mtime == plugin.info.mtime)
+      {
+        plugin.info       = std::move(it->second);
+        plugin.from_cache = true;
+      }
+      else
+        to_load.push_back(i);
+    }
+
+    if (!to_load.empty())
+    {
+      // The libraries are distributed dynamically, as load times vary a lot
+      std::atomic<size_t> next = 0;
+      auto worker              = [&]()
+      {
+        for (size_t i = next++; i < to_load.size(); i = next++)
+        {
+          auto& plugin         = plugins_[to_load[i]];
+          plugin.info.is_valid = load(plugin);
+          // Only the information was needed: the library is opened again
+          // if its purpose is required
+          plugin.lib   = None;
+          plugin.entry = {};
+        }
+      };
+      if (threads == 0)
+        threads = std::max(1U, std::thread::hardware_concurrency());
+      threads = std::min(threads, static_cast<u32>(to_load.size()));
+
+      std::vector<std::thread> pool;
+      for (u32 i = 1; i < threads; i++)
+        pool.emplace_back(worker);
+      worker();
+      for (auto& thread : pool)
+        thread.join();
+    }
+
+    // Only rewrite the manifest if it is out of date
+    if (!to_load.empty() || cached.size() != plugins_.size() - to_load.size())
+    {
+      std::vector<PluginManifestEntry> entries;
+      entries.reserve(plugins_.size());
+      for (auto& plugin : plugins_)
+        entries.push_back(plugin.info);
+      write_manifest(manifest_path.c_str(), entries);
+    }
+    return true;
+  }
+
+  bool PluginRegistry::open(size_t index) noexcept
+  {
+    assert_true("Invalid plugin index!", index < plugins_.size());
+    auto& plugin = plugins_[index];
+    if (plugin.lib.is_value())
+      return true;
+    if (!plugin.info.is_valid)
+      return false;
+    return plugin.info.is_valid = load(plugin);
+  }
+
+  Option<i32> PluginRegistry::setup(size_t index) noexcept
+  {
+    if (!open(index))
+      return None;
+    auto& plugin = plugins_[index];
+    if (!plugin.setup_ran)
+    {
+      plugin.setup_code = plugin.entry.setup == nullptr ? 0 : plugin.entry.setup();
+      plugin.setup_ran  = true;
+      setup_order_.push_back(index);
+    }
+    return plugin.setup_code;
+  }
+
+  void PluginRegistry::declare(ColtPlugin::PluginType purpose) noexcept
+  {
+    assert_true(
+        "EMPTY plugins cannot be required!",
+        purpose < ColtPlugin::PluginType::EMPTY);
+    declared_ |= static_cast<u8>(1U << static_cast<u8>(purpose));
+  }
+
+  const std::vector<size_t>& PluginRegistry::require(
+      ColtPlugin::PluginType purpose) noexcept
+  {
+    static const std::vector<size_t> NONE = {};
+    if (!is_declared(purpose))
+      return NONE;
+
+    const auto index = static_cast<u8>(purpose);
+    auto& ready      = ready_[index];
+    if ((resolved_ & (1U << index)) != 0)
+      return ready;
+
+    COLT_TRACE_FN_C(clt::Color::DarkOrange);
+    if (!discovered_)
+      discover(directory_);
+    resolved_ |= static_cast<u8>(1U << index);
+    for (size_t i = 0; i < plugins_.size(); i++)
+    {
+      auto& info = plugins_[i].info;
+      // The manifest tells which libraries to open
+      if (!info.is_valid || info.purpose != purpose)
+        continue;
+      auto code = setup(i);
+      if (code.is_none())
+        print_warn("Could not open plugin '{}'!", info.path);
+      else if (*code != 0)
+        print_warn("Setup of plugin '{}' failed (code {})!", info.path, *code);
+      else
+        ready.push_back(i);
+    }
+    return ready;
+  }
+
+  void PluginRegistry::shutdown() noexcept
+  {
+    for (auto it = setup_order_.rbegin(); it != setup_order_.rend(); ++it)
+    {
+      auto& plugin = plugins_[*it];
+      if (plugin.entry.shutdown != nullptr)
+        plugin.entry.shutdown();
+    }
+    // Plugins are closed in reverse order too, as a plugin may depend on
+    // symbols of a plugin that was set up before it
+    for (auto it = setup_order_.rbegin(); it != setup_order_.rend(); ++it)
+    {
+      auto& plugin     = plugins_[*it];
+      plugin.lib       = None;
+      plugin.entry     = {};
+      plugin.setup_ran = false;
+    }
+    setup_order_.clear();
+    ready_    = {};
+    resolved_ = 0;
+  }
+
+  std::vector<PluginManifestEntry> PluginRegistry::read_manifest(
+      const char* path) noexcept
+  {
+    std::vector<PluginManifestEntry> entries;
+    auto file = std::fopen(path, "rb");
+    if (file == nullptr)
+      return entries;
+    std::string content;
+    char buffer[4096];
+    while (size_t size = std::fread(buffer, 1, sizeof(buffer), file))
+      content.append(buffer, size);
+    std::fclose(file);
+
+    auto text      = std::string_view{content};
+    auto next_line = [&text]()
+    {
+      auto pos  = text.find('\n');
+      auto line = text.substr(0, pos);
+      text.remove_prefix(pos == std::string_view::npos ? text.size() : pos + 1);
+      return line;
+    };
+    if (next_line() != MANIFEST_HEADER)
+      return entries;
+
+    while (!text.empty())
+    {
+      auto line = next_line();
+      PluginManifestEntry entry;
+      u32 is_valid = 0;
+      u32 purpose  = 0;
+      entry.path   = std::string{details::next_field(line)};
+      if (!details::parse_field(line, entry.mtime)
+          || !details::parse_field(line, entry.size)
+          || !details::parse_field(line, is_valid)
+          || !details::parse_field(line, purpose)
+          || purpose > static_cast<u32>(ColtPlugin::PluginType::EMPTY))
+        return {}; // Corrupted manifest: rediscover everything
+      entry.is_valid = is_valid != 0;
+      entry.purpose  = static_cast<ColtPlugin::PluginType>(purpose);
+      if (!details::unescape(details::next_field(line), entry.name)
+          || !details::unescape(line, entry.desc))
+        return {};
+      entries.push_back(std::move(entry));
+    }
+    return entries;
+  }
+
+  bool PluginRegistry::write_manifest(
+      const char* path, const std::vector<PluginManifestEntry>& entries) noexcept
+  {
+    std::string content{MANIFEST_HEADER};
+    content.push_back('\n');
+    for (auto& entry : entries)
+    {
+      // Such paths cannot be represented: they will always be opened
+      if (entry.path.find_first_of("\t\n") != std::string::npos)
+        continue;
+      fmt::format_to(
+          std::back_inserter(content), "{}\t{}\t{}\t{}\t{}\t", entry.path,
+          entry.mtime, entry.size, static_cast<u32>(entry.is_valid),
+          static_cast<u32>(entry.purpose));
+      details::append_escaped(content, entry.name);
+      content.push_back('\t');
+      details::append_escaped(content, entry.desc);
+      content.push_back('\n');
+    }
+    // Other processes may discover the same directory concurrently: the
+    // manifest is replaced atomically by renaming a unique temporary file
+    std::random_device device;
+    auto temporary = fmt::format("{}.{:08x}{:08x}.tmp", path, device(), device());
+    auto file      = std::fopen(temporary.c_str(), "wb");
+    if (file == nullptr)
+      return false;
+    bool success =
+        std::fwrite(content.data(), 1, content.size(), file) == content.size();
+    success = (std::fclose(file) == 0) && success;
+    std::error_code error;
+    if (success)
+      std::filesystem::rename(temporary, path, error);
+    if (!success || error)
+    {
+      std::filesystem::remove(temporary, error);
+      return false;
+    }
+    return true;
+  }
+} // namespace clt::ffi
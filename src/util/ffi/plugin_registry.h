@@ -0,0 +1,195 @@
+/*****************************************************************/ /**
+ * @file   plugin_registry.h
+ * @brief  Contains PluginRegistry, which discovers the plugins of a
+ *         directory.
+ * Discovering plugins used to require opening every library of the
+ * 'plugins' directory. The registry saves the information of each
+ * plugin (name, description, purpose) in a manifest, keyed by the path,
+ * size and modification time of the library: the next discoveries only
+ * open the libraries that changed. Libraries that must be opened are
+ * opened in parallel, and their entry points are resolved once.
+ * The driver declares the purposes (see PluginType) an invocation
+ * needs: plugins are only opened and set up when their purpose is
+ * first required, and are shut down in reverse order on destruction.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_COLTC_PLUGIN_REGISTRY
+#define HG_COLTC_PLUGIN_REGISTRY
+
+#include <array>
+#include <string>
+#include <vector>
+#include <util/mem_report.h>
+#include "plugin_loader.h"
+
+namespace clt::ffi
+{
+  /// @brief The entry points of a plugin, resolved once on opening.
+  /// Any of the pointers may be null if the plugin does not export it.
+  using PluginEntryPoints = ColtPlugin::TableV1;
+
+  /// @brief The information saved in the manifest for each library
+  struct PluginManifestEntry
+  {
+    /// @brief The path of the library
+    std::string path;
+    /// @brief The modification time of the library
+    i64 mtime = 0;
+    /// @brief The size of the library
+    u64 size = 0;
+    /// @brief The name of the plugin
+    std::string name = {};
+    /// @brief The description of the plugin
+    std::string desc = {};
+    /// @brief The advertised purpose of the plugin
+    ColtPlugin::PluginType purpose = ColtPlugin::PluginType::EMPTY;
+    /// @brief False if the library is not a valid plugin
+    bool is_valid = false;
+  };
+
+  /// @brief A plugin known to the registry
+  struct RegisteredPlugin
+  {
+    /// @brief The information about the plugin
+    PluginManifestEntry info;
+    /// @brief The library (None if it was not opened)
+    Option<DynamicLib> lib = None;
+    /// @brief The entry points (only valid if 'lib' is not None)
+    PluginEntryPoints entry = {};
+    /// @brief The result of 'colt_setup'
+    i32 setup_code = 0;
+    /// @brief True if 'colt_setup' was called
+    bool setup_ran = false;
+    /// @brief True if the information comes from the manifest
+    bool from_cache = false;
+  };
+
+  /// @brief Discovers and owns the plugins of a directory.
+  /// The manifest is stored in the directory (see MANIFEST_NAME).
+  class PluginRegistry
+  {
+    /// @brief The number of purposes that can be required (EMPTY excluded)
+    static constexpr size_t PURPOSE_COUNT =
+        static_cast<size_t>(ColtPlugin::PluginType::EMPTY);
+
+    /// @brief The discovered plugins
+    TrackedVector<RegisteredPlugin, MemTag::PLUGINS> plugins_;
+    /// @brief The indices of the plugins whose 'colt_setup' ran, in order
+    std::vector<size_t> setup_order_;
+    /// @brief The ready plugins of each purpose (valid if 'resolved_' is set)
+    std::array<std::vector<size_t>, PURPOSE_COUNT> ready_;
+    /// @brief The directory from which to discover the plugins
+    std::string directory_ = "plugins";
+    /// @brief Bit mask of the declared purposes
+    u8 declared_ = 0;
+    /// @brief Bit mask of the purposes whose plugins were set up
+    u8 resolved_ = 0;
+    /// @brief True if 'discover' was called
+    bool discovered_ = false;
+
+    /// @brief Opens a library and resolves its entry points
+    /// @param plugin The plugin whose 'info.path' is set
+    /// @return True if the library is a valid plugin
+    static bool load(RegisteredPlugin& plugin) noexcept;
+
+  public:
+    /// @brief The name of the manifest file in the plugin directory
+    static constexpr std::string_view MANIFEST_NAME = "colt_plugins.manifest";
+    /// @brief The first line of the manifest (contains its version)
+    static constexpr std::string_view MANIFEST_HEADER = "COLTPLUGINS:2";
+
+    PluginRegistry() noexcept                        = default;
+    PluginRegistry(PluginRegistry&&) noexcept        = default;
+    PluginRegistry(const PluginRegistry&)            = delete;
+    PluginRegistry& operator=(const PluginRegistry&) = delete;
+
+    /// @brief Constructor
+    /// @param directory The directory from which to lazily discover plugins
+    PluginRegistry(std::string_view directory) noexcept
+        : directory_(directory)
+    {
+    }
+
+    /// @brief Shuts down the plugins (see shutdown)
+    ~PluginRegistry() noexcept { shutdown(); }
+
+    /// @brief Declares that the invocation may need plugins of a purpose.
+    /// Nothing is opened until the purpose is required.
+    /// @param purpose The purpose (not EMPTY)
+    void declare(ColtPlugin::PluginType purpose) noexcept;
+
+    /// @brief Check if a purpose was declared
+    /// @param purpose The purpose
+    /// @return True if 'declare(purpose)' was called
+    bool is_declared(ColtPlugin::PluginType purpose) const noexcept
+    {
+      return purpose < ColtPlugin::PluginType::EMPTY
+             && (declared_ & (1U << static_cast<u8>(purpose))) != 0;
+    }
+
+    /// @brief Returns the plugins of a declared purpose, ready to be used.
+    /// On the first call for a purpose, the plugins are discovered (if
+    /// needed), then the plugins advertising that purpose in the manifest
+    /// are opened and set up. Plugins whose setup fails are not returned.
+    /// @param purpose The purpose
+    /// @return The indices of the plugins (empty if 'purpose' was not declared)
+    const std::vector<size_t>& require(ColtPlugin::PluginType purpose) noexcept;
+
+    /// @brief Calls 'colt_shutdown' on the plugins that were set up, in
+    ///        the reverse order of their setup, then closes them.
+    /// This function is idempotent.
+    void shutdown() noexcept;
+
+    /// @brief Discovers the plugins of a directory.
+    /// Libraries whose path, size and modification time match the
+    /// manifest are not opened. The others are opened in parallel to
+    /// read their entry points, closed (they are opened again when their
+    /// purpose is required), then the manifest is updated.
+    /// @param directory The directory containing the plugins
+    /// @param threads The number of threads to use (0 for the hardware concurrency)
+    /// @return False if the directory does not exist
+    bool discover(
+        std::string_view directory = "plugins", u32 threads = 0) noexcept;
+
+    /// @brief Returns the discovered plugins
+    /// @return The discovered plugins
+    const TrackedVector<RegisteredPlugin, MemTag::PLUGINS>& plugins() const noexcept
+    {
+      return plugins_;
+    }
+
+    /// @brief Check if the plugins were discovered
+    /// @return True if 'discover' was called
+    bool is_discovered() const noexcept { return discovered_; }
+
+    /// @brief Opens a plugin (if not already opened)
+    /// @param index The index of the plugin
+    /// @return False if the plugin could not be opened
+    bool open(size_t index) noexcept;
+
+    /// @brief Opens a plugin (if needed) and calls 'colt_setup' once
+    /// @param index The index of the plugin
+    /// @return The result of 'colt_setup' (0 if it does not exist), or None
+    ///         if the plugin could not be opened
+    Option<i32> setup(size_t index) noexcept;
+
+    /// @brief Reads a manifest
+    /// @param path The path of the manifest
+    /// @return The entries of the manifest (empty if invalid)
+    static std::vector<PluginManifestEntry> read_manifest(const char* path) noexcept;
+
+    /// @brief Writes a manifest.
+    /// The manifest is written to a temporary file which is then renamed,
+    /// so that concurrent readers never see a partial manifest.
+    /// Names and descriptions are escaped (tabs, new lines, backslashes).
+    /// @param path The path of the manifest
+    /// @param entries The entries to write
+    /// @return True on success
+    static bool write_manifest(
+        const char* path, const std::vector<PluginManifestEntry>& entries) noexcept;
+  };
+} // namespace clt::ffi
+
+#endif // !HG_COLTC_PLUGIN_REGISTRY
@@ -0,0 +1,108 @@
+/*****************************************************************/ /**
+ * @file   plugin_reporter.cpp
+ * @brief  Implementation of DiagnosticBatch.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include "plugin_reporter.h"
+
+namespace clt::ffi
+{
+  DiagnosticBatch::DiagnosticBatch(
+      std::vector<ColtPlugin::fn_report_t> targets, u32 capacity,
+      u32 text_capacity) noexcept
+      : targets(std::move(targets))
+      , diagnostics(std::make_unique<ColtPlugin::Diagnostic[]>(capacity))
+      , text(std::make_unique<Char8[]>(text_capacity))
+      , capacity(capacity)
+      , text_capacity(text_capacity)
+      , memory(
+            MemTag::REPORTERS,
+            capacity * sizeof(ColtPlugin::Diagnostic) + text_capacity)
+  {
+    assert_true("Invalid capacity!", capacity != 0);
+  }
+
+  const Char8* DiagnosticBatch::copy(std::string_view str) noexcept
+  {
+    auto ptr = text.get() + text_used;
+    if (!str.empty())
+      std::memcpy(ptr, str.data(), str.size());
+    text_used += static_cast<u32>(str.size());
+    return ptr;
+  }
+
+  void DiagnosticBatch::set_file(const lng::SourceFile& src) noexcept
+  {
+    file      = src;
+    file_path = nullptr;
+  }
+
+  void DiagnosticBatch::push(
+      lng::ReportKind kind, u8StringView str,
+      const Option<lng::SourceInfo>& src_info,
+      const Option<lng::ReportNumber>& nb) noexcept
+  {
+    if (targets.empty())
+      return;
+    const auto message = lng::details::to_strv(str);
+    // The path is only copied once per batch
+    size_t needed = message.size() + (file_path == nullptr ? file.path.size() : 0);
+    if (count == capacity || text_used + needed > text_capacity)
+      flush();
+
+    auto& diag        = diagnostics[count++];
+    diag.kind         = static_cast<u8>(kind);
+    diag.id           = nb.is_value() ? *nb : ColtPlugin::Diagnostic::NO_ID;
+    diag.byte_offset  = ColtPlugin::Diagnostic::NO_OFFSET;
+    diag.byte_size    = 0;
+    diag.line_begin   = 0;
+    diag.line_end     = 0;
+    diag.column_begin = 0;
+    diag.column_end   = 0;
+    if (src_info.is_value())
+    {
+      auto loc          = lng::details::compute_location(*src_info, file);
+      diag.byte_offset =
+          loc.byte_offset.value_or(ColtPlugin::Diagnostic::NO_OFFSET);
+      diag.byte_size    = src_info->expr.unit_len();
+      diag.line_begin   = loc.line_begin;
+      diag.line_end     = loc.line_end;
+      diag.column_begin = loc.column_begin;
+      diag.column_end   = loc.column_end;
+    }
+
+    needed = message.size() + (file_path == nullptr ? file.path.size() : 0);
+    if (text_used + needed > text_capacity)
+    {
+      // Too big for the arena: the views point to the caller's strings,
+      // which are only valid until this function returns
+      diag.message      = str.data();
+      diag.message_size = message.size();
+      diag.file         = reinterpret_cast<const Char8*>(file.path.data());
+      diag.file_size    = file.path.size();
+      flush();
+      return;
+    }
+    if (file_path == nullptr)
+      file_path = copy(file.path);
+    diag.file         = file_path;
+    diag.file_size    = file.path.size();
+    diag.message      = copy(message);
+    diag.message_size = message.size();
+  }
+
+  void DiagnosticBatch::flush() noexcept
+  {
+    if (count == 0)
+      return;
+    COLT_TRACE_FN_C(clt::Color::DarkOrange);
+    for (auto target : targets)
+      target(diagnostics.get(), count);
+    count     = 0;
+    text_used = 0;
+    file_path = nullptr;
+    delivered++;
+  }
+} // namespace clt::ffi
@@ -0,0 +1,185 @@
+/*****************************************************************/ /**
+ * @file   plugin_reporter.h
+ * @brief  Contains PluginReporter, which delivers the reports to
+ *         REPORTER plugins in batches.
+ * Calling a plugin for each report would cost a call through the
+ * library boundary and a copy of the message per report. Instead,
+ * reports are converted to ColtPlugin::Diagnostic and accumulated in
+ * a fixed capacity batch (their text is copied in a fixed size arena).
+ * The plugins are only called when the batch is full, on 'flush'
+ * (at the end of a phase), and on destruction.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_COLTC_PLUGIN_REPORTER
+#define HG_COLTC_PLUGIN_REPORTER
+
+#include <memory>
+#include <vector>
+#include <frontend/err/composable_reporter.h>
+#include <frontend/err/machine_reporter.h>
+#include <util/mem_report.h>
+#include "plugin_loader.h"
+
+namespace clt::ffi
+{
+  /// @brief Batch of diagnostics waiting to be delivered to plugins
+  class DiagnosticBatch
+  {
+    /// @brief The functions to which to deliver the diagnostics
+    std::vector<ColtPlugin::fn_report_t> targets;
+    /// @brief The diagnostics
+    std::unique_ptr<ColtPlugin::Diagnostic[]> diagnostics;
+    /// @brief The text of the diagnostics (messages and paths)
+    std::unique_ptr<Char8[]> text;
+    /// @brief The capacity of 'diagnostics'
+    u32 capacity;
+    /// @brief The capacity of 'text'
+    u32 text_capacity;
+    /// @brief Charges 'diagnostics' and 'text' to MemTag::REPORTERS
+    MemCharge memory;
+    /// @brief The number of diagnostics in the batch
+    u32 count = 0;
+    /// @brief The number of bytes used in 'text'
+    u32 text_used = 0;
+    /// @brief The current file
+    lng::SourceFile file = {};
+    /// @brief The copy of the path of the current file in 'text' (or nullptr)
+    const Char8* file_path = nullptr;
+    /// @brief The number of batches delivered
+    u64 delivered = 0;
+
+    /// @brief Copies a string to the text arena
+    /// @param str The string to copy (must fit)
+    /// @return The copy
+    const Char8* copy(std::string_view str) noexcept;
+
+  public:
+    /// @brief Constructor
+    /// @param targets The functions to which to deliver the diagnostics
+    /// @param capacity The maximum number of diagnostics in a batch
+    /// @param text_capacity The maximum number of bytes of text in a batch
+    DiagnosticBatch(
+        std::vector<ColtPlugin::fn_report_t> targets, u32 capacity = 256,
+        u32 text_capacity = 64 * 1024) noexcept;
+
+    DiagnosticBatch(DiagnosticBatch&&) noexcept            = default;
+    DiagnosticBatch& operator=(DiagnosticBatch&&) noexcept = default;
+
+    /// @brief Delivers the remaining diagnostics
+    ~DiagnosticBatch() noexcept { flush(); }
+
+    /// @brief Sets the file in which the next reports are generated
+    /// @param src The source file
+    void set_file(const lng::SourceFile& src) noexcept;
+
+    /// @brief Adds a report to the batch, delivering the batch if full
+    /// @param kind The kind of the report
+    /// @param str The report
+    /// @param src_info The source information if it exist
+    /// @param nb The report number if it exist
+    void push(
+        lng::ReportKind kind, u8StringView str,
+        const Option<lng::SourceInfo>& src_info,
+        const Option<lng::ReportNumber>& nb) noexcept;
+
+    /// @brief Delivers the diagnostics of the batch to all the targets
+    void flush() noexcept;
+
+    /// @brief Returns the number of diagnostics waiting to be delivered
+    /// @return The number of diagnostics in the batch
+    u32 pending() const noexcept { return count; }
+
+    /// @brief Returns the number of batches delivered
+    /// @return The number of batches delivered
+    u64 batches() const noexcept { return delivered; }
+  };
+
+  template<lng::Reporter Rep = lng::SinkReporter>
+  /// @brief Forwards reports to 'Rep', and delivers them in batches
+  ///        to REPORTER plugins.
+  /// @tparam Rep The reporter to which to forward the reports
+  class PluginReporter : public Rep
+  {
+    /// @brief The pending diagnostics
+    DiagnosticBatch batch;
+
+  public:
+    PluginReporter()                      = delete;
+    PluginReporter(PluginReporter&&)      = default;
+    PluginReporter(const PluginReporter&) = delete;
+
+    template<typename... Args>
+    /// @brief Constructor
+    /// @param targets The report functions of the plugins
+    /// @param args Arguments to forward to the constructor of 'Rep'
+    PluginReporter(
+        std::vector<ColtPlugin::fn_report_t> targets,
+        Args&&... args) noexcept(std::is_nothrow_constructible_v<Rep, Args...>)
+        : Rep(std::forward<Args>(args)...)
+        , batch(std::move(targets))
+    {
+    }
+
+    /// @brief Sets the file in which the next reports are generated
+    /// @param src The source file
+    void set_file(const lng::SourceFile& src) noexcept
+    {
+      if constexpr (lng::FileAwareReporter<Rep>)
+        Rep::set_file(src);
+      batch.set_file(src);
+    }
+
+    /// @brief Delivers the pending diagnostics (to call at the end of a
+    ///        phase), then flushes 'Rep' if it is a FlushableReporter
+    void flush() noexcept
+    {
+      batch.flush();
+      if constexpr (lng::FlushableReporter<Rep>)
+        Rep::flush();
+    }
+
+    /// @brief Returns the batch of diagnostics
+    /// @return The batch
+    const DiagnosticBatch& pending() const noexcept { return batch; }
+
+    /// @brief Forwards the message to 'Rep' and the plugins
+    /// @param str The message
+    /// @param src_info The source information if it exist
+    /// @param msg_nb The report information if it exist
+    void message(
+        u8StringView str, const Option<lng::SourceInfo>& src_info = None,
+        const Option<lng::ReportNumber>& msg_nb = None) noexcept
+    {
+      batch.push(lng::ReportKind::MESSAGE, str, src_info, msg_nb);
+      Rep::message(str, src_info, msg_nb);
+    }
+
+    /// @brief Forwards the warning to 'Rep' and the plugins
+    /// @param str The warning
+    /// @param src_info The source information if it exist
+    /// @param msg_nb The report information if it exist
+    void warn(
+        u8StringView str, const Option<lng::SourceInfo>& src_info = None,
+        const Option<lng::ReportNumber>& msg_nb = None) noexcept
+    {
+      batch.push(lng::ReportKind::WARNING, str, src_info, msg_nb);
+      Rep::warn(str, src_info, msg_nb);
+    }
+
+    /// @brief Forwards the error to 'Rep' and the plugins
+    /// @param str The error
+    /// @param src_info The source information if it exist
+    /// @param msg_nb The report information if it exist
+    void error(
+        u8StringView str, const Option<lng::SourceInfo>& src_info = None,
+        const Option<lng::ReportNumber>& msg_nb = None) noexcept
+    {
+      batch.push(lng::ReportKind::ERROR, str, src_info, msg_nb);
+      Rep::error(str, src_info, msg_nb);
+    }
+  };
+} // namespace clt::ffi
+
+#endif // !HG_COLTC_PLUGIN_REPORTER
@@ -0,0 +1,268 @@
+/*****************************************************************/ /**
+ * @file   input_files.cpp
+ * @brief  Implementation of 'expand_inputs'.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include "input_files.h"
+#include <algorithm>
+#include <filesystem>
+#include <unordered_set>
+
+namespace clt
+{
+  namespace details
+  {
+    /// @brief The separators of the components of a path
+#ifdef COLT_WINDOWS
+    static constexpr std::string_view PATH_SEPARATORS = "/\\";
+#else
+    static constexpr std::string_view PATH_SEPARATORS = "/";
+#endif // COLT_WINDOWS
+
+    /// @brief The files expanded so far
+    struct Expansion
+    {
+      /// @brief Where to append the files
+      std::vector<std::string>& inputs;
+      /// @brief The files already appended
+      std::unordered_set<std::string> seen = {};
+
+      /// @brief Appends a file (unless it was already appended)
+      /// @param path The path of the file
+      void add(std::string path)
+      {
+        if (seen.insert(path).second)
+          inputs.push_back(std::move(path));
+      }
+    };
+
+    /// @brief Check if a character separates the arguments of a response file
+    static bool is_space(char chr) noexcept
+    {
+      return chr == ' ' || chr == '\t' || chr == '\r' || chr == '\n';
+    }
+
+    /// @brief Matches a character against a set ('[...]')
+    /// @param pattern The glob
+    /// @param i The index following the '['
+    /// @param chr The character to match
+    /// @param matched Set to true if 'chr' is part of the set
+    /// @return The index following the ']' (or npos if the set is not closed)
+    static size_t match_set(
+        std::string_view pattern, size_t i, char chr, bool& matched) noexcept
+    {
+      const bool negate = i < pattern.size() && pattern[i] == '!';
+      if (negate)
+        ++i;
+      matched            = false;
+      const size_t first = i;
+      // A ']' just after '[' or '[!' is part of the set
+      while (i < pattern.size() && (pattern[i] != ']' || i == first))
+      {
+        if (i + 2 < pattern.size() && pattern[i + 1] == '-' && pattern[i + 2] != ']')
+        {
+          matched |= pattern[i] <= chr && chr <= pattern[i + 2];
+          i += 3;
+        }
+        else
+          matched |= pattern[i++] == chr;
+      }
+      if (i == pattern.size())
+        return std::string_view::npos;
+      matched = matched != negate;
+      return i + 1;
+    }
+
+    // Forward declaration
+    static bool expand_argument(
+        std::string_view arg, u32 depth, Expansion& out) noexcept;
+
+    /// @brief Expands a glob to the matching files, sorted by name
+    /// @param glob The glob
+    /// @param out The expansion
+    /// @return False on errors
+    static bool expand_glob(std::string_view glob, Expansion& out) noexcept
+    {
+      namespace fs = std::filesystem;
+      auto slash   = glob.find_last_of(PATH_SEPARATORS);
+      // The directory keeps its separator, so that it can be prepended
+      auto dir = slash == std::string_view::npos ? std::string_view{}
+                                                 : glob.substr(0, slash + 1);
+      auto pattern = glob.substr(dir.size());
+      if (is_glob(dir))
+      {
+        print_error("Wildcards are only supported in file names ('{}')!", glob);
+        return false;
+      }
+
+      std::error_code error;
+      auto it = fs::directory_iterator{
+          dir.empty() ? fs::path{"."} : fs::path{dir}, error};
+      if (error)
+      {
+        print_error("Could not list the files of '{}' ({})!", glob, error.message());
+        return false;
+      }
+      std::vector<std::string> names;
+      for (; it != fs::directory_iterator{}; it.increment(error))
+      {
+        auto name = it->path().filename().string();
+        // Like shells, wildcards do not match hidden files
+        if (name.starts_with('.') && !pattern.starts_with('.'))
+          continue;
+        if (it->is_regular_file(error) && glob_match(pattern, name))
+          names.push_back(std::move(name));
+      }
+      if (names.empty())
+      {
+        print_error("No file matches '{}'!", glob);
+        return false;
+      }
+      std::sort(names.begin(), names.end());
+      for (auto& name : names)
+        out.add(std::string{dir} + name);
+      return true;
+    }
+
+    /// @brief Expands the arguments of a response file
+    /// @param path The path of the response file
+    /// @param depth The nesting of the response file
+    /// @param out The expansion
+    /// @return False on errors
+    static bool expand_response(
+        std::string_view path, u32 depth, Expansion& out) noexcept
+    {
+      if (depth == MAX_RESPONSE_DEPTH)
+      {
+        print_error("Response files are nested too deeply ('@{}')!", path);
+        return false;
+      }
+      auto file = ViewOfFile::open(std::string{path}.c_str());
+      if (file.is_none())
+      {
+        print_error("Could not open response file '{}'!", path);
+        return false;
+      }
+      auto bytes   = *file->view();
+      auto content = std::string_view{
+          reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+
+      size_t i = 0;
+      while (true)
+      {
+        while (i < content.size() && is_space(content[i]))
+          ++i;
+        if (i == content.size())
+          return true;
+        std::string arg;
+        while (i < content.size() && !is_space(content[i]))
+        {
+          const char chr = content[i++];
+          if (chr != '"' && chr != '\'')
+          {
+            arg += chr;
+            continue;
+          }
+          // Quoted parts can contain spaces
+          auto end = content.find(chr, i);
+          if (end == std::string_view::npos)
+          {
+            print_error("Unterminated quote in response file '{}'!", path);
+            return false;
+          }
+          arg.append(content.substr(i, end - i));
+          i = end + 1;
+        }
+        if (!expand_argument(arg, depth + 1, out))
+          return false;
+      }
+    }
+
+    /// @brief Expands a positional argument or an argument of a response file
+    /// @param arg The argument
+    /// @param depth The nesting of the response file containing 'arg'
+    /// @param out The expansion
+    /// @return False on errors
+    static bool expand_argument(
+        std::string_view arg, u32 depth, Expansion& out) noexcept
+    {
+      if (arg.starts_with('@'))
+        return expand_response(arg.substr(1), depth, out);
+      if (is_glob(arg))
+        return expand_glob(arg, out);
+      out.add(std::string{arg});
+      return true;
+    }
+  } // namespace details
+
+  bool is_glob(std::string_view path) noexcept
+  {
+    return path.find_first_of("*?[") != std::string_view::npos;
+  }
+
+  bool glob_match(std::string_view pattern, std::string_view name) noexcept
+  {
+    // Position after the last '*' and the character of 'name' it stopped at
+    size_t star   = std::string_view::npos;
+    size_t star_n = 0;
+    size_t p      = 0;
+    size_t n      = 0;
+    while (n < name.size())
+    {
+      if (p < pattern.size())
+      {
+        if (pattern[p] == '*')
+        {
+          star   = ++p;
+          star_n = n;
+          continue;
+        }
+        if (pattern[p] == '[')
+        {
+          bool matched;
+          auto end = details::match_set(pattern, p + 1, name[n], matched);
+          // An unclosed '[' is a normal character
+          if (end == std::string_view::npos)
+          {
+            matched = name[n] == '[';
+            end     = p + 1;
+          }
+          if (matched)
+          {
+            p = end;
+            ++n;
+            continue;
+          }
+        }
+        else if (pattern[p] == '?' || pattern[p] == name[n])
+        {
+          ++p;
+          ++n;
+          continue;
+        }
+      }
+      // Mismatch: the last '*' matches one more character
+      if (star == std::string_view::npos)
+        return false;
+      p = star;
+      n = ++star_n;
+    }
+    while (p < pattern.size() && pattern[p] == '*')
+      ++p;
+    return p == pattern.size();
+  }
+
+  bool expand_inputs(
+      const std::vector<std::string_view>& args,
+      std::vector<std::string>& inputs) noexcept
+  {
+    COLT_TRACE_FN();
+    details::Expansion out{inputs};
+    for (auto& arg : args)
+      if (!details::expand_argument(arg, 0, out))
+        return false;
+    return true;
+  }
+} // namespace clt
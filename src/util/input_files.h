@@ -0,0 +1,55 @@
+/*****************************************************************/ /**
+ * @file   input_files.h
+ * @brief  Contains 'expand_inputs', which converts the positional
+ *         arguments of the compiler to the list of files to compile.
+ * An argument can be:
+ * - a path, which is kept as is (a missing file is reported when it is
+ *   opened, like any other file);
+ * - a glob ('*', '?' and '[...]' in the file name only, for example
+ *   'src/*.ct'), replaced by the matching files sorted by name;
+ * - '@file', a response file whose whitespace separated arguments
+ *   (which can be quoted, and can themselves be globs or response
+ *   files) are expanded in place.
+ * The first occurrence of a file is kept: duplicates are removed so
+ * that a file is never compiled twice.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_COLTC_INPUT_FILES
+#define HG_COLTC_INPUT_FILES
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace clt
+{
+  /// @brief The maximum nesting of response files (which detects cycles)
+  static constexpr u32 MAX_RESPONSE_DEPTH = 16;
+
+  /// @brief Check if a path contains a wildcard
+  /// @param path The path
+  /// @return True if 'path' contains '*', '?' or '['
+  bool is_glob(std::string_view path) noexcept;
+
+  /// @brief Matches a file name against a glob.
+  /// '*' matches any sequence, '?' any character, '[abc]', '[a-z]'
+  /// and '[!abc]' a character of (or not of) a set.
+  /// @param pattern The glob
+  /// @param name The file name
+  /// @return True if 'name' matches 'pattern'
+  bool glob_match(std::string_view pattern, std::string_view name) noexcept;
+
+  /// @brief Expands the positional arguments of the compiler.
+  /// Errors (unreadable response file, glob without any match...) are
+  /// printed.
+  /// @param args The positional arguments
+  /// @param inputs Where to append the files to compile
+  /// @return False on errors
+  bool expand_inputs(
+      const std::vector<std::string_view>& args,
+      std::vector<std::string>& inputs) noexcept;
+} // namespace clt
+
+#endif // !HG_COLTC_INPUT_FILES
@@ -0,0 +1,118 @@
+/*****************************************************************/ /**
+ * @file   lua_alloc.cpp
+ * @brief  Implementation of LuaArena.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include "lua_alloc.h"
+#include <util/mem_report.h>
+
+namespace clt::lua
+{
+  void* LuaArena::alloc_small(size_t cls) noexcept
+  {
+    if (auto slot = free_lists[cls]; slot != nullptr)
+    {
+      free_lists[cls] = slot->next;
+      return slot;
+    }
+    const size_t size = class_size(cls);
+    if (static_cast<size_t>(bump_end - bump) < size)
+    {
+      // The rest of the previous block is abandoned (less than MAX_SMALL bytes)
+      auto block = mem::Mallocator{}.alloc(BLOCK_SIZE);
+      if (block.ptr() == nullptr)
+        return nullptr;
+      blocks.push_back(block);
+      bump     = static_cast<u8*>(block.ptr());
+      bump_end = bump + BLOCK_SIZE;
+    }
+    auto ptr = bump;
+    bump += size;
+    return ptr;
+  }
+
+  void* LuaArena::reallocate(void* ptr, size_t osize, size_t nsize) noexcept
+  {
+    // When allocating, 'osize' is the type of the object
+    if (ptr == nullptr)
+    {
+      if (nsize == 0)
+        return nullptr;
+      osize = 0;
+    }
+
+    if (nsize > osize)
+    {
+      if (nsize - osize > limit - std::min(used, limit))
+      {
+        // Lua runs a full collection, then retries once
+        limit_hit = true;
+        return nullptr;
+      }
+    }
+    else if (nsize == 0)
+    {
+      if (osize <= MAX_SMALL)
+        free_small(ptr, class_of(osize));
+      else
+        std::free(ptr);
+      used -= osize;
+      MemAccounting::on_free(MemTag::LUA, ptr, osize);
+      return nullptr;
+    }
+
+    void* result = ptr;
+    if (osize > MAX_SMALL && nsize > MAX_SMALL)
+      result = std::realloc(ptr, nsize);
+    else if (
+        ptr == nullptr || osize > MAX_SMALL || class_of(osize) != class_of(nsize))
+    {
+      result =
+          nsize <= MAX_SMALL ? alloc_small(class_of(nsize)) : std::malloc(nsize);
+      if (result != nullptr && ptr != nullptr)
+      {
+        std::memcpy(result, ptr, std::min(osize, nsize));
+        if (osize <= MAX_SMALL)
+          free_small(ptr, class_of(osize));
+        else
+          std::free(ptr);
+      }
+    }
+    if (result == nullptr)
+    {
+      // Lua assumes that shrinking never fails: the bigger block is
+      // kept (when freed, it joins the free list of a smaller class)
+      if (nsize > osize)
+        return nullptr;
+      result = ptr;
+      if (osize > MAX_SMALL && nsize <= MAX_SMALL)
+        kept.push_back(ptr);
+    }
+
+    if (ptr != nullptr)
+      MemAccounting::on_free(MemTag::LUA, ptr, osize);
+    MemAccounting::on_alloc(MemTag::LUA, result, nsize);
+    if (nsize > osize)
+      allocated += nsize - osize;
+    used = used + nsize - osize;
+    peak = std::max(peak, used);
+    return result;
+  }
+
+  void LuaArena::release() noexcept
+  {
+    for (auto& block : blocks)
+      mem::Mallocator{}.dealloc(block);
+    blocks.clear();
+    for (auto ptr : kept)
+      std::free(ptr);
+    kept.clear();
+    free_lists.fill(nullptr);
+    bump     = nullptr;
+    bump_end = nullptr;
+    used     = 0;
+    peak     = 0;
+  }
+} // namespace clt::lua
@@ -0,0 +1,159 @@
+/*****************************************************************/ /**
+ * @file   lua_alloc.h
+ * @brief  Contains LuaArena, the allocator of the Lua states.
+ * Lua allocates many small objects (strings, tables, closures) of a
+ * few sizes: the default 'realloc' based allocator fragments the heap
+ * of the compiler, and lets a runaway script exhaust its memory.
+ * LuaArena serves small allocations from size classes carved out of
+ * large blocks (obtained from a colt-cpp allocator), and enforces a
+ * byte limit: a script exceeding it gets a Lua memory error instead.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_COLTC_LUA_ALLOC
+#define HG_COLTC_LUA_ALLOC
+
+#include <array>
+#include <bit>
+#include <limits>
+#include <vector>
+
+namespace clt::lua
+{
+  /// @brief Allocator of a single lua_State (passed to 'lua_newstate').
+  /// Allocations of at most MAX_SMALL bytes are served from free lists
+  /// (one per power of two size class), refilled from BLOCK_SIZE blocks.
+  /// Bigger allocations go through 'realloc'.
+  /// This class is not thread safe: like its state, an arena must only
+  /// be used by one thread at a time.
+  class LuaArena
+  {
+  public:
+    /// @brief The value of the limit when there is none
+    static constexpr u64 NO_LIMIT = std::numeric_limits<u64>::max();
+    /// @brief The biggest allocation served by the size classes
+    static constexpr size_t MAX_SMALL = 512;
+    /// @brief The size of the blocks from which slots are carved
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+  private:
+    /// @brief The size of the smallest class
+    static constexpr size_t MIN_SMALL = 16;
+    /// @brief The number of size classes (16, 32, ..., MAX_SMALL)
+    static constexpr size_t CLASS_COUNT = 6;
+
+    /// @brief A free slot of a size class
+    struct FreeSlot
+    {
+      /// @brief The next free slot of the same class
+      FreeSlot* next;
+    };
+
+    /// @brief The free slots of each class
+    std::array<FreeSlot*, CLASS_COUNT> free_lists = {};
+    /// @brief The blocks from which the slots were carved
+    std::vector<mem::MemBlock> blocks = {};
+    /// @brief The 'malloc' blocks that could not be shrunk to a slot.
+    /// They are used as slots, and only freed by 'release'.
+    std::vector<void*> kept = {};
+    /// @brief The beginning of the unused part of the last block
+    u8* bump = nullptr;
+    /// @brief The end of the last block
+    u8* bump_end = nullptr;
+    /// @brief The bytes currently allocated by Lua
+    u64 used = 0;
+    /// @brief The maximum value of 'used' since the last 'reset_peak'
+    u64 peak = 0;
+    /// @brief The total bytes allocated by Lua (never decreases)
+    u64 allocated = 0;
+    /// @brief Allocations making 'used' exceed 'limit' fail
+    u64 limit = NO_LIMIT;
+    /// @brief True if an allocation failed because of 'limit'
+    bool limit_hit = false;
+
+    /// @brief Returns the size class of a small allocation
+    /// @param size The size (in [1, MAX_SMALL])
+    /// @return The size class
+    static size_t class_of(size_t size) noexcept
+    {
+      return size <= MIN_SMALL ? 0 : std::bit_width(size - 1) - 4;
+    }
+
+    /// @brief Returns the size of the slots of a class
+    /// @param cls The size class
+    /// @return The size of the slots of the class
+    static size_t class_size(size_t cls) noexcept { return MIN_SMALL << cls; }
+
+    /// @brief Allocates a slot of a size class
+    /// @param cls The size class
+    /// @return The slot or nullptr
+    void* alloc_small(size_t cls) noexcept;
+    /// @brief Frees a slot of a size class
+    /// @param ptr The slot
+    /// @param cls The size class
+    void free_small(void* ptr, size_t cls) noexcept
+    {
+      auto slot       = static_cast<FreeSlot*>(ptr);
+      slot->next      = free_lists[cls];
+      free_lists[cls] = slot;
+    }
+
+    /// @brief Allocates, frees or resizes a memory block (see 'lua_Alloc')
+    /// @param ptr The block (or nullptr to allocate)
+    /// @param osize The size of the block (if ptr != nullptr)
+    /// @param nsize The new size of the block (0 to free)
+    /// @return The new block (or nullptr on failure or free)
+    void* reallocate(void* ptr, size_t osize, size_t nsize) noexcept;
+
+  public:
+    /// @brief Constructor
+    LuaArena() noexcept = default;
+    LuaArena(LuaArena&&)            = delete;
+    LuaArena(const LuaArena&)       = delete;
+    LuaArena& operator=(LuaArena&&) = delete;
+
+    /// @brief Releases the blocks
+    ~LuaArena() noexcept { release(); }
+
+    /// @brief The 'lua_Alloc' function, whose user data is a LuaArena
+    static void* allocate(void* ud, void* ptr, size_t osize, size_t nsize) noexcept
+    {
+      return static_cast<LuaArena*>(ud)->reallocate(ptr, osize, nsize);
+    }
+
+    /// @brief Returns all the blocks.
+    /// Must only be called once the state using the arena was closed
+    /// (which frees all the allocations that are not slots).
+    void release() noexcept;
+
+    /// @brief Sets the maximum number of bytes Lua may use
+    /// @param bytes The limit (or NO_LIMIT)
+    void set_limit(u64 bytes) noexcept
+    {
+      limit     = bytes;
+      limit_hit = false;
+    }
+
+    /// @brief Sets the peak usage to the current usage
+    void reset_peak() noexcept { peak = used; }
+
+    /// @brief Returns the bytes currently used by Lua
+    /// @return The bytes currently used by Lua
+    u64 in_use() const noexcept { return used; }
+    /// @brief Returns the maximum bytes used since the last 'reset_peak'
+    /// @return The maximum bytes used since the last 'reset_peak'
+    u64 peak_use() const noexcept { return peak; }
+    /// @brief Returns the total bytes ever allocated by Lua
+    /// @return The total bytes ever allocated by Lua
+    u64 total_allocated() const noexcept { return allocated; }
+    /// @brief Returns the bytes reserved from the system for the slots
+    /// @return The bytes reserved for the slots
+    u64 reserved() const noexcept { return blocks.size() * BLOCK_SIZE; }
+    /// @brief Check if an allocation failed because of the limit
+    /// @return True if an allocation failed since the last 'set_limit'
+    bool is_limit_hit() const noexcept { return limit_hit; }
+  };
+} // namespace clt::lua
+
+#endif // !HG_COLTC_LUA_ALLOC
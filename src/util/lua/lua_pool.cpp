@@ -0,0 +1,370 @@
+/*****************************************************************/ /**
+ * @file   lua_pool.cpp
+ * @brief  Implementation of LuaChunkCache, LuaState and LuaStatePool.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include "lua_pool.h"
+
+extern "C"
+{
+#include <lauxlib.h>
+#include <lualib.h>
+}
+
+namespace clt::lua
+{
+  namespace details
+  {
+    /// @brief The name of the metatable of the token view
+    static constexpr const char* TOKENS_META = "coltc.tokens";
+
+    /// @brief Converts the status returned by Lua to a LuaError
+    /// @param status The status (not LUA_OK)
+    /// @return The error
+    static LuaError to_error(int status) noexcept
+    {
+      switch (status)
+      {
+      case LUA_ERRSYNTAX:
+        return LuaError::SYNTAX_ERR;
+      case LUA_ERRMEM:
+        return LuaError::MEMORY_ERR;
+      default:
+        return LuaError::RUNTIME_ERR;
+      }
+    }
+
+    /// @brief Pops the error message on the top of the stack
+    /// @param state The state
+    /// @param out Where to write the message
+    static void pop_error(lua_State* state, std::string& out) noexcept
+    {
+      size_t size     = 0;
+      const char* str = lua_tolstring(state, -1, &size);
+      if (str == nullptr)
+        out = "<no error message>";
+      else
+        out.assign(str, size);
+      lua_pop(state, 1);
+    }
+
+    /// @brief Appends the chunks written by 'lua_dump' to a std::string
+    static int write_bytecode(
+        lua_State*, const void* data, size_t size, void* out)
+    {
+      static_cast<std::string*>(out)->append(static_cast<const char*>(data), size);
+      return 0;
+    }
+
+    /// @brief Returns the LexemesContext of the token view (argument 1)
+    /// and the token at index 'argument 2' (1-based).
+    /// Raises a Lua error if the view expired or the index is invalid
+    /// (which is why this function and its callers are not noexcept).
+    static lng::LexemeToken check_token(
+        lua_State* state, const lng::LexemesContext*& ctx)
+    {
+      ctx = *static_cast<const lng::LexemesContext**>(
+          luaL_checkudata(state, 1, TOKENS_META));
+      if (ctx == nullptr)
+        luaL_error(state, "token view used outside of its hook");
+      auto index   = luaL_checkinteger(state, 2);
+      auto& tokens = ctx->token_buffer();
+      luaL_argcheck(
+          state, index >= 1 && static_cast<u64>(index) <= tokens.size(), 2,
+          "token index out of range");
+      return tokens[static_cast<size_t>(index - 1)];
+    }
+
+    /// @brief tokens:kind(i): the Lexeme of the token (as an integer)
+    static int tokens_kind(lua_State* state)
+    {
+      const lng::LexemesContext* ctx;
+      auto token = check_token(state, ctx);
+      lua_pushinteger(state, static_cast<lua_Integer>(token.lexeme()));
+      return 1;
+    }
+
+    /// @brief tokens:name(i): the name of the Lexeme of the token
+    static int tokens_name(lua_State* state)
+    {
+      const lng::LexemesContext* ctx;
+      auto token = check_token(state, ctx);
+      auto name  = meta::reflect<lng::Lexeme>::to_str(token.lexeme());
+      lua_pushlstring(state, name.data(), name.size());
+      return 1;
+    }
+
+    /// @brief tokens:line(i): the 1-based line of the token
+    static int tokens_line(lua_State* state)
+    {
+      const lng::LexemesContext* ctx;
+      auto token = check_token(state, ctx);
+      lua_pushinteger(state, ctx->line_nb(token));
+      return 1;
+    }
+
+    /// @brief tokens:column(i): the 1-based column of the token
+    static int tokens_column(lua_State* state)
+    {
+      const lng::LexemesContext* ctx;
+      auto token = check_token(state, ctx);
+      lua_pushinteger(state, ctx->column_nb(token));
+      return 1;
+    }
+
+    /// @brief tokens:size(i): the size in bytes of the token
+    static int tokens_size(lua_State* state)
+    {
+      const lng::LexemesContext* ctx;
+      auto token = check_token(state, ctx);
+      lua_pushinteger(state, ctx->info(token).size);
+      return 1;
+    }
+
+    /// @brief tokens:identifier(i): the identifier or nil
+    static int tokens_identifier(lua_State* state)
+    {
+      const lng::LexemesContext* ctx;
+      auto token = check_token(state, ctx);
+      if (token.lexeme() != lng::Lexeme::TKN_IDENTIFIER)
+      {
+        lua_pushnil(state);
+        return 1;
+      }
+      auto name = ctx->extract_identifier(token);
+      lua_pushlstring(
+          state, reinterpret_cast<const char*>(name.data()), name.unit_len());
+      return 1;
+    }
+
+    /// @brief #tokens: the number of tokens
+    static int tokens_len(lua_State* state)
+    {
+      auto ctx = *static_cast<const lng::LexemesContext**>(
+          luaL_checkudata(state, 1, TOKENS_META));
+      if (ctx == nullptr)
+        return luaL_error(state, "token view used outside of its hook");
+      lua_pushinteger(state, static_cast<lua_Integer>(ctx->token_buffer().size()));
+      return 1;
+    }
+
+    /// @brief tokens[i] is tokens:kind(i), tokens.xxx are the methods
+    static int tokens_index(lua_State* state)
+    {
+      if (lua_type(state, 2) == LUA_TNUMBER)
+        return tokens_kind(state);
+      lua_pushvalue(state, 2);
+      lua_rawget(state, lua_upvalueindex(1));
+      return 1;
+    }
+
+    /// @brief Forbids writing to the token view
+    static int tokens_newindex(lua_State* state)
+    {
+      return luaL_error(state, "the token view is read-only");
+    }
+
+    /// @brief Reports errors raised outside of a protected call
+    static int panic(lua_State* state)
+    {
+      const char* str = lua_tolstring(state, -1, nullptr);
+      print_error("Lua: {}", str == nullptr ? "<no error message>" : str);
+      return 0;
+    }
+
+    /// @brief The methods of the token view
+    static constexpr luaL_Reg TOKENS_METHODS[] = {
+        {"kind", &tokens_kind},
+        {"name", &tokens_name},
+        {"line", &tokens_line},
+        {"column", &tokens_column},
+        {"size", &tokens_size},
+        {"identifier", &tokens_identifier},
+        {nullptr, nullptr},
+    };
+  } // namespace details
+
+  Expect<const LuaChunk*, LuaError> LuaChunkCache::compile(
+      std::string_view name, std::string_view source, std::string& error) noexcept
+  {
+    COLT_TRACE_FN_C(clt::Color::Purple);
+    std::scoped_lock guard{lock};
+    auto key = std::string{name};
+    key.push_back('\0');
+    key.append(source);
+    if (auto it = chunks.find(key); it != chunks.end())
+      return it->second.get();
+
+    // A temporary state is only used to compile the script
+    lua_State* state = luaL_newstate();
+    if (state == nullptr)
+      return {Error, LuaError::MEMORY_ERR};
+    auto chunk_name = "=" + std::string{name};
+    int status      = luaL_loadbufferx(
+        state, source.data(), source.size(), chunk_name.c_str(), "t");
+    if (status != LUA_OK)
+    {
+      details::pop_error(state, error);
+      lua_close(state);
+      return {Error, details::to_error(status)};
+    }
+    auto chunk  = std::make_unique<LuaChunk>();
+    chunk->name = std::move(chunk_name);
+    chunk->id   = next_id++;
+    // Debug information is kept for the line numbers of errors
+    lua_dump(state, &details::write_bytecode, &chunk->bytecode, 0);
+    lua_close(state);
+
+    auto ptr = chunk.get();
+    chunks.emplace(std::move(key), std::move(chunk));
+    return ptr;
+  }
+
+  LuaState::LuaState(u64 budget) noexcept
+      : budget(budget)
+  {
+    open();
+  }
+
+  void LuaState::open() noexcept
+  {
+    COLT_TRACE_FN_C(clt::Color::Purple);
+    state = lua_newstate(&LuaArena::allocate, &arena);
+    assert_true("Could not create Lua state!", state != nullptr);
+    lua_atpanic(state, &details::panic);
+    luaL_openlibs(state);
+
+    luaL_newmetatable(state, details::TOKENS_META);
+    lua_newtable(state);
+    luaL_setfuncs(state, details::TOKENS_METHODS, 0);
+    lua_pushcclosure(state, &details::tokens_index, 1);
+    lua_setfield(state, -2, "__index");
+    lua_pushcfunction(state, &details::tokens_newindex);
+    lua_setfield(state, -2, "__newindex");
+    lua_pushcfunction(state, &details::tokens_len);
+    lua_setfield(state, -2, "__len");
+    // Hides the metatable from scripts
+    lua_pushboolean(state, 0);
+    lua_setfield(state, -2, "__metatable");
+    lua_pop(state, 1);
+
+    // The token view is created once, and points to the context of
+    // the running hook
+    auto view = static_cast<const lng::LexemesContext**>(
+        lua_newuserdatauv(state, sizeof(const lng::LexemesContext*), 0));
+    *view = nullptr;
+    luaL_setmetatable(state, details::TOKENS_META);
+    tokens_ref = luaL_ref(state, LUA_REGISTRYINDEX);
+  }
+
+  LuaState::~LuaState() noexcept
+  {
+    lua_close(state);
+  }
+
+  void LuaState::reset() noexcept
+  {
+    COLT_TRACE_FN_C(clt::Color::Purple);
+    lua_close(state);
+    // Only the slots remain: all the blocks are returned at once
+    arena.release();
+    hooks.clear();
+    open();
+  }
+
+  Expect<int, LuaError> LuaState::hook_of(const LuaChunk& chunk) noexcept
+  {
+    if (auto it = hooks.find(chunk.id); it != hooks.end())
+      return it->second;
+
+    COLT_TRACE_FN_C(clt::Color::Purple);
+    int status = luaL_loadbufferx(
+        state, chunk.bytecode.data(), chunk.bytecode.size(), chunk.name.c_str(),
+        "b");
+    if (status == LUA_OK)
+      status = lua_pcall(state, 0, 1, 0);
+    if (status != LUA_OK)
+    {
+      details::pop_error(state, error);
+      return {Error, details::to_error(status)};
+    }
+    if (lua_type(state, -1) != LUA_TFUNCTION)
+    {
+      lua_pop(state, 1);
+      error = chunk.name + ": the chunk must return a function";
+      return {Error, LuaError::BAD_RESULT};
+    }
+    int ref = luaL_ref(state, LUA_REGISTRYINDEX);
+    hooks.emplace(chunk.id, ref);
+    return ref;
+  }
+
+  Expect<i64, LuaError> LuaState::run(
+      const LuaChunk& chunk, const lng::LexemesContext& ctx) noexcept
+  {
+    COLT_TRACE_FN_C(clt::Color::Purple);
+    // The budget also covers loading the chunk on its first run
+    const u64 base      = arena.in_use();
+    const u64 allocated = arena.total_allocated();
+    arena.reset_peak();
+    // ~base: saturates instead of overflowing
+    arena.set_limit(
+        budget == LuaArena::NO_LIMIT ? LuaArena::NO_LIMIT
+                                     : base + std::min(budget, ~base));
+
+    int status = LUA_OK;
+    auto hook  = hook_of(chunk);
+    if (hook.is_value())
+    {
+      lua_rawgeti(state, LUA_REGISTRYINDEX, *hook);
+      lua_rawgeti(state, LUA_REGISTRYINDEX, tokens_ref);
+      auto view =
+          static_cast<const lng::LexemesContext**>(lua_touserdata(state, -1));
+      *view  = &ctx;
+      status = lua_pcall(state, 1, 1, 0);
+      // The view may have been saved by the hook: invalidate it
+      *view = nullptr;
+    }
+    const bool over_budget = arena.is_limit_hit();
+    arena.set_limit(LuaArena::NO_LIMIT);
+
+    auto& use = usage[chunk.id];
+    use.runs++;
+    use.allocated += arena.total_allocated() - allocated;
+    use.peak = std::max(use.peak, arena.peak_use() - base);
+    use.over_budget += static_cast<u64>(over_budget);
+
+    if (hook.is_error() || status != LUA_OK)
+    {
+      if (hook.is_value())
+        details::pop_error(state, error);
+      auto err = hook.is_error() ? hook.error() : details::to_error(status);
+      if (err == LuaError::MEMORY_ERR && over_budget)
+        error = chunk.name + ": the hook exceeded its memory budget of "
+                + std::to_string(budget) + " bytes";
+      return {Error, err};
+    }
+
+    i64 result = 0;
+    if (lua_isinteger(state, -1))
+      result = static_cast<i64>(lua_tointeger(state, -1));
+    else if (!lua_isnil(state, -1))
+    {
+      lua_pop(state, 1);
+      error = chunk.name + ": the hook must return an integer or nothing";
+      return {Error, LuaError::BAD_RESULT};
+    }
+    lua_pop(state, 1);
+    return result;
+  }
+
+  LuaStatePool::LuaStatePool(u32 workers, u64 budget) noexcept
+  {
+    COLT_TRACE_FN_C(clt::Color::Purple);
+    states.reserve(workers);
+    for (u32 i = 0; i < workers; i++)
+      states.push_back(std::make_unique<LuaState>(budget));
+  }
+} // namespace clt::lua
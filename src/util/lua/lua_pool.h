@@ -0,0 +1,221 @@
+/*****************************************************************/ /**
+ * @file   lua_pool.h
+ * @brief  Contains the embedding layer used to run Lua hooks
+ *         (code generation, lint rules) during compilation.
+ * Creating a lua_State and compiling a script costs far more than
+ * running a small hook. LuaStatePool creates one preinitialized state
+ * per worker, LuaChunkCache compiles each script to bytecode once
+ * (shared by all states), and each state loads a chunk once, keeping
+ * the resulting hook function in its registry.
+ * Tokens are exposed to hooks through a single userdata per state,
+ * which points to the LexemesContext during the call: no table of
+ * tokens is ever built.
+ * Each state allocates through its own LuaArena, which bounds the
+ * memory a single run of a hook may use, and is released at once when
+ * the state is reset.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_COLTC_LUA_POOL
+#define HG_COLTC_LUA_POOL
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <frontend/lex/lexemes_context.h>
+#include "lua_alloc.h"
+
+extern "C"
+{
+#include <lua.h>
+}
+
+namespace clt::lua
+{
+  /// @brief Possible errors when loading or running a hook
+  enum class LuaError : u8
+  {
+    /// @brief The script does not compile
+    SYNTAX_ERR,
+    /// @brief The script raised an error
+    RUNTIME_ERR,
+    /// @brief Lua ran out of memory
+    MEMORY_ERR,
+    /// @brief The chunk did not return a function, or the hook did not
+    ///        return an integer (or nothing)
+    BAD_RESULT,
+  };
+
+  /// @brief A script compiled to bytecode by a LuaChunkCache
+  struct LuaChunk
+  {
+    /// @brief The name of the chunk (used in error messages)
+    std::string name;
+    /// @brief The bytecode
+    std::string bytecode;
+    /// @brief The unique ID of the chunk in its cache
+    u32 id;
+  };
+
+  /// @brief The memory used by the runs of the hook of a chunk
+  struct LuaUsage
+  {
+    /// @brief The number of runs
+    u64 runs = 0;
+    /// @brief The total bytes allocated by all the runs
+    u64 allocated = 0;
+    /// @brief The maximum bytes in use (above what the state used before
+    ///        the run) during a single run
+    u64 peak = 0;
+    /// @brief The number of runs that exceeded the memory budget
+    u64 over_budget = 0;
+  };
+
+  /// @brief Compiles scripts to bytecode once.
+  /// The returned chunks remain valid as long as the cache is alive.
+  /// This class is thread safe.
+  class LuaChunkCache
+  {
+    /// @brief Protects all the members below
+    std::mutex lock;
+    /// @brief Maps the name and source of a chunk (separated by a NUL)
+    ///        to the chunk
+    std::unordered_map<std::string, std::unique_ptr<LuaChunk>> chunks;
+    /// @brief The next chunk ID
+    u32 next_id = 0;
+
+  public:
+    /// @brief Returns the chunk named 'name', compiling 'source' if it
+    ///        was not already compiled under that name.
+    /// A script that changed is compiled again.
+    /// @param name The name of the chunk (for example, the script path)
+    /// @param source The source code of the script
+    /// @param error Where to write the error message on failure
+    /// @return The chunk or SYNTAX_ERR/MEMORY_ERR
+    Expect<const LuaChunk*, LuaError> compile(
+        std::string_view name, std::string_view source,
+        std::string& error) noexcept;
+  };
+
+  /// @brief A preinitialized lua_State.
+  /// A state must only be used by one thread at a time.
+  class LuaState
+  {
+    /// @brief The allocator of the state (must outlive it)
+    LuaArena arena;
+    /// @brief The state
+    lua_State* state;
+    /// @brief Registry reference to the token userdata
+    int tokens_ref;
+    /// @brief Maps the ID of a chunk to the registry reference of its hook
+    std::unordered_map<u32, int> hooks = {};
+    /// @brief Maps the ID of a chunk to the memory used by its runs
+    std::unordered_map<u32, LuaUsage> usage = {};
+    /// @brief The bytes a single run may allocate (or LuaArena::NO_LIMIT)
+    u64 budget;
+    /// @brief The message of the last error
+    std::string error = {};
+
+    /// @brief Creates the state, opening the standard libraries and
+    ///        registering the token userdata
+    void open() noexcept;
+
+    /// @brief Returns the hook of a chunk, loading the chunk if needed
+    /// @param chunk The chunk
+    /// @return The registry reference of the hook or an error (see 'error')
+    Expect<int, LuaError> hook_of(const LuaChunk& chunk) noexcept;
+
+  public:
+    /// @brief Creates a state, opening the standard libraries and
+    ///        registering the token userdata
+    /// @param budget The bytes a single run of a hook may allocate
+    LuaState(u64 budget = LuaArena::NO_LIMIT) noexcept;
+    LuaState(LuaState&&)            = delete;
+    LuaState(const LuaState&)       = delete;
+    LuaState& operator=(LuaState&&) = delete;
+
+    /// @brief Closes the state
+    ~LuaState() noexcept;
+
+    /// @brief Runs the hook of a chunk over the tokens of a file.
+    /// The chunk must return a function taking the token view. That
+    /// function is called with the tokens, and may return an integer.
+    /// The token view must not be used once the hook returned.
+    /// @param chunk The chunk (loaded in this state on its first use)
+    /// @param ctx The tokens to expose to the hook
+    /// @return The integer returned by the hook (0 if none) or an error
+    ///         (MEMORY_ERR if the run exceeded the budget of the state)
+    Expect<i64, LuaError> run(
+        const LuaChunk& chunk, const lng::LexemesContext& ctx) noexcept;
+
+    /// @brief Closes the state, releasing all its memory at once, then
+    ///        recreates it. The chunks are reloaded on their next run.
+    /// The memory usage of the chunks is preserved.
+    void reset() noexcept;
+
+    /// @brief Sets the bytes a single run of a hook may allocate
+    /// @param bytes The budget (or LuaArena::NO_LIMIT)
+    void set_budget(u64 bytes) noexcept { budget = bytes; }
+
+    /// @brief Returns the memory used by the runs of the hook of a chunk
+    /// @param chunk The chunk
+    /// @return The memory usage (all zeros if the hook never ran)
+    LuaUsage usage_of(const LuaChunk& chunk) const noexcept
+    {
+      auto it = usage.find(chunk.id);
+      return it == usage.end() ? LuaUsage{} : it->second;
+    }
+
+    /// @brief Returns the allocator of the state
+    /// @return The allocator of the state
+    const LuaArena& memory() const noexcept { return arena; }
+
+    /// @brief Returns the message of the last error
+    /// @return The message of the last error
+    std::string_view last_error() const noexcept { return error; }
+
+    /// @brief Returns the underlying state (to register functions)
+    /// @return The state
+    lua_State* get() const noexcept { return state; }
+  };
+
+  /// @brief Pool of preinitialized states, one per worker
+  class LuaStatePool
+  {
+    /// @brief The states
+    std::vector<std::unique_ptr<LuaState>> states;
+    /// @brief The shared bytecode cache
+    LuaChunkCache cache;
+
+  public:
+    /// @brief Creates 'workers' states
+    /// @param workers The number of workers
+    /// @param budget The bytes a single run of a hook may allocate
+    LuaStatePool(u32 workers, u64 budget = LuaArena::NO_LIMIT) noexcept;
+
+    /// @brief Returns the state of a worker
+    /// @param worker The worker (less than 'size()')
+    /// @return The state of the worker
+    LuaState& state(u32 worker) noexcept
+    {
+      assert_true("Invalid worker!", worker < states.size());
+      return *states[worker];
+    }
+
+    /// @brief Returns the bytecode cache shared by the states
+    /// @return The bytecode cache
+    LuaChunkCache& chunks() noexcept { return cache; }
+
+    /// @brief Returns the number of states
+    /// @return The number of states
+    u32 size() const noexcept { return static_cast<u32>(states.size()); }
+  };
+} // namespace clt::lua
+
+ADD_REFLECTION_FOR_CONSECUTIVE_ENUM(
+    clt::lua, LuaError, SYNTAX_ERR, RUNTIME_ERR, MEMORY_ERR, BAD_RESULT);
+
+#endif // !HG_COLTC_LUA_POOL
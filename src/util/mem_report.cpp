@@ -0,0 +1,134 @@
+/*****************************************************************/ /**
+ * @file   mem_report.cpp
+ * @brief  Implementation of MemAccounting.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include "mem_report.h"
+
+#ifdef COLT_WINDOWS
+  #include <Windows.h>
+  #include <psapi.h>
+#else
+  #include <sys/resource.h>
+#endif // COLT_WINDOWS
+
+namespace clt
+{
+  namespace details
+  {
+    /// @brief The names of the tags (also the names of the Tracy pools,
+    ///        which must be string literals)
+    static constexpr std::array<const char*, MemAccounting::TAG_COUNT> TAG_NAMES =
+        {"lexer", "literals", "reporters", "plugins", "lua", "backend"};
+
+    /// @brief Converts bytes to KiB for printing
+    static double to_kib(u64 bytes) noexcept
+    {
+      return static_cast<double>(bytes) / 1024;
+    }
+  } // namespace details
+
+  void MemAccounting::count_alloc(MemTag tag, size_t bytes) noexcept
+  {
+    auto& counter = counters[static_cast<size_t>(tag)];
+    counter.allocs.fetch_add(1, std::memory_order_relaxed);
+    const u64 live =
+        counter.live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    u64 peak = counter.peak.load(std::memory_order_relaxed);
+    while (peak < live
+           && !counter.peak.compare_exchange_weak(
+               peak, live, std::memory_order_relaxed))
+      ;
+  }
+
+  void MemAccounting::count_free(MemTag tag, size_t bytes) noexcept
+  {
+    auto& counter = counters[static_cast<size_t>(tag)];
+    counter.frees.fetch_add(1, std::memory_order_relaxed);
+    counter.live.fetch_sub(bytes, std::memory_order_relaxed);
+  }
+
+  void MemAccounting::trace_alloc(
+      MemTag tag, const void* ptr, size_t bytes) noexcept
+  {
+#ifdef COLT_ENABLE_TRACING
+    TracyAllocN(ptr, bytes, details::TAG_NAMES[static_cast<size_t>(tag)]);
+#else
+    (void)tag, (void)ptr, (void)bytes;
+#endif // COLT_ENABLE_TRACING
+  }
+
+  void MemAccounting::trace_free(MemTag tag, const void* ptr) noexcept
+  {
+#ifdef COLT_ENABLE_TRACING
+    TracyFreeN(ptr, details::TAG_NAMES[static_cast<size_t>(tag)]);
+#else
+    (void)tag, (void)ptr;
+#endif // COLT_ENABLE_TRACING
+  }
+
+  MemStats MemAccounting::stats(MemTag tag) noexcept
+  {
+    auto& counter = counters[static_cast<size_t>(tag)];
+    return MemStats{
+        counter.live.load(std::memory_order_relaxed),
+        counter.peak.load(std::memory_order_relaxed),
+        counter.allocs.load(std::memory_order_relaxed),
+        counter.frees.load(std::memory_order_relaxed)};
+  }
+
+  void MemAccounting::reset() noexcept
+  {
+    for (auto& counter : counters)
+    {
+      counter.live.store(0, std::memory_order_relaxed);
+      counter.peak.store(0, std::memory_order_relaxed);
+      counter.allocs.store(0, std::memory_order_relaxed);
+      counter.frees.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  u64 MemAccounting::peak_rss() noexcept
+  {
+#ifdef COLT_WINDOWS
+    PROCESS_MEMORY_COUNTERS info;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info)))
+      return 0;
+    return info.PeakWorkingSetSize;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+      return 0;
+  #ifdef __APPLE__
+    // macOS reports bytes
+    return static_cast<u64>(usage.ru_maxrss);
+  #else
+    // Linux reports KiB
+    return static_cast<u64>(usage.ru_maxrss) * 1024;
+  #endif // __APPLE__
+#endif // COLT_WINDOWS
+  }
+
+  void MemAccounting::print() noexcept
+  {
+    clt::print("Memory report:");
+    clt::print(
+        "  {:<10} {:>12} {:>12} {:>10} {:>10}", "subsystem", "live (KiB)",
+        "peak (KiB)", "allocs", "frees");
+    u64 peak_sum = 0;
+    for (size_t i = 0; i < TAG_COUNT; i++)
+    {
+      auto mem = stats(static_cast<MemTag>(i));
+      peak_sum += mem.peak;
+      clt::print(
+          "  {:<10} {:>12.1f} {:>12.1f} {:>10} {:>10}", details::TAG_NAMES[i],
+          details::to_kib(mem.live), details::to_kib(mem.peak), mem.allocs,
+          mem.frees);
+    }
+    clt::print(
+        "  sum of peaks: {:.1f} KiB, peak RSS: {:.1f} KiB",
+        details::to_kib(peak_sum), details::to_kib(peak_rss()));
+  }
+} // namespace clt
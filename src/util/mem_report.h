@@ -0,0 +1,266 @@
+/*****************************************************************/ /**
+ * @file   mem_report.h
+ * @brief  Contains MemAccounting, used by '--mem-report'.
+ * Memory is accounted per subsystem (MemTag): live bytes, peak bytes
+ * and number of allocations. Containers owned by the compiler use
+ * TrackingAllocator. Storage whose allocator belongs to colt-cpp
+ * (the arrays of LexemesContext, BigInt literals) is charged through
+ * a MemCharge that lives as long as that storage.
+ * When tracing is enabled, each allocation is also sent to Tracy as a
+ * memory event of the pool named after its tag.
+ * When disabled (and without tracing), accounting costs one relaxed load.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_COLTC_MEM_REPORT
+#define HG_COLTC_MEM_REPORT
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace clt
+{
+  /// @brief The subsystems whose memory is accounted
+  enum class MemTag : u8
+  {
+    /// @brief The token, line and identifier arrays of the lexer
+    LEXER,
+    /// @brief The literals (BigInt, BigRational, strings) of the lexer
+    LITERALS,
+    /// @brief The buffers of the reporters
+    REPORTERS,
+    /// @brief The plugin registry
+    PLUGINS,
+    /// @brief The Lua states
+    LUA,
+    /// @brief The flat modules handed to the backends
+    BACKEND,
+  };
+
+  /// @brief The memory used by a subsystem
+  struct MemStats
+  {
+    /// @brief The bytes currently allocated
+    u64 live;
+    /// @brief The maximum value of 'live'
+    u64 peak;
+    /// @brief The number of allocations
+    u64 allocs;
+    /// @brief The number of deallocations
+    u64 frees;
+  };
+
+  /// @brief Process-wide memory accounting per MemTag.
+  /// This class is thread safe.
+  class MemAccounting
+  {
+  public:
+    /// @brief The number of tags
+    static constexpr size_t TAG_COUNT = static_cast<size_t>(MemTag::BACKEND) + 1;
+
+  private:
+    /// @brief The counters of a tag
+    struct Counters
+    {
+      std::atomic<u64> live;
+      std::atomic<u64> peak;
+      std::atomic<u64> allocs;
+      std::atomic<u64> frees;
+    };
+
+    /// @brief True if the counters are updated
+    static inline std::atomic<bool> enabled = false;
+    /// @brief The counters of each tag
+    static inline std::array<Counters, TAG_COUNT> counters = {};
+
+    /// @brief Updates the counters after an allocation
+    static void count_alloc(MemTag tag, size_t bytes) noexcept;
+    /// @brief Updates the counters after a deallocation
+    static void count_free(MemTag tag, size_t bytes) noexcept;
+    /// @brief Sends an allocation to Tracy
+    static void trace_alloc(MemTag tag, const void* ptr, size_t bytes) noexcept;
+    /// @brief Sends a deallocation to Tracy
+    static void trace_free(MemTag tag, const void* ptr) noexcept;
+
+  public:
+    /// @brief Enables or disables the counters.
+    /// Must be called before the first accounted allocation.
+    /// @param value True to update the counters
+    static void enable(bool value = true) noexcept
+    {
+      enabled.store(value, std::memory_order_relaxed);
+    }
+
+    /// @brief Check if the counters are updated
+    /// @return True if the counters are updated
+    static bool is_enabled() noexcept
+    {
+      return enabled.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Accounts an allocation
+    /// @param tag The subsystem
+    /// @param ptr The allocation (only used for tracing)
+    /// @param bytes The size of the allocation
+    static void on_alloc(MemTag tag, const void* ptr, size_t bytes) noexcept
+    {
+#ifdef COLT_ENABLE_TRACING
+      trace_alloc(tag, ptr, bytes);
+#endif // COLT_ENABLE_TRACING
+      if (is_enabled())
+        count_alloc(tag, bytes);
+    }
+
+    /// @brief Accounts a deallocation
+    /// @param tag The subsystem
+    /// @param ptr The allocation (only used for tracing)
+    /// @param bytes The size of the allocation
+    static void on_free(MemTag tag, const void* ptr, size_t bytes) noexcept
+    {
+#ifdef COLT_ENABLE_TRACING
+      trace_free(tag, ptr);
+#endif // COLT_ENABLE_TRACING
+      if (is_enabled())
+        count_free(tag, bytes);
+    }
+
+    /// @brief Returns the memory used by a subsystem
+    /// @param tag The subsystem
+    /// @return The memory used by the subsystem
+    static MemStats stats(MemTag tag) noexcept;
+
+    /// @brief Resets the counters of all the tags
+    static void reset() noexcept;
+
+    /// @brief Returns the peak resident set size of the process
+    /// @return The peak RSS in bytes (or 0 if not supported)
+    static u64 peak_rss() noexcept;
+
+    /// @brief Prints the memory used by each subsystem and the peak RSS
+    static void print() noexcept;
+  };
+
+  template<typename T, MemTag TAG>
+  /// @brief std compatible allocator accounting its allocations to TAG
+  /// @tparam T The type to allocate
+  /// @tparam TAG The subsystem
+  struct TrackingAllocator
+  {
+    using value_type = T;
+
+    template<typename U>
+    struct rebind
+    {
+      using other = TrackingAllocator<U, TAG>;
+    };
+
+    /// @brief Constructor
+    constexpr TrackingAllocator() noexcept = default;
+
+    template<typename U>
+    /// @brief Converting constructor
+    constexpr TrackingAllocator(const TrackingAllocator<U, TAG>&) noexcept
+    {
+    }
+
+    /// @brief Allocates 'n' objects
+    /// @param n The number of objects
+    /// @return The allocation
+    T* allocate(size_t n)
+    {
+      auto ptr = std::allocator<T>{}.allocate(n);
+      MemAccounting::on_alloc(TAG, ptr, n * sizeof(T));
+      return ptr;
+    }
+
+    /// @brief Deallocates 'n' objects
+    /// @param ptr The allocation
+    /// @param n The number of objects
+    void deallocate(T* ptr, size_t n) noexcept
+    {
+      MemAccounting::on_free(TAG, ptr, n * sizeof(T));
+      std::allocator<T>{}.deallocate(ptr, n);
+    }
+
+    template<typename U>
+    friend constexpr bool operator==(
+        const TrackingAllocator&, const TrackingAllocator<U, TAG>&) noexcept
+    {
+      return true;
+    }
+  };
+
+  template<typename T, MemTag TAG>
+  /// @brief std::vector whose allocations are accounted to TAG
+  using TrackedVector = std::vector<T, TrackingAllocator<T, TAG>>;
+
+  /// @brief Charges bytes allocated by code that cannot be given a
+  ///        TrackingAllocator to a subsystem, for the lifetime of the charge.
+  class MemCharge
+  {
+    /// @brief The subsystem
+    MemTag tag;
+    /// @brief The bytes charged
+    size_t bytes;
+
+  public:
+    /// @brief Charges 'bytes' to 'tag'
+    /// @param tag The subsystem
+    /// @param bytes The bytes to charge
+    MemCharge(MemTag tag, size_t bytes = 0) noexcept
+        : tag(tag)
+        , bytes(bytes)
+    {
+      if (bytes != 0)
+        MemAccounting::on_alloc(tag, this, bytes);
+    }
+
+    MemCharge(const MemCharge&) = delete;
+
+    /// @brief Move constructor, transferring the charge
+    /// @param other The charge to move
+    MemCharge(MemCharge&& other) noexcept
+        : tag(other.tag)
+        , bytes(0)
+    {
+      auto moved = other.bytes;
+      other.update(0);
+      update(moved);
+    }
+
+    /// @brief Move assignment operator, transferring the charge
+    /// @param other The charge to move
+    /// @return Self
+    MemCharge& operator=(MemCharge&& other) noexcept
+    {
+      update(0);
+      tag        = other.tag;
+      auto moved = other.bytes;
+      other.update(0);
+      update(moved);
+      return *this;
+    }
+
+    /// @brief Replaces the bytes charged
+    /// @param new_bytes The new bytes to charge
+    void update(size_t new_bytes) noexcept
+    {
+      if (bytes != 0)
+        MemAccounting::on_free(tag, this, bytes);
+      bytes = new_bytes;
+      if (bytes != 0)
+        MemAccounting::on_alloc(tag, this, bytes);
+    }
+
+    /// @brief Releases the charge
+    ~MemCharge() noexcept { update(0); }
+  };
+} // namespace clt
+
+ADD_REFLECTION_FOR_CONSECUTIVE_ENUM(
+    clt, MemTag, LEXER, LITERALS, REPORTERS, PLUGINS, LUA, BACKEND);
+
+#endif // !HG_COLTC_MEM_REPORT
@@ -0,0 +1,176 @@
+/*****************************************************************/ /**
+ * @file   phase_timer.cpp
+ * @brief  Implementation of PhaseTimes.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include "phase_timer.h"
+#include <chrono>
+#include <frontend/err/machine_reporter.h>
+
+#ifdef COLT_WINDOWS
+  #include <Windows.h>
+#else
+  #include <time.h>
+#endif // COLT_WINDOWS
+
+namespace clt
+{
+  namespace details
+  {
+    /// @brief The names of the phases (used in the table and the JSON)
+    static constexpr std::array<std::string_view, PhaseTimes::PHASE_COUNT>
+        PHASE_NAMES = {
+            "map_file", "lex", "report", "lua_hook", "backend", "cache"};
+
+    /// @brief Returns 'quantity' per second of 'wall_ns'
+    static double per_second(u64 quantity, u64 wall_ns) noexcept
+    {
+      return wall_ns == 0 ? 0.0 : static_cast<double>(quantity) * 1e9 / wall_ns;
+    }
+
+    /// @brief Prints the table of the time spent in each phase
+    /// @param title The title of the table
+    /// @param phases The time spent in each phase
+    static void print_table(
+        std::string_view title,
+        const std::array<PhaseStats, PhaseTimes::PHASE_COUNT>& phases) noexcept
+    {
+      PhaseStats sum;
+      for (auto& stats : phases)
+        sum += stats;
+      clt::print("Time report for {}:", title);
+      clt::print(
+          "  {:<10} {:>6} {:>11} {:>11} {:>6} {:>11} {:>13}", "phase", "runs",
+          "wall (ms)", "cpu (ms)", "%", "MiB/s", "tokens/s");
+      for (size_t i = 0; i < phases.size(); i++)
+      {
+        auto& stats = phases[i];
+        if (stats.count == 0)
+          continue;
+        clt::print(
+            "  {:<10} {:>6} {:>11.3f} {:>11.3f} {:>6.1f} {:>11.1f} {:>13.0f}",
+            PHASE_NAMES[i], stats.count, stats.wall_ns / 1e6, stats.cpu_ns / 1e6,
+            sum.wall_ns == 0 ? 0.0 : 100.0 * stats.wall_ns / sum.wall_ns,
+            per_second(stats.bytes, stats.wall_ns) / (1024 * 1024),
+            per_second(stats.tokens, stats.wall_ns));
+      }
+      clt::print(
+          "  {:<10} {:>6} {:>11.3f} {:>11.3f}", "total", "", sum.wall_ns / 1e6,
+          sum.cpu_ns / 1e6);
+    }
+
+    /// @brief Writes the time spent in each phase as a JSON object
+    /// @param out The writer
+    /// @param phases The time spent in each phase
+    static void write_phases(
+        lng::BufferedWriter& out,
+        const std::array<PhaseStats, PhaseTimes::PHASE_COUNT>& phases) noexcept
+    {
+      out.write('{');
+      bool first = true;
+      for (size_t i = 0; i < phases.size(); i++)
+      {
+        auto& stats = phases[i];
+        if (stats.count == 0)
+          continue;
+        if (!first)
+          out.write(',');
+        first = false;
+        out.write_json_string(PHASE_NAMES[i]);
+        out.write(":{\"runs\":");
+        out.write_u64(stats.count);
+        out.write(",\"wall_ns\":");
+        out.write_u64(stats.wall_ns);
+        out.write(",\"cpu_ns\":");
+        out.write_u64(stats.cpu_ns);
+        out.write(",\"bytes\":");
+        out.write_u64(stats.bytes);
+        out.write(",\"tokens\":");
+        out.write_u64(stats.tokens);
+        out.write('}');
+      }
+      out.write('}');
+    }
+  } // namespace details
+
+  u64 wall_time_ns() noexcept
+  {
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count());
+  }
+
+  u64 cpu_time_ns() noexcept
+  {
+#ifdef COLT_WINDOWS
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+      return 0;
+    auto to_u64 = [](const FILETIME& time)
+    { return (static_cast<u64>(time.dwHighDateTime) << 32) | time.dwLowDateTime; };
+    // FILETIME is in units of 100 nanoseconds
+    return (to_u64(kernel) + to_u64(user)) * 100;
+#else
+    timespec time;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+      return 0;
+    return static_cast<u64>(time.tv_sec) * 1'000'000'000 + time.tv_nsec;
+#endif // COLT_WINDOWS
+  }
+
+  void PhaseTimes::record(Phase phase, const PhaseStats& stats) noexcept
+  {
+    if (!enabled)
+      return;
+    // Phases running before the first file are grouped together
+    if (files.empty())
+      files.push_back(FileTimes{"<no file>"});
+    files.back().phases[static_cast<size_t>(phase)] += stats;
+  }
+
+  std::array<PhaseStats, PhaseTimes::PHASE_COUNT> PhaseTimes::total()
+      const noexcept
+  {
+    std::array<PhaseStats, PHASE_COUNT> sum = {};
+    for (auto& file : files)
+      for (size_t i = 0; i < PHASE_COUNT; i++)
+        sum[i] += file.phases[i];
+    return sum;
+  }
+
+  void PhaseTimes::print() const noexcept
+  {
+    for (auto& file : files)
+      details::print_table(fmt::format("'{}'", file.path), file.phases);
+    if (files.size() > 1)
+      details::print_table(fmt::format("{} files", files.size()), total());
+  }
+
+  bool PhaseTimes::write_json(const char* path) const noexcept
+  {
+    auto file = std::fopen(path, "wb");
+    if (file == nullptr)
+      return false;
+    {
+      lng::BufferedWriter out{file};
+      out.write("{\"files\":[");
+      for (size_t i = 0; i < files.size(); i++)
+      {
+        if (i != 0)
+          out.write(',');
+        out.write("{\"path\":");
+        out.write_json_string(files[i].path);
+        out.write(",\"phases\":");
+        details::write_phases(out, files[i].phases);
+        out.write('}');
+      }
+      out.write("],\"total\":");
+      details::write_phases(out, total());
+      out.write("}\n");
+    }
+    const bool ok = std::ferror(file) == 0;
+    return (std::fclose(file) == 0) && ok;
+  }
+} // namespace clt
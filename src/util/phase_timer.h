@@ -0,0 +1,213 @@
+/*****************************************************************/ /**
+ * @file   phase_timer.h
+ * @brief  Contains PhaseTimes and PhaseScope, used by '--time-report'.
+ * Unlike tracing (which requires a build with COLT_ENABLE_TRACING and
+ * the Tracy GUI), the phase timer is always compiled: production
+ * binaries can report where the time of a slow build went.
+ * When disabled, a PhaseScope costs a single branch: the clocks are
+ * only read when the report was enabled.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_COLTC_PHASE_TIMER
+#define HG_COLTC_PHASE_TIMER
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace clt
+{
+  /// @brief The phases of the compilation of a file
+  enum class Phase : u8
+  {
+    /// @brief Mapping the file to memory
+    MAP_FILE,
+    /// @brief Lexing the file
+    LEX,
+    /// @brief Printing the tokens and flushing the diagnostics (flushed
+    ///        once per batch, and counted in the first file of the batch)
+    REPORT,
+    /// @brief Running the Lua hook
+    LUA_HOOK,
+    /// @brief Writing the flat module and running the backends
+    BACKEND,
+    /// @brief Hashing the file, and loading or storing its cache entry
+    CACHE,
+  };
+
+  /// @brief The time spent in a phase
+  struct PhaseStats
+  {
+    /// @brief The wall time in nanoseconds
+    u64 wall_ns = 0;
+    /// @brief The CPU time (of the thread) in nanoseconds
+    u64 cpu_ns = 0;
+    /// @brief The bytes processed (0 if not meaningful)
+    u64 bytes = 0;
+    /// @brief The tokens processed (0 if not meaningful)
+    u64 tokens = 0;
+    /// @brief The number of times the phase ran
+    u32 count = 0;
+
+    /// @brief Adds the time of another run of the phase
+    /// @param other The other run
+    /// @return Self
+    PhaseStats& operator+=(const PhaseStats& other) noexcept
+    {
+      wall_ns += other.wall_ns;
+      cpu_ns += other.cpu_ns;
+      bytes += other.bytes;
+      tokens += other.tokens;
+      count += other.count;
+      return *this;
+    }
+  };
+
+  /// @brief Returns a monotonic time in nanoseconds
+  /// @return A monotonic time in nanoseconds
+  u64 wall_time_ns() noexcept;
+  /// @brief Returns the CPU time consumed by the current thread in nanoseconds
+  /// @return The CPU time consumed by the current thread
+  u64 cpu_time_ns() noexcept;
+
+  /// @brief The time spent in each phase, for each file.
+  /// This class is not thread safe.
+  class PhaseTimes
+  {
+  public:
+    /// @brief The number of phases
+    static constexpr size_t PHASE_COUNT =
+        static_cast<size_t>(Phase::CACHE) + 1;
+
+    /// @brief The time spent on a file
+    struct FileTimes
+    {
+      /// @brief The path of the file
+      std::string path;
+      /// @brief The time spent in each phase
+      std::array<PhaseStats, PHASE_COUNT> phases = {};
+    };
+
+  private:
+    /// @brief The files, in the order in which they were compiled
+    std::vector<FileTimes> files = {};
+    /// @brief True if the times are recorded
+    bool enabled = false;
+
+  public:
+    /// @brief Enables or disables recording
+    /// @param value True to record the times
+    void enable(bool value = true) noexcept { enabled = value; }
+
+    /// @brief Check if the times are recorded
+    /// @return True if the times are recorded
+    bool is_enabled() const noexcept { return enabled; }
+
+    /// @brief Starts recording the phases of a file
+    /// @param path The path of the file
+    void begin_file(std::string_view path) noexcept
+    {
+      if (enabled)
+        files.push_back(FileTimes{std::string{path}});
+    }
+
+    /// @brief Appends the files recorded by 'other'.
+    /// Files compiled in parallel are recorded separately, then appended
+    /// in the order of the inputs.
+    /// @param other The times to append
+    void append(PhaseTimes&& other) noexcept
+    {
+      for (auto& file : other.files)
+        files.push_back(std::move(file));
+      other.files.clear();
+    }
+
+    /// @brief Adds a run of a phase to the current file
+    /// @param phase The phase
+    /// @param stats The time spent in the phase
+    void record(Phase phase, const PhaseStats& stats) noexcept;
+
+    /// @brief Returns the recorded files
+    /// @return The recorded files
+    const std::vector<FileTimes>& recorded() const noexcept { return files; }
+
+    /// @brief Returns the time spent in each phase over all the files
+    /// @return The time spent in each phase over all the files
+    std::array<PhaseStats, PHASE_COUNT> total() const noexcept;
+
+    /// @brief Prints a table per file (and the total if there are many files)
+    void print() const noexcept;
+
+    /// @brief Writes the times as a JSON object
+    /// @param path The path of the file to write
+    /// @return False if the file could not be written
+    bool write_json(const char* path) const noexcept;
+  };
+
+  /// @brief RAII scope recording the time spent in a phase
+  /// @code{.cpp}
+  /// {
+  ///   PhaseScope scope{times, Phase::LEX};
+  ///   auto ctx = lng::lex(reporter, content);
+  ///   scope.processed(content.size(), ctx.token_buffer().size());
+  /// }
+  /// @endcode
+  class PhaseScope
+  {
+    /// @brief The times to which to add the phase (or nullptr if disabled
+    ///        or stopped)
+    PhaseTimes* times;
+    /// @brief The phase
+    Phase phase;
+    /// @brief The statistics (start times until the destructor)
+    PhaseStats stats = {};
+
+  public:
+    /// @brief Starts timing a phase
+    /// @param times The times to which to add the phase
+    /// @param phase The phase
+    PhaseScope(PhaseTimes& times, Phase phase) noexcept
+        : times(times.is_enabled() ? &times : nullptr)
+        , phase(phase)
+    {
+      if (this->times == nullptr)
+        return;
+      stats.wall_ns = wall_time_ns();
+      stats.cpu_ns  = cpu_time_ns();
+    }
+
+    PhaseScope(PhaseScope&&)      = delete;
+    PhaseScope(const PhaseScope&) = delete;
+
+    /// @brief Sets the quantity of work done in the phase
+    /// @param bytes The bytes processed
+    /// @param tokens The tokens processed
+    void processed(u64 bytes, u64 tokens = 0) noexcept
+    {
+      stats.bytes  = bytes;
+      stats.tokens = tokens;
+    }
+
+    /// @brief Stops timing the phase (does nothing if already stopped)
+    void stop() noexcept
+    {
+      if (times == nullptr)
+        return;
+      stats.wall_ns = wall_time_ns() - stats.wall_ns;
+      stats.cpu_ns  = cpu_time_ns() - stats.cpu_ns;
+      stats.count   = 1;
+      times->record(phase, stats);
+      times = nullptr;
+    }
+
+    /// @brief Stops timing the phase if 'stop' was not called
+    ~PhaseScope() noexcept { stop(); }
+  };
+} // namespace clt
+
+ADD_REFLECTION_FOR_CONSECUTIVE_ENUM(
+    clt, Phase, MAP_FILE, LEX, REPORT, LUA_HOOK, BACKEND, CACHE);
+
+#endif // !HG_COLTC_PHASE_TIMER
@@ -0,0 +1,244 @@
+/*****************************************************************/ /**
+ * @file   scheduler.cpp
+ * @brief  Implementation of Scheduler and TaskGraph.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include "scheduler.h"
+#include <cstdlib>
+
+namespace clt
+{
+  namespace details
+  {
+    /// @brief The scheduler of the current thread (while it is a worker)
+    static thread_local const Scheduler* CurrentScheduler = nullptr;
+
+    /// @brief Check if the tasks of a graph can all be run
+    /// @param tasks The tasks of the graph
+    /// @return False if the dependencies contain a cycle
+    static bool is_acyclic(std::deque<Task>& tasks) noexcept
+    {
+      // Kahn's algorithm, on the (restored) dependency counters
+      std::vector<Task*> ready;
+      for (auto& task : tasks)
+        if (task.dependencies.load(std::memory_order_relaxed) == 0)
+          ready.push_back(&task);
+      size_t visited = 0;
+      while (!ready.empty())
+      {
+        auto task = ready.back();
+        ready.pop_back();
+        ++visited;
+        for (auto successor : task->successors)
+          if (successor->dependencies.fetch_sub(1, std::memory_order_relaxed) == 1)
+            ready.push_back(successor);
+      }
+      for (auto& task : tasks)
+        task.dependencies.store(0, std::memory_order_relaxed);
+      for (auto& task : tasks)
+        for (auto successor : task.successors)
+          successor->dependencies.fetch_add(1, std::memory_order_relaxed);
+      return visited == tasks.size();
+    }
+  } // namespace details
+
+  void TaskGraph::precede(TaskID before, TaskID after) noexcept
+  {
+    assert_true("Dependencies cannot be added to a running graph!", !started);
+    assert_true(
+        "Invalid task identifier!", before < tasks.size(), after < tasks.size());
+    tasks[before].successors.push_back(&tasks[after]);
+    tasks[after].dependencies.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void TaskContext::spawn_task(
+      const char* name, std::function<void(TaskContext&)>&& fn) noexcept
+  {
+    auto& graph = *task.graph;
+    details::Task* child;
+    {
+      std::lock_guard lock{graph.spawn_mutex};
+      child = &graph.spawned.emplace_back(name, std::move(fn), &graph);
+    }
+    child->parent = &task;
+    // The running task is not complete: the counters cannot reach 0
+    task.unfinished.fetch_add(1, std::memory_order_relaxed);
+    graph.remaining.fetch_add(1, std::memory_order_relaxed);
+    scheduler.push(child, worker_index);
+  }
+
+  Scheduler::Scheduler(u32 workers) noexcept
+      : queues(std::make_unique<WorkerQueue[]>(workers))
+      , workers(workers)
+  {
+    assert_true("A Scheduler requires at least 1 worker!", workers != 0);
+    threads.reserve(workers - 1);
+    for (u32 i = 1; i < workers; i++)
+      threads.emplace_back([this, i]() { worker_loop(i); });
+  }
+
+  Scheduler::~Scheduler() noexcept
+  {
+    {
+      std::lock_guard lock{sleep_mutex};
+      stopping = true;
+    }
+    sleep_cv.notify_all();
+    for (auto& thread : threads)
+      thread.join();
+  }
+
+  void Scheduler::run(TaskGraph& graph) noexcept
+  {
+    COLT_TRACE_FN();
+    assert_true("A TaskGraph can only be run once!", !graph.started);
+    assert_true(
+        "Scheduler::run cannot be called from a task!",
+        details::CurrentScheduler == nullptr);
+    graph.started = true;
+    if (graph.tasks.empty())
+      return;
+    // Checked on Release too: a cycle would make 'run' wait forever
+    if (!details::is_acyclic(graph.tasks))
+    {
+      print_error("The dependencies of a TaskGraph cannot contain cycles!");
+      std::abort();
+    }
+
+    graph.remaining.store(
+        static_cast<u32>(graph.tasks.size()), std::memory_order_relaxed);
+    // The roots are collected first: once pushed, they can complete and
+    // bring the counters of their successors to 0
+    std::vector<details::Task*> roots;
+    for (auto& task : graph.tasks)
+      if (task.dependencies.load(std::memory_order_relaxed) == 0)
+        roots.push_back(&task);
+    // The roots are spread over the workers, which avoids stealing them
+    for (size_t i = 0; i < roots.size(); i++)
+      push(roots[i], static_cast<u32>(i % workers));
+
+    details::CurrentScheduler = this;
+    while (graph.remaining.load(std::memory_order_acquire) != 0)
+    {
+      if (auto task = find_task(0); task != nullptr)
+      {
+        execute(task, 0);
+        continue;
+      }
+      std::unique_lock lock{sleep_mutex};
+      sleep_cv.wait(
+          lock,
+          [&]()
+          {
+            return queued.load(std::memory_order_relaxed) != 0
+                   || graph.remaining.load(std::memory_order_acquire) == 0;
+          });
+    }
+    details::CurrentScheduler = nullptr;
+  }
+
+  void Scheduler::worker_loop(u32 worker) noexcept
+  {
+    details::CurrentScheduler = this;
+    while (true)
+    {
+      if (auto task = find_task(worker); task != nullptr)
+      {
+        execute(task, worker);
+        continue;
+      }
+      std::unique_lock lock{sleep_mutex};
+      sleep_cv.wait(
+          lock,
+          [&]()
+          { return stopping || queued.load(std::memory_order_relaxed) != 0; });
+      if (stopping)
+        return;
+    }
+  }
+
+  details::Task* Scheduler::find_task(u32 worker) noexcept
+  {
+    if (queued.load(std::memory_order_relaxed) == 0)
+      return nullptr;
+    // The most recent task of the worker, whose data is likely cached
+    {
+      auto& queue = queues[worker];
+      std::lock_guard lock{queue.mutex};
+      if (!queue.tasks.empty())
+      {
+        auto task = queue.tasks.back();
+        queue.tasks.pop_back();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return task;
+      }
+    }
+    // The oldest task of another worker
+    for (u32 i = 1; i < workers; i++)
+    {
+      auto& queue = queues[(worker + i) % workers];
+      std::lock_guard lock{queue.mutex};
+      if (!queue.tasks.empty())
+      {
+        auto task = queue.tasks.front();
+        queue.tasks.pop_front();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return task;
+      }
+    }
+    return nullptr;
+  }
+
+  void Scheduler::push(details::Task* task, u32 worker) noexcept
+  {
+    {
+      auto& queue = queues[worker];
+      std::lock_guard lock{queue.mutex};
+      queue.tasks.push_back(task);
+    }
+    queued.fetch_add(1, std::memory_order_relaxed);
+    // Synchronizes with the predicate of sleeping workers: either they
+    // see the new task, or they are notified
+    {
+      std::lock_guard lock{sleep_mutex};
+    }
+    sleep_cv.notify_one();
+  }
+
+  void Scheduler::execute(details::Task* task, u32 worker) noexcept
+  {
+    if (!task->graph->is_cancelled())
+    {
+      COLT_TRACE_ZONE(task->name);
+      TaskContext ctx{*this, *task, worker};
+      task->fn(ctx);
+    }
+    // Frees the captures of the task as soon as possible
+    task->fn = nullptr;
+    finish(task, worker);
+  }
+
+  void Scheduler::finish(details::Task* task, u32 worker) noexcept
+  {
+    // Completing the last child of a task that returned completes it
+    while (task != nullptr
+           && task->unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      for (auto successor : task->successors)
+        if (successor->dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+          push(successor, worker);
+      auto parent = task->parent;
+      // The graph can be destroyed as soon as 'remaining' reaches 0
+      if (task->graph->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        {
+          std::lock_guard lock{sleep_mutex};
+        }
+        sleep_cv.notify_all();
+      }
+      task = parent;
+    }
+  }
+} // namespace clt
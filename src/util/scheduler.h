@@ -0,0 +1,260 @@
+/*****************************************************************/ /**
+ * @file   scheduler.h
+ * @brief  Contains the work-stealing Scheduler that runs the TaskGraphs
+ *         of the compiler.
+ * A TaskGraph is a set of named tasks and of dependencies between them.
+ * A running task can spawn children (a task per top-level declaration
+ * of a file, per function...): a task is complete once it returned and
+ * all its children are complete, and only then are its successors run.
+ *
+ * Each worker owns a deque of ready tasks: it pushes and pops at the
+ * back (the most recent task, whose data is hot in the cache), while
+ * idle workers steal from the front (the oldest task, which usually
+ * represents the largest amount of work). This keeps all the workers
+ * busy even when the sizes of the tasks are very uneven.
+ *
+ * Cancellation is cooperative: once a graph is cancelled, the tasks that
+ * did not start are skipped, and running tasks can poll
+ * 'TaskContext::is_cancelled' to return early.
+ * Each task is traced (COLT_TRACE_ZONE) under its name.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_COLTC_SCHEDULER
+#define HG_COLTC_SCHEDULER
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace clt
+{
+  class Scheduler;
+  class TaskGraph;
+  class TaskContext;
+
+  /// @brief The identifier of a task of a TaskGraph
+  using TaskID = u32;
+
+  /// @brief Returns the number of workers to use for 'tasks' tasks
+  /// @param jobs The requested number of workers (0 for the number of
+  ///             hardware threads)
+  /// @param tasks The number of tasks
+  /// @return The number of workers (at least 1, at most 'tasks')
+  inline u32 worker_count(u32 jobs, size_t tasks) noexcept
+  {
+    if (jobs == 0)
+      jobs = std::max(std::thread::hardware_concurrency(), 1U);
+    return static_cast<u32>(std::clamp<size_t>(tasks, 1, jobs));
+  }
+
+  namespace details
+  {
+    /// @brief A task of a TaskGraph
+    struct Task
+    {
+      /// @brief The name of the task (traced, must outlive the trace)
+      const char* name;
+      /// @brief The work of the task
+      std::function<void(TaskContext&)> fn;
+      /// @brief The graph owning the task
+      TaskGraph* graph;
+      /// @brief The task that spawned this task (or nullptr)
+      Task* parent = nullptr;
+      /// @brief The tasks that depend on this task
+      std::vector<Task*> successors = {};
+      /// @brief The number of predecessors that are not complete
+      std::atomic<u32> dependencies = 0;
+      /// @brief 1 until the task returned, + the incomplete children
+      std::atomic<u32> unfinished = 1;
+
+      Task(const char* name, std::function<void(TaskContext&)>&& fn,
+          TaskGraph* graph) noexcept
+          : name(name)
+          , fn(std::move(fn))
+          , graph(graph)
+      {
+      }
+    };
+  } // namespace details
+
+  /// @brief A set of tasks and of dependencies between them.
+  /// Tasks and dependencies can only be added before the graph is run,
+  /// and a graph can only be run once.
+  class TaskGraph
+  {
+    /// @brief The tasks added by 'add' (a deque keeps their addresses)
+    std::deque<details::Task> tasks;
+    /// @brief Protects 'spawned'
+    std::mutex spawn_mutex;
+    /// @brief The tasks spawned by running tasks
+    std::deque<details::Task> spawned;
+    /// @brief The number of tasks that are not complete
+    std::atomic<u32> remaining = 0;
+    /// @brief True if the graph was cancelled
+    std::atomic<bool> cancelled = false;
+    /// @brief True once the graph was run
+    bool started = false;
+
+    friend class Scheduler;
+    friend class TaskContext;
+
+  public:
+    TaskGraph() noexcept = default;
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    template<typename Fn>
+    /// @brief Adds a task to the graph
+    /// @param name The name of the task (a string literal)
+    /// @param fn The work of the task, called with a TaskContext&
+    /// @return The identifier of the task
+    TaskID add(const char* name, Fn&& fn) noexcept
+    {
+      assert_true("Tasks cannot be added to a running graph!", !started);
+      tasks.emplace_back(name, std::forward<Fn>(fn), this);
+      return static_cast<TaskID>(tasks.size() - 1);
+    }
+
+    /// @brief Makes 'after' wait for the completion of 'before'
+    /// @param before The task that must be complete first
+    /// @param after The task that depends on 'before'
+    void precede(TaskID before, TaskID after) noexcept;
+
+    /// @brief Skips the tasks that did not start yet (thread-safe)
+    void cancel() noexcept { cancelled.store(true, std::memory_order_relaxed); }
+
+    /// @brief Check if the graph was cancelled (thread-safe)
+    /// @return True if 'cancel' was called
+    bool is_cancelled() const noexcept
+    {
+      return cancelled.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Returns the number of tasks added through 'add'
+    /// @return The number of tasks of the graph
+    size_t size() const noexcept { return tasks.size(); }
+  };
+
+  /// @brief The context passed to a running task
+  class TaskContext
+  {
+    /// @brief The scheduler running the task
+    Scheduler& scheduler;
+    /// @brief The running task
+    details::Task& task;
+    /// @brief The worker running the task
+    u32 worker_index;
+
+    friend class Scheduler;
+
+    TaskContext(Scheduler& scheduler, details::Task& task, u32 worker) noexcept
+        : scheduler(scheduler)
+        , task(task)
+        , worker_index(worker)
+    {
+    }
+
+    /// @brief Schedules a child of the running task
+    void spawn_task(
+        const char* name, std::function<void(TaskContext&)>&& fn) noexcept;
+
+  public:
+    /// @brief Returns the worker running the task.
+    /// A worker runs a single task at a time: the index can be used to
+    /// access per-worker state (reporter shards, Lua states...).
+    /// @return The index of the worker, in [0, Scheduler::worker_count())
+    u32 worker() const noexcept { return worker_index; }
+
+    /// @brief Check if the graph of the task was cancelled
+    /// @return True if the task should return as soon as possible
+    bool is_cancelled() const noexcept { return task.graph->is_cancelled(); }
+
+    /// @brief Cancels the graph of the task
+    void cancel() const noexcept { task.graph->cancel(); }
+
+    template<typename Fn>
+    /// @brief Spawns a child of the running task.
+    /// The running task is only complete once all its children are.
+    /// @param name The name of the child (a string literal)
+    /// @param fn The work of the child, called with a TaskContext&
+    void spawn(const char* name, Fn&& fn) noexcept
+    {
+      spawn_task(name, std::forward<Fn>(fn));
+    }
+  };
+
+  /// @brief Work-stealing scheduler, whose workers are shared by all the
+  ///        phases of the compiler.
+  /// The thread calling 'run' is worker 0, and 'workers - 1' threads are
+  /// created by the constructor: with a single worker, no thread is
+  /// created and all the tasks run on the thread calling 'run'.
+  class Scheduler
+  {
+    /// @brief The ready tasks of a worker
+    struct alignas(64) WorkerQueue
+    {
+      /// @brief Protects 'tasks'
+      std::mutex mutex;
+      /// @brief The owner uses the back, thieves the front
+      std::deque<details::Task*> tasks;
+    };
+
+    /// @brief The queues of the workers
+    std::unique_ptr<WorkerQueue[]> queues;
+    /// @brief The threads of workers [1, workers)
+    std::vector<std::thread> threads;
+    /// @brief The number of workers
+    u32 workers;
+    /// @brief The number of tasks in all the queues
+    std::atomic<u32> queued = 0;
+    /// @brief True once the threads must exit
+    bool stopping = false;
+    /// @brief Protects 'stopping' and the sleep of the workers
+    std::mutex sleep_mutex;
+    /// @brief Notified when a task is queued or a graph is complete
+    std::condition_variable sleep_cv;
+
+    friend class TaskContext;
+
+    /// @brief The loop of the threads of the workers
+    void worker_loop(u32 worker) noexcept;
+    /// @brief Pops a task of 'worker', or steals one from another worker
+    details::Task* find_task(u32 worker) noexcept;
+    /// @brief Queues a ready task on the queue of 'worker'
+    void push(details::Task* task, u32 worker) noexcept;
+    /// @brief Runs a task (if its graph was not cancelled) then finishes it
+    void execute(details::Task* task, u32 worker) noexcept;
+    /// @brief Called when a task or one of its children completes
+    void finish(details::Task* task, u32 worker) noexcept;
+
+  public:
+    /// @brief Creates a scheduler
+    /// @param workers The number of workers (at least 1)
+    Scheduler(u32 workers) noexcept;
+    /// @brief Joins the threads of the workers
+    ~Scheduler() noexcept;
+
+    Scheduler(const Scheduler&)            = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    /// @brief Returns the number of workers
+    /// @return The number of workers (including the thread calling 'run')
+    u32 worker_count() const noexcept { return workers; }
+
+    /// @brief Runs a graph, and returns once all its tasks are complete.
+    /// 'run' must not be called from a task: use 'TaskContext::spawn'.
+    /// The process is aborted if the dependencies of the graph contain a cycle.
+    /// @param graph The graph to run (which must not contain cycles)
+    void run(TaskGraph& graph) noexcept;
+  };
+} // namespace clt
+
+#endif // !HG_COLTC_SCHEDULER
@@ -0,0 +1,200 @@
+/*****************************************************************/ /**
+ * @file   trace_file.cpp
+ * @brief  Implementation of FileTracer.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include "trace_file.h"
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <frontend/err/machine_reporter.h>
+
+namespace clt
+{
+  namespace details
+  {
+    /// @brief A zone recorded by FileTracer
+    struct TraceEvent
+    {
+      /// @brief The name of the zone
+      const char* name;
+      /// @brief The start of the zone
+      u64 start_ns;
+      /// @brief The end of the zone
+      u64 end_ns;
+    };
+
+    /// @brief A fixed-size part of the buffer of a thread.
+    /// Only the owning thread writes to a chunk: 'size' and 'next' are
+    /// published (release) after the events they make visible.
+    struct TraceChunk
+    {
+      /// @brief The number of events of a chunk
+      static constexpr size_t CAPACITY = 4096;
+
+      /// @brief The events
+      std::array<TraceEvent, CAPACITY> events;
+      /// @brief The number of events written
+      std::atomic<size_t> size = 0;
+      /// @brief The next chunk (or nullptr)
+      std::atomic<TraceChunk*> next = nullptr;
+    };
+
+    /// @brief The buffer of a thread
+    struct TraceBuffer
+    {
+      /// @brief The identifier of the thread in the trace
+      u32 tid;
+      /// @brief The chunks of the buffer (only accessed by the thread)
+      std::vector<std::unique_ptr<TraceChunk>> chunks;
+      /// @brief The first chunk (owned by 'chunks')
+      const TraceChunk* head;
+      /// @brief The chunk to which to write (owned by 'chunks')
+      TraceChunk* last;
+      /// @brief The number of zones recorded
+      u64 count = 0;
+
+      /// @brief Constructor
+      /// @param tid The identifier of the thread in the trace
+      TraceBuffer(u32 tid)
+          : tid(tid)
+      {
+        chunks.push_back(std::make_unique<TraceChunk>());
+        head = last = chunks.back().get();
+      }
+    };
+
+    /// @brief The buffers of all the threads that recorded a zone
+    struct TraceRegistry
+    {
+      /// @brief Protects 'buffers' (not the content of the buffers)
+      std::mutex lock;
+      /// @brief The buffers (which outlive their threads)
+      std::vector<std::unique_ptr<TraceBuffer>> buffers;
+      /// @brief The number of dropped zones
+      std::atomic<u64> dropped = 0;
+    };
+
+    /// @brief Returns the registry.
+    /// The registry is never destroyed, so that threads still running
+    /// (and 'atexit' handlers) can use it during static destruction.
+    /// @return The registry
+    static TraceRegistry& registry() noexcept
+    {
+      static auto* value = new TraceRegistry();
+      return *value;
+    }
+
+    /// @brief The buffer of the current thread (nullptr if not registered)
+    static thread_local TraceBuffer* LocalBuffer = nullptr;
+
+    /// @brief Returns the buffer of the current thread, registering it
+    /// @return The buffer of the current thread
+    static TraceBuffer& local_buffer() noexcept
+    {
+      if (LocalBuffer != nullptr)
+        return *LocalBuffer;
+      auto& reg = registry();
+      std::scoped_lock guard{reg.lock};
+      reg.buffers.push_back(std::make_unique<TraceBuffer>(
+          static_cast<u32>(reg.buffers.size() + 1)));
+      LocalBuffer = reg.buffers.back().get();
+      return *LocalBuffer;
+    }
+
+    /// @brief Writes nanoseconds as microseconds (the unit of the format)
+    /// @param out The writer
+    /// @param ns The nanoseconds
+    static void write_us(lng::BufferedWriter& out, u64 ns) noexcept
+    {
+      out.write_u64(ns / 1000);
+      out.write('.');
+      const u64 frac = ns % 1000;
+      out.write(static_cast<char>('0' + frac / 100));
+      out.write(static_cast<char>('0' + frac / 10 % 10));
+      out.write(static_cast<char>('0' + frac % 10));
+    }
+  } // namespace details
+
+  u64 FileTracer::now_ns() noexcept
+  {
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count());
+  }
+
+  void FileTracer::record(const char* name, u64 start_ns, u64 end_ns) noexcept
+  {
+    using namespace details;
+    auto& buffer = local_buffer();
+    if (buffer.count == MAX_ZONES_PER_THREAD)
+    {
+      registry().dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    auto* chunk = buffer.last;
+    size_t size = chunk->size.load(std::memory_order_relaxed);
+    if (size == TraceChunk::CAPACITY)
+    {
+      buffer.chunks.push_back(std::make_unique<TraceChunk>());
+      auto* next = buffer.chunks.back().get();
+      chunk->next.store(next, std::memory_order_release);
+      buffer.last = chunk = next;
+      size            = 0;
+    }
+    chunk->events[size] = TraceEvent{name, start_ns, end_ns};
+    chunk->size.store(size + 1, std::memory_order_release);
+    ++buffer.count;
+  }
+
+  u64 FileTracer::dropped() noexcept
+  {
+    return details::registry().dropped.load(std::memory_order_relaxed);
+  }
+
+  bool FileTracer::write(const char* path) noexcept
+  {
+    using namespace details;
+    auto file = std::fopen(path, "wb");
+    if (file == nullptr)
+      return false;
+    {
+      lng::BufferedWriter out{file};
+      out.write("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+      bool first = true;
+      auto& reg  = registry();
+      std::scoped_lock guard{reg.lock};
+      for (auto& buffer : reg.buffers)
+      {
+        for (auto* chunk = buffer->head; chunk != nullptr;
+             chunk = chunk->next.load(std::memory_order_acquire))
+        {
+          const size_t size = chunk->size.load(std::memory_order_acquire);
+          for (size_t i = 0; i < size; i++)
+          {
+            auto& event = chunk->events[i];
+            if (!first)
+              out.write(",\n");
+            first = false;
+            out.write("{\"ph\":\"X\",\"pid\":1,\"tid\":");
+            out.write_u64(buffer->tid);
+            out.write(",\"name\":");
+            out.write_json_string(event.name);
+            out.write(",\"ts\":");
+            write_us(out, event.start_ns);
+            out.write(",\"dur\":");
+            write_us(out, event.end_ns - event.start_ns);
+            out.write('}');
+          }
+        }
+      }
+      out.write("]}\n");
+    }
+    const bool ok = std::ferror(file) == 0;
+    return (std::fclose(file) == 0) && ok;
+  }
+} // namespace clt
@@ -0,0 +1,119 @@
+/*****************************************************************/ /**
+ * @file   trace_file.h
+ * @brief  Contains FileTracer and TraceZone, the backend of the
+ *         COLT_TRACE_BLOCK* and COLT_TRACE_ZONE macros in builds without
+ *         Tracy ('--trace-file').
+ * Tracy requires a connected profiler, which is not available on a
+ * headless machine. The file tracer records the zones of each thread
+ * into its own buffer (recording never takes a lock), and writes them
+ * as a Chrome trace-event JSON file, readable by 'chrome://tracing'
+ * and Perfetto.
+ * When disabled, a TraceZone costs one relaxed load.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_COLTC_TRACE_FILE
+#define HG_COLTC_TRACE_FILE
+
+#include <atomic>
+
+namespace clt
+{
+  /// @brief Process-wide recorder of the zones written to '--trace-file'.
+  /// This class is thread safe.
+  class FileTracer
+  {
+    /// @brief True if the zones are recorded
+    static inline std::atomic<bool> enabled = false;
+
+  public:
+    /// @brief The maximum number of zones recorded per thread.
+    /// Zones past this limit are dropped (and counted).
+    static constexpr u64 MAX_ZONES_PER_THREAD = u64{1} << 20;
+
+    /// @brief Enables or disables the recording of zones.
+    /// Zones that started before enabling are not recorded.
+    /// @param value True to record the zones
+    static void enable(bool value = true) noexcept
+    {
+      enabled.store(value, std::memory_order_relaxed);
+    }
+
+    /// @brief Check if the zones are recorded
+    /// @return True if the zones are recorded
+    static bool is_enabled() noexcept
+    {
+      return enabled.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Returns the current time of the trace
+    /// @return The time in nanoseconds
+    static u64 now_ns() noexcept;
+
+    /// @brief Records a zone of the current thread.
+    /// Only the calling thread writes to its buffer: this never locks,
+    /// except the first time a thread records a zone.
+    /// @param name The name of the zone (must have static storage)
+    /// @param start_ns The start of the zone
+    /// @param end_ns The end of the zone
+    static void record(const char* name, u64 start_ns, u64 end_ns) noexcept;
+
+    /// @brief Returns the number of zones dropped as a buffer was full
+    /// @return The number of dropped zones
+    static u64 dropped() noexcept;
+
+    /// @brief Writes the zones recorded by all the threads as Chrome
+    ///        trace-event JSON.
+    /// Can be called while other threads are recording: zones that
+    /// end after the call are not written.
+    /// @param path The path to the file
+    /// @return False if the file could not be written
+    static bool write(const char* path) noexcept;
+  };
+
+  /// @brief RAII zone recorded by FileTracer (if enabled when created)
+  class TraceZone
+  {
+    /// @brief The name of the zone (nullptr if not recorded)
+    const char* name;
+    /// @brief The start of the zone
+    u64 start_ns = 0;
+
+  public:
+    /// @brief Starts a zone
+    /// @param name The name of the zone (must have static storage)
+    explicit TraceZone(const char* name) noexcept
+        : name(FileTracer::is_enabled() ? name : nullptr)
+    {
+      if (this->name != nullptr)
+        start_ns = FileTracer::now_ns();
+    }
+
+    TraceZone(TraceZone&&)      = delete;
+    TraceZone(const TraceZone&) = delete;
+
+    /// @brief Ends the zone
+    ~TraceZone() noexcept
+    {
+      if (name != nullptr)
+        FileTracer::record(name, start_ns, FileTracer::now_ns());
+    }
+
+    template<typename Fun>
+    /// @brief Helper for COLT_TRACE_BLOCK
+    friend void operator+(const TraceZone&, Fun&& fn) noexcept
+    {
+      fn();
+    }
+
+    template<typename Fun>
+    /// @brief Helper for COLT_TRACE_BLOCK_C
+    friend void operator&(const TraceZone&, Fun&& fn) noexcept
+    {
+      fn();
+    }
+  };
+} // namespace clt
+
+#endif // !HG_COLTC_TRACE_FILE
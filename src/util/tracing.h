@@ -38,6 +38,9 @@ void operator&(const tracy::ScopedZone& timer, Fun&& fn) noexcept
   /// }; // <- do not forget the semicolon!
   /// @endcode
   #define COLT_TRACE_BLOCK_C(name, color) ZoneNamedNC(, name, color, true)& [&]()
+  /// @brief Traces the rest of the scope, under a name only known at run time
+  /// (the name of a task for example)
+  #define COLT_TRACE_ZONE(name) ZoneTransientN(colt_trace_zone_, name, true)
 
   #define COLT_TRACE_EXPR(expr) \
     [&]()                       \
@@ -53,6 +56,13 @@ void operator&(const tracy::ScopedZone& timer, Fun&& fn) noexcept
     }()
 
 #else
+
+  // Without Tracy, the blocks and zones are recorded by FileTracer
+  // ('--trace-file'). Functions and expressions are not: they are too
+  // fine-grained (the lexer would fill the buffer of each thread).
+  // Colors are only meaningful to Tracy: they are evaluated and ignored.
+  #include <util/trace_file.h>
+
   #define COLT_STOP_TRACING() ((void)0)
   /// @brief Traces the current function
   #define COLT_TRACE_FN()
@@ -66,7 +76,7 @@ void operator&(const tracy::ScopedZone& timer, Fun&& fn) noexcept
   ///     lng::print_token(i, value);
   /// }; // <- do not forget the semicolon!
   /// @endcode
-  #define COLT_TRACE_BLOCK(name)
+  #define COLT_TRACE_BLOCK(name) ::clt::TraceZone{name} + [&]()
   /// @brief Traces a block (which is named) (with color, use clt::Color!)
   /// @code{.cpp}
   /// COLT_TRACE_BLOCK_C("print_token", clt::Color::Chartreuse3)
@@ -75,7 +85,12 @@ void operator&(const tracy::ScopedZone& timer, Fun&& fn) noexcept
   ///     lng::print_token(i, value);
   /// }; // <- do not forget the semicolon!
   /// @endcode
-  #define COLT_TRACE_BLOCK_C(name, color)
+  #define COLT_TRACE_BLOCK_C(name, color) \
+    ::clt::TraceZone{((void)(color), name)} & [&]()
+  /// @brief Traces the rest of the scope, under a name only known at run time
+  /// (the name of a task for example, which must outlive the trace)
+  #define COLT_TRACE_ZONE(name) ::clt::TraceZone colt_trace_zone_{name}
+
   #define COLT_TRACE_EXPR(expr)          expr
   #define COLT_TRACE_EXPR_C(expr, color) expr
 #endif // COLT_ENABLE_TRACING
@@ -0,0 +1,84 @@
+#include <includes.h>
+#include <fstream>
+#include <frontend/err/clt_diag_parser.h>
+
+using namespace clt;
+using namespace clt::lng;
+
+/// @brief Writes 'content' to a temporary file
+/// @param name The name of the file
+/// @param content The content of the file
+/// @return The path to the file
+static std::string write_temp(const char* name, std::string_view content)
+{
+  auto path = (std::filesystem::temp_directory_path() / name).string();
+  std::ofstream file{path, std::ios::binary};
+  file.write(content.data(), content.size());
+  return path;
+}
+
+/// @brief Converts a u8StringView to a std::string_view
+static std::string_view to_strv(u8StringView strv)
+{
+  return std::string_view{reinterpret_cast<const char*>(strv.data()), strv.size()};
+}
+
+/// @brief Checks the content of the database written in 'coltc DiagnosticDatabase'
+static void check_database(const DiagnosticDatabase& db)
+{
+  REQUIRE(to_strv(db.lang_abrv()) == "en");
+  REQUIRE(to_strv(db.language()) == "English");
+  REQUIRE(db.count(ReportKind::ERROR) == 2);
+  REQUIRE(db.count(ReportKind::WARNING) == 1);
+  REQUIRE(db.count(ReportKind::MESSAGE) == 0);
+
+  auto error = db.find(ReportKind::ERROR, 12);
+  REQUIRE(error.is_value());
+  REQUIRE(error->arg_count == 2);
+  REQUIRE(to_strv(error->diagnostic) == "Expected {}, found {}!");
+  REQUIRE(to_strv(db.find(ReportKind::ERROR, 1)->diagnostic) == "Invalid character!");
+  REQUIRE(db.find(ReportKind::ERROR, 2).is_none());
+  REQUIRE(db.find(ReportKind::ERROR, 9999).is_none());
+  REQUIRE(db.find(ReportKind::MESSAGE, 1).is_none());
+  REQUIRE(to_strv(db.find(ReportKind::WARNING, 1)->diagnostic) == "Unused!");
+}
+
+TEST_CASE("coltc DiagnosticDatabase")
+{
+  auto text = write_temp(
+      "coltc_test.colt.diag", "COLTCDIAG:en:English\r\n"
+                              "E0001:Invalid character!\r\n"
+                              "\n"
+                              "W0001:Unused!\n"
+                              "E0012:Expected {}, found {}!");
+
+  SECTION("Text")
+  {
+    auto db = DiagnosticDatabase::load(text.c_str());
+    REQUIRE(db.is_value());
+    check_database(*db);
+  }
+  SECTION("Binary")
+  {
+    auto binary = text + "bin";
+    {
+      auto db = DiagnosticDatabase::load(text.c_str());
+      REQUIRE(db.is_value());
+      REQUIRE(db->compile_to(binary.c_str()));
+    }
+    auto db = DiagnosticDatabase::load(binary.c_str());
+    REQUIRE(db.is_value());
+    check_database(*db);
+  }
+  SECTION("Invalid")
+  {
+    using enum DiagnosticDatabase::LoadError;
+    auto header = write_temp("coltc_header.colt.diag", "COLTDIAG:en:English\n");
+    REQUIRE(DiagnosticDatabase::load(header.c_str()).error() == INVALID_HEADER);
+    auto entry = write_temp("coltc_entry.colt.diag", "COLTCDIAG:en:English\nX0001:\n");
+    REQUIRE(DiagnosticDatabase::load(entry.c_str()).error() == INVALID_ENTRY);
+    auto dup = write_temp(
+        "coltc_dup.colt.diag", "COLTCDIAG:en:English\nE0001:A\nE0001:B\n");
+    REQUIRE(DiagnosticDatabase::load(dup.c_str()).error() == DUPLICATE_ENTRY);
+  }
+}
@@ -0,0 +1,57 @@
+#include <includes.h>
+#include <frontend/ir/flat_module.h>
+
+using namespace clt;
+using namespace clt::lng;
+
+TEST_CASE("coltc FlatModule")
+{
+  static const u8 STRINGS[] = {'a', 'b', 'c'};
+  const FlatString NAMES[]  = {{0, 1}, {1, 2}};
+
+  FlatModuleWriter writer;
+  writer.add_section(FlatSectionKind::STRINGS, Span<const u8>{STRINGS, 3});
+  writer.add_section(FlatSectionKind::IDENTIFIERS, Span<const FlatString>{NAMES, 2});
+  auto bytes = std::move(writer).finish();
+  REQUIRE(bytes.size() % FlatHeader::ALIGNMENT == 0);
+
+  auto flat = FlatModule::open(View<u8>{bytes.data(), bytes.size()});
+  REQUIRE(flat.is_value());
+  REQUIRE(flat->sections().size() == 2);
+  auto names = flat->section<FlatString>(FlatSectionKind::IDENTIFIERS);
+  REQUIRE(names.is_value());
+  REQUIRE(names->size() == 2);
+  REQUIRE(names->data()[1].offset == 1);
+  REQUIRE(names->data()[1].size == 2);
+  // The elements are views over the module
+  auto begin = reinterpret_cast<const u8*>(names->data());
+  REQUIRE((begin > bytes.data() && begin < bytes.data() + bytes.size()));
+  REQUIRE(flat->section<u8>(FlatSectionKind::STRINGS)->size() == 3);
+  // Any allocation is aligned enough, even if not to FlatHeader::ALIGNMENT
+  std::vector<u64> storage(bytes.size() / sizeof(u64) + 2);
+  auto copy = reinterpret_cast<u8*>(storage.data());
+  if (reinterpret_cast<uintptr_t>(copy) % FlatHeader::ALIGNMENT == 0)
+    copy += sizeof(u64);
+  std::memcpy(copy, bytes.data(), bytes.size());
+  REQUIRE(FlatModule::open(View<u8>{copy, bytes.size()}).is_value());
+  // Wrong element size and missing section
+  REQUIRE(flat->section<u8>(FlatSectionKind::IDENTIFIERS).is_none());
+  REQUIRE(flat->section<FlatToken>(FlatSectionKind::TOKENS).is_none());
+
+  auto corrupted = bytes;
+  corrupted[0]   = 'X';
+  REQUIRE(
+      FlatModule::open(View<u8>{corrupted.data(), corrupted.size()}).error()
+      == FlatError::INVALID_MAGIC);
+  corrupted = bytes;
+  // Makes the first section point past the end of the module
+  auto table = reinterpret_cast<const FlatHeader*>(bytes.data())->table_offset;
+  auto huge  = std::numeric_limits<u64>::max();
+  std::memcpy(corrupted.data() + table + offsetof(FlatSection, count), &huge, 8);
+  REQUIRE(
+      FlatModule::open(View<u8>{corrupted.data(), corrupted.size()}).error()
+      == FlatError::INVALID_SECTION);
+  REQUIRE(
+      FlatModule::open(View<u8>{bytes.data(), sizeof(FlatHeader) - 1}).error()
+      == FlatError::INVALID_BUFFER);
+}
@@ -0,0 +1,35 @@
+#include <includes.h>
+#include <frontend/lex/lex.h>
+#include <frontend/lex/lex_stats.h>
+#include <frontend/err/composable_reporter.h>
+
+using namespace clt;
+using namespace clt::lng;
+
+TEST_CASE("coltc LexStats")
+{
+  static constexpr std::string_view SOURCE = "var a = a + 10;\nvar b = 'c';\n";
+  auto content =
+      View<u8>{reinterpret_cast<const u8*>(SOURCE.data()), SOURCE.size()};
+  auto reporter = make_error_reporter<SinkReporter>();
+  auto ctx      = lex(*reporter, content);
+  REQUIRE(reporter->error_count() == 0);
+
+  auto stats = LexStats::compute(ctx, SOURCE.size());
+  REQUIRE(stats.bytes == SOURCE.size());
+  REQUIRE(stats.tokens == ctx.token_buffer().size());
+  REQUIRE(stats.lines == ctx.line_buffer().size());
+  REQUIRE(stats.identifiers == 3);
+  REQUIRE(stats.distinct_identifiers == 2);
+  REQUIRE(stats.per_lexeme[static_cast<size_t>(Lexeme::TKN_IDENTIFIER)] == 3);
+  REQUIRE(stats.per_lexeme[static_cast<size_t>(Lexeme::TKN_EOF)] == 1);
+  // Literals: bool, char, int, float, string
+  REQUIRE(stats.literals[1].count == 1);
+  REQUIRE(stats.literals[1].bytes == 3);
+  REQUIRE(stats.literals[2].count == 1);
+  REQUIRE(stats.literals[2].bytes == 2);
+  REQUIRE(stats.literals[3].count == 0);
+  // The tokens are the first array
+  REQUIRE(stats.arrays[0].size == stats.tokens);
+  REQUIRE(stats.arrays[0].capacity >= stats.tokens);
+}
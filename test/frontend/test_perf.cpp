@@ -0,0 +1,96 @@
+#include <includes.h>
+#include <perf_counters.h>
+#include <frontend/lex/lex.h>
+#include <frontend/err/composable_reporter.h>
+#include <frontend/err/machine_reporter.h>
+
+using namespace clt;
+using namespace clt::lng;
+using namespace clt::test;
+
+/// @brief Returns a source containing 'count' copies of a line using
+///        most kinds of tokens
+static std::string make_source(u32 count)
+{
+  static constexpr std::string_view LINE =
+      "var value_42 = 0x1F + 3.14 * call(\"str\\n\", 'c') >= 10; // comment\n";
+  std::string source;
+  source.reserve(LINE.size() * count);
+  for (u32 i = 0; i < count; i++)
+    source += LINE;
+  return source;
+}
+
+TEST_CASE("coltc lexer counters", "[.][benchmark]")
+{
+  auto source  = make_source(2048);
+  auto content = View<u8>{reinterpret_cast<const u8*>(source.data()), source.size()};
+  auto reporter = make_error_reporter<SinkReporter>();
+  const u64 tokens = lex(*reporter, content).token_buffer().size();
+
+  perf_benchmark(
+      fmt::format("lex ({} KiB)", source.size() / 1024),
+      PerfWork{source.size(), tokens, "token"},
+      [&] { return lex(*reporter, content).token_buffer().size(); });
+}
+
+TEST_CASE("coltc reporter counters", "[.][benchmark]")
+{
+  static constexpr u32 REPORTS = 1024;
+  auto source  = make_source(REPORTS);
+  auto content = View<u8>{reinterpret_cast<const u8*>(source.data()), source.size()};
+  auto info    = [&](u32 i)
+  {
+    const size_t line_size = source.size() / REPORTS;
+    auto line = u8StringView{
+        reinterpret_cast<const Char8*>(source.data()) + i * line_size,
+        line_size - 1};
+    auto expr = u8StringView{line.data() + 4, 8};
+    return SourceInfo{i + 1, expr, line};
+  };
+
+  std::FILE* file = std::tmpfile();
+  REQUIRE(file != nullptr);
+  auto run = [&]<typename Rep>(Rep& reporter)
+  {
+    reporter.set_file(SourceFile{"bench.ct", content});
+    for (u32 i = 0; i < REPORTS; i++)
+      reporter.error("unused variable"_UTF8, info(i), ReportNumber{42});
+    return reporter.error_count();
+  };
+  perf_benchmark(
+      "JSONLinesReporter", PerfWork{0, REPORTS, "report"},
+      [&]
+      {
+        std::rewind(file);
+        auto reporter = make_error_reporter<JSONLinesReporter>(file);
+        return run(*reporter);
+      });
+  perf_benchmark(
+      "SARIFReporter", PerfWork{0, REPORTS, "report"},
+      [&]
+      {
+        std::rewind(file);
+        auto reporter = make_error_reporter<SARIFReporter>(file);
+        return run(*reporter);
+      });
+  std::fclose(file);
+}
+
+TEST_CASE("coltc PerfCounters")
+{
+  PerfCounters counters;
+  auto counts = counters.measure(4, [] { return 42; });
+  // Unavailable counters are None, and are never reported as zero
+  for (auto& count : counts)
+    REQUIRE((count.is_none() || counters.is_available()));
+  auto text = format_counts(
+      {None, None, None, None}, 1, PerfWork{100, 10, "token"});
+  REQUIRE(text == "hardware counters unavailable");
+  PerfCounts known = {None, None, None, None};
+  known[0] = u64{1000};
+  known[1] = u64{2000};
+  known[2] = u64{5};
+  text = format_counts(known, 10, PerfWork{100, 10, "token"});
+  REQUIRE(text == "1.000 cycles/byte, IPC 2.00, 0.0500 branch-misses/token");
+}
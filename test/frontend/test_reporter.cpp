@@ -0,0 +1,261 @@
+#include <includes.h>
+#include <thread>
+#include <frontend/err/concurrent_reporter.h>
+#include <frontend/err/machine_reporter.h>
+#include <frontend/err/composable_reporter.h>
+
+using namespace clt;
+using namespace clt::lng;
+
+/// @brief Saves all the reports it receives as strings
+struct RecordReporter
+{
+  std::vector<std::string>* output;
+
+  RecordReporter(std::vector<std::string>* output) noexcept
+      : output(output)
+  {
+  }
+
+  void save(char kind, u8StringView str, const Option<SourceInfo>& info) noexcept
+  {
+    output->push_back(fmt::format(
+        "{}:{}:{}", kind,
+        std::string_view{reinterpret_cast<const char*>(str.data()), str.size()},
+        info.is_value() ? info->line_begin : 0));
+  }
+
+  void message(
+      u8StringView str, const Option<SourceInfo>& info,
+      const Option<ReportNumber>&) noexcept
+  {
+    save('M', str, info);
+  }
+
+  void warn(
+      u8StringView str, const Option<SourceInfo>& info,
+      const Option<ReportNumber>&) noexcept
+  {
+    save('W', str, info);
+  }
+
+  void error(
+      u8StringView str, const Option<SourceInfo>& info,
+      const Option<ReportNumber>&) noexcept
+  {
+    save('E', str, info);
+  }
+};
+
+/// @brief Reports diagnostics for 'FILE_COUNT' files using 'workers' threads
+/// @param workers The number of threads to use
+/// @return The merged output
+static std::vector<std::string> report_with(u32 workers)
+{
+  static constexpr u32 FILE_COUNT = 16;
+  static const char SOURCE[]        = "abcdefgh\nijklmnop\n";
+  auto content = View<u8>{reinterpret_cast<const u8*>(SOURCE), sizeof(SOURCE) - 1};
+
+  std::vector<std::string> output;
+  {
+    ConcurrentReporter<RecordReporter> reporter{workers, &output};
+    std::vector<std::thread> threads;
+    for (u32 worker = 0; worker < workers; worker++)
+    {
+      threads.emplace_back(
+          [&, worker]()
+          {
+            // Files are distributed in reverse to shuffle the generation order
+            for (u32 file = FILE_COUNT - 1 - worker; file < FILE_COUNT;
+                 file -= workers)
+            {
+              reporter.begin_file(worker, file, content);
+              auto& rep = reporter.shard(worker);
+              auto first =
+                  u8StringView{reinterpret_cast<const Char8*>(SOURCE), 8};
+              auto second =
+                  u8StringView{reinterpret_cast<const Char8*>(SOURCE) + 9, 8};
+              // Second line is reported before the first one
+              rep.error(
+                  "second"_UTF8,
+                  SourceInfo{2, u8StringView{second.data() + 2, 1}, second});
+              rep.warn(
+                  "first"_UTF8, SourceInfo{1, u8StringView{first.data(), 1}, first});
+              rep.message("after first"_UTF8);
+            }
+          });
+    }
+    for (auto& i : threads)
+      i.join();
+    REQUIRE(reporter.error_count() == FILE_COUNT);
+    REQUIRE(reporter.warn_count() == FILE_COUNT);
+    REQUIRE(reporter.message_count() == FILE_COUNT);
+  }
+  return output;
+}
+
+TEST_CASE("coltc ConcurrentReporter")
+{
+  auto single = report_with(1);
+  REQUIRE(single.size() == 16 * 3);
+  REQUIRE(single[0] == "W:first:1");
+  REQUIRE(single[1] == "M:after first:0");
+  REQUIRE(single[2] == "E:second:2");
+
+  for (u32 workers : {2, 3, 4, 7})
+    REQUIRE(report_with(workers) == single);
+}
+
+/// @brief Returns everything written to 'file'
+/// @param file The file (opened with tmpfile)
+/// @return The content of the file
+static std::string read_all(std::FILE* file)
+{
+  std::string result;
+  std::rewind(file);
+  char buffer[256];
+  while (size_t size = std::fread(buffer, 1, sizeof(buffer), file))
+    result.append(buffer, size);
+  return result;
+}
+
+TEST_CASE("coltc JSONLinesReporter")
+{
+  static const char SOURCE[] = "let a = \"b\n\";\n";
+  auto content  = View<u8>{reinterpret_cast<const u8*>(SOURCE), sizeof(SOURCE) - 1};
+  auto line     = u8StringView{reinterpret_cast<const Char8*>(SOURCE), 11};
+  auto expr     = u8StringView{reinterpret_cast<const Char8*>(SOURCE) + 8, 2};
+  auto multi    = u8StringView{reinterpret_cast<const Char8*>(SOURCE), 13};
+  auto str_expr = u8StringView{reinterpret_cast<const Char8*>(SOURCE) + 8, 4};
+
+  std::FILE* file = std::tmpfile();
+  REQUIRE(file != nullptr);
+  {
+    auto reporter = make_error_reporter<JSONLinesReporter>(file);
+    reporter->set_file(SourceFile{"a.ct", content});
+    reporter->error("unterminated"_UTF8, SourceInfo{1, expr, line}, ReportNumber{3});
+    reporter->warn("multi"_UTF8, SourceInfo{1, 2, str_expr, multi});
+    reporter->message("done"_UTF8);
+  }
+  auto output = read_all(file);
+  std::fclose(file);
+
+  REQUIRE(
+      output
+      == "{\"id\":\"E0003\",\"severity\":\"error\",\"file\":\"a.ct\",\"offset\":8,"
+         "\"length\":2,\"line\":1,\"column\":9,\"end_line\":1,\"end_column\":11,"
+         "\"message\":\"unterminated\",\"expr\":\"\\\"b\"}\n"
+         "{\"id\":null,\"severity\":\"warning\",\"file\":\"a.ct\",\"offset\":8,"
+         "\"length\":4,\"line\":1,\"column\":9,\"end_line\":2,\"end_column\":2,"
+         "\"message\":\"multi\",\"expr\":\"\\\"b\\n\\\"\"}\n"
+         "{\"id\":null,\"severity\":\"message\",\"file\":\"a.ct\","
+         "\"message\":\"done\"}\n");
+}
+
+TEST_CASE("coltc SARIF uri")
+{
+  REQUIRE(lng::details::path_to_uri("src/a.ct") == "src/a.ct");
+  REQUIRE(lng::details::path_to_uri("my dir/100%.ct") == "my%20dir/100%25.ct");
+  REQUIRE(lng::details::path_to_uri("\xC3\xA9.ct") == "%C3%A9.ct");
+#ifdef COLT_WINDOWS
+  REQUIRE(lng::details::path_to_uri("C:\\src\\a.ct") == "file:///C:/src/a.ct");
+#else
+  REQUIRE(lng::details::path_to_uri("/src/a#1.ct") == "file:///src/a%231.ct");
+#endif // COLT_WINDOWS
+}
+
+TEST_CASE("coltc ConcurrentReporter file aware")
+{
+  static const char SOURCE[] = "abc\n";
+  auto content = View<u8>{reinterpret_cast<const u8*>(SOURCE), sizeof(SOURCE) - 1};
+
+  std::FILE* file = std::tmpfile();
+  REQUIRE(file != nullptr);
+  {
+    ConcurrentReporter<JSONLinesReporter> reporter{2, file};
+    reporter.begin_file(1, 3, content, "d.ct");
+    reporter.shard(1).message("in d"_UTF8);
+    // Files without reports are skipped
+    reporter.begin_file(0, 0, content, "a.ct");
+    reporter.begin_file(0, 1, content, "b.ct");
+    reporter.shard(0).message("in b"_UTF8);
+  }
+  auto output = read_all(file);
+  std::fclose(file);
+
+  REQUIRE(
+      output
+      == "{\"id\":null,\"severity\":\"message\",\"file\":\"b.ct\","
+         "\"message\":\"in b\"}\n"
+         "{\"id\":null,\"severity\":\"message\",\"file\":\"d.ct\","
+         "\"message\":\"in d\"}\n");
+}
+
+TEST_CASE("coltc DedupReporter")
+{
+  static const char SOURCE[] = "\x01\x02\x03\n\x04";
+  auto line  = u8StringView{reinterpret_cast<const Char8*>(SOURCE), 3};
+  auto multi = u8StringView{reinterpret_cast<const Char8*>(SOURCE), 5};
+
+  std::vector<std::string> output;
+  {
+    lng::details::ToErrorReporter<DedupReporter<RecordReporter>> reporter{1u, &output};
+    for (u32 i = 0; i < 3; i++)
+      reporter.error(
+          "Invalid character!"_UTF8,
+          SourceInfo{1, u8StringView{line.data() + i, 1}, line});
+    // Different location class
+    reporter.error("Invalid character!"_UTF8, SourceInfo{1, 2, multi, multi});
+    // Numbers and quoted text are ignored
+    reporter.warn("Unknown escape '\\q' at 10"_UTF8);
+    reporter.warn("Unknown escape '\\z' at 200"_UTF8);
+    reporter.warn("Unknown escape at 200"_UTF8);
+    // An apostrophe does not hide the rest of the message
+    reporter.message("Can't open 'a'"_UTF8);
+    reporter.message("Can't read 'a'"_UTF8);
+    reporter.message("Can't read 'b'"_UTF8);
+    // Every report is still counted
+    REQUIRE(reporter.error_count() == 4);
+    REQUIRE(reporter.warn_count() == 3);
+    REQUIRE(reporter.message_count() == 3);
+    // The summaries are forwarded by 'flush'
+    REQUIRE(output.size() == 6);
+    reporter.flush();
+  }
+  REQUIRE(
+      output
+      == std::vector<std::string>{
+          "E:Invalid character!:1", "E:Invalid character!:1",
+          "W:Unknown escape '\\q' at 10:0", "W:Unknown escape at 200:0",
+          "M:Can't open 'a':0", "M:Can't read 'a':0",
+          "E:... 2 more like this: Invalid character!:0",
+          "W:... 1 more like this: Unknown escape '\\q' at 10:0",
+          "M:... 1 more like this: Can't read 'a':0"});
+}
+
+/// @brief Counts the calls to 'flush'
+struct FlushReporter : public RecordReporter
+{
+  u32 flushed = 0;
+
+  using RecordReporter::RecordReporter;
+
+  void flush() noexcept { flushed++; }
+};
+
+TEST_CASE("coltc ConcurrentReporter flush")
+{
+  static const char SOURCE[] = "abc\n";
+  auto content = View<u8>{reinterpret_cast<const u8*>(SOURCE), sizeof(SOURCE) - 1};
+
+  std::vector<std::string> output;
+  ConcurrentReporter<FlushReporter> reporter{2, &output};
+  // The wrapped reporter is flushed even without reports
+  reporter.flush();
+  REQUIRE(reporter.flushed == 1);
+  reporter.begin_file(1, 0, content);
+  reporter.shard(1).message("in a"_UTF8);
+  reporter.flush();
+  REQUIRE(reporter.flushed == 2);
+  REQUIRE(output == std::vector<std::string>{"M:in a:0"});
+}
@@ -0,0 +1,152 @@
+/*****************************************************************/ /**
+ * @file   perf_counters.cpp
+ * @brief  Implementation of PerfCounters.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#include <includes.h>
+#include "perf_counters.h"
+
+#ifdef __linux__
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif // __linux__
+
+namespace clt::test
+{
+#ifdef __linux__
+  namespace details
+  {
+    /// @brief The type and configuration of each event
+    static constexpr std::array<std::pair<u32, u64>, PERF_EVENT_COUNT> EVENTS = {{
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE,
+         PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+             | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    }};
+
+    /// @brief Opens a disabled counter of the current thread (user space only)
+    /// @param type The type of the event
+    /// @param config The configuration of the event
+    /// @return The file descriptor or -1
+    static int open_event(u32 type, u64 config) noexcept
+    {
+      perf_event_attr attr = {};
+      attr.size            = sizeof(attr);
+      attr.type            = type;
+      attr.config          = config;
+      attr.disabled        = 1;
+      attr.exclude_kernel  = 1;
+      attr.exclude_hv      = 1;
+      attr.read_format =
+          PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+  } // namespace details
+
+  PerfCounters::PerfCounters() noexcept
+  {
+    for (size_t i = 0; i < PERF_EVENT_COUNT; i++)
+      fds[i] = details::open_event(
+          details::EVENTS[i].first, details::EVENTS[i].second);
+  }
+
+  PerfCounters::~PerfCounters() noexcept
+  {
+    for (auto fd : fds)
+      if (fd != -1)
+        close(fd);
+  }
+
+  void PerfCounters::start() noexcept
+  {
+    for (auto fd : fds)
+    {
+      if (fd == -1)
+        continue;
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  PerfCounts PerfCounters::stop() noexcept
+  {
+    for (auto fd : fds)
+      if (fd != -1)
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+    PerfCounts counts = {None, None, None, None};
+    for (size_t i = 0; i < PERF_EVENT_COUNT; i++)
+    {
+      // value, time enabled, time running
+      u64 values[3];
+      if (fds[i] == -1
+          || read(fds[i], values, sizeof(values)) != sizeof(values)
+          || values[2] == 0)
+        continue;
+      // Scales the value if the counter was multiplexed
+      counts[i] = static_cast<u64>(
+          static_cast<double>(values[0]) * values[1] / values[2]);
+    }
+    return counts;
+  }
+#else
+  PerfCounters::PerfCounters() noexcept
+  {
+    fds.fill(-1);
+  }
+
+  PerfCounters::~PerfCounters() noexcept = default;
+
+  void PerfCounters::start() noexcept {}
+
+  PerfCounts PerfCounters::stop() noexcept
+  {
+    return PerfCounts{None, None, None, None};
+  }
+#endif // __linux__
+
+  bool PerfCounters::is_available() const noexcept
+  {
+    for (auto fd : fds)
+      if (fd != -1)
+        return true;
+    return false;
+  }
+
+  std::string format_counts(
+      const PerfCounts& counts, u32 runs, const PerfWork& work)
+  {
+    auto get = [&](PerfEvent event) -> const Option<u64>&
+    { return counts[static_cast<size_t>(event)]; };
+    auto per = [&](u64 value, u64 quantity)
+    { return static_cast<double>(value) / (static_cast<double>(quantity) * runs); };
+
+    std::string result;
+    auto& cycles       = get(PerfEvent::CYCLES);
+    auto& instructions = get(PerfEvent::INSTRUCTIONS);
+    if (cycles.is_value() && work.bytes != 0)
+      result += fmt::format("{:.3f} cycles/byte, ", per(*cycles, work.bytes));
+    if (cycles.is_value() && instructions.is_value() && *cycles != 0)
+      result += fmt::format(
+          "IPC {:.2f}, ", static_cast<double>(*instructions) / *cycles);
+    if (auto& misses = get(PerfEvent::BRANCH_MISSES);
+        misses.is_value() && work.items != 0)
+      result += fmt::format(
+          "{:.4f} branch-misses/{}, ", per(*misses, work.items), work.item_name);
+    if (auto& misses = get(PerfEvent::L1D_MISSES);
+        misses.is_value() && work.items != 0)
+      result += fmt::format(
+          "{:.4f} L1D-misses/{}, ", per(*misses, work.items), work.item_name);
+
+    if (result.empty())
+      return "hardware counters unavailable";
+    result.resize(result.size() - 2);
+    return result;
+  }
+} // namespace clt::test
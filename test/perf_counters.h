@@ -0,0 +1,133 @@
+/*****************************************************************/ /**
+ * @file   perf_counters.h
+ * @brief  Contains the hardware performance counter harness used by
+ *         the '[benchmark]' tests.
+ * Wall-clock benchmarks cannot tell whether a change reduced branch
+ * or cache misses: 'perf_benchmark' runs a Catch2 BENCHMARK, then
+ * runs the same function under the cycles, instructions, branch-misses
+ * and L1D read misses counters (through 'perf_event_open') and prints
+ * cycles/byte, IPC and misses per item.
+ * The counters are only supported on Linux. When they are unavailable
+ * (other OS, containers, perf_event_paranoid), the benchmark still runs
+ * and the report says so.
+ *
+ * @author RPC
+ * @date   October 2026
+ *********************************************************************/
+#ifndef HG_TEST_PERF_COUNTERS
+#define HG_TEST_PERF_COUNTERS
+
+#include <array>
+#include <string>
+#include <string_view>
+
+namespace clt::test
+{
+  /// @brief The hardware events that are counted
+  enum class PerfEvent : u8
+  {
+    /// @brief CPU cycles
+    CYCLES,
+    /// @brief Retired instructions
+    INSTRUCTIONS,
+    /// @brief Mispredicted branches
+    BRANCH_MISSES,
+    /// @brief Level 1 data cache read misses
+    L1D_MISSES,
+  };
+
+  /// @brief The number of events
+  static constexpr size_t PERF_EVENT_COUNT =
+      static_cast<size_t>(PerfEvent::L1D_MISSES) + 1;
+
+  /// @brief The values of the counters (None if the event is unavailable)
+  using PerfCounts = std::array<Option<u64>, PERF_EVENT_COUNT>;
+
+  /// @brief The work done by a single run of a benchmark
+  struct PerfWork
+  {
+    /// @brief The bytes processed
+    u64 bytes;
+    /// @brief The items processed
+    u64 items;
+    /// @brief The name of an item ("token", "report"...)
+    std::string_view item_name;
+  };
+
+  /// @brief Hardware performance counters of the current thread.
+  /// Each event is opened separately: an event that cannot be opened
+  /// does not prevent counting the others.
+  class PerfCounters
+  {
+    /// @brief The file descriptor of each event (-1 if unavailable)
+    std::array<int, PERF_EVENT_COUNT> fds;
+
+  public:
+    /// @brief Opens the counters (disabled)
+    PerfCounters() noexcept;
+    PerfCounters(PerfCounters&&)      = delete;
+    PerfCounters(const PerfCounters&) = delete;
+
+    /// @brief Closes the counters
+    ~PerfCounters() noexcept;
+
+    /// @brief Check if at least one event can be counted
+    /// @return True if at least one event can be counted
+    bool is_available() const noexcept;
+
+    /// @brief Resets and enables the counters
+    void start() noexcept;
+
+    /// @brief Disables the counters and reads them.
+    /// The values are scaled if the kernel multiplexed the counters.
+    /// @return The values of the counters
+    PerfCounts stop() noexcept;
+
+    template<typename Fn>
+    /// @brief Counts the events of 'runs' calls to 'fn'
+    /// @param runs The number of calls
+    /// @param fn The function to call
+    /// @return The values of the counters for all the calls
+    PerfCounts measure(u32 runs, Fn&& fn) noexcept
+    {
+      start();
+      for (u32 i = 0; i < runs; i++)
+      {
+        auto result = fn();
+        // Prevents the call from being optimized away
+        Catch::Benchmark::deoptimize_value(result);
+      }
+      return stop();
+    }
+  };
+
+  /// @brief Formats the derived metrics of a benchmark
+  /// @param counts The values of the counters for 'runs' runs
+  /// @param runs The number of runs
+  /// @param work The work done by a single run
+  /// @return cycles/byte, IPC and misses per item (or why they are missing)
+  std::string format_counts(
+      const PerfCounts& counts, u32 runs, const PerfWork& work);
+
+  /// @brief The number of runs measured by 'perf_benchmark'
+  static constexpr u32 PERF_RUNS = 64;
+
+  template<typename Fn>
+  /// @brief Runs a Catch2 benchmark, then prints its hardware counters.
+  /// Must be called from a test case.
+  /// @param name The name of the benchmark
+  /// @param work The work done by a single call to 'fn'
+  /// @param fn The function to benchmark (must return a value)
+  void perf_benchmark(const std::string& name, const PerfWork& work, Fn&& fn)
+  {
+    BENCHMARK(std::string{name})
+    {
+      return fn();
+    };
+    PerfCounters counters;
+    auto counts = counters.measure(PERF_RUNS, fn);
+    fmt::print("[perf] {}: {}\n", name, format_counts(counts, PERF_RUNS, work));
+  }
+} // namespace clt::test
+
+#endif // !HG_TEST_PERF_COUNTERS
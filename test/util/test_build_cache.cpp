@@ -0,0 +1,97 @@
+#include <includes.h>
+#include <util/build_cache.h>
+#include <fstream>
+
+using namespace clt;
+
+/// @brief Returns the key of a string
+static CacheKey key_of(std::string_view content)
+{
+  CacheKeyHasher hasher;
+  hasher.add(lng::TargetInfo::host());
+  hasher.add(content);
+  return hasher.finish();
+}
+
+TEST_CASE("coltc CacheKeyHasher")
+{
+  REQUIRE(key_of("var a = 0;") == key_of("var a = 0;"));
+  REQUIRE(key_of("var a = 0;") != key_of("var a = 1;"));
+  REQUIRE(key_of("") != key_of(std::string_view{"\0", 1}));
+  REQUIRE(key_of("var a = 0;").to_string().size() == 32);
+
+  // The boundaries of the inputs are part of the key
+  CacheKeyHasher a, b;
+  a.add(std::string_view{"ab"});
+  a.add(std::string_view{"c"});
+  b.add(std::string_view{"a"});
+  b.add(std::string_view{"bc"});
+  REQUIRE(a.finish() != b.finish());
+}
+
+TEST_CASE("coltc BuildCache")
+{
+  namespace fs = std::filesystem;
+  auto dir     = fs::temp_directory_path() / "coltc_cache";
+  fs::remove_all(dir);
+
+  BuildCache cache;
+  REQUIRE_FALSE(cache.is_enabled());
+  REQUIRE(cache.enable(dir.string(), 0));
+  REQUIRE(cache.is_enabled());
+
+  const std::vector<u8> entry(100, 42);
+  auto key = key_of("entry");
+  REQUIRE(cache.load(CachePhase::TOKENS, key).is_none());
+  REQUIRE(cache.store(CachePhase::TOKENS, key, View<u8>{entry.data(), 100}));
+  auto loaded = cache.load(CachePhase::TOKENS, key);
+  REQUIRE(loaded.is_value());
+  REQUIRE(*loaded == entry);
+  REQUIRE(cache.disk_usage() > entry.size());
+
+  // A truncated entry is a miss
+  for (auto& file : fs::directory_iterator{dir})
+    fs::resize_file(file.path(), 50);
+  REQUIRE(cache.load(CachePhase::TOKENS, key).is_none());
+  // Storing replaces it
+  REQUIRE(cache.store(CachePhase::TOKENS, key, View<u8>{entry.data(), 100}));
+  REQUIRE(cache.load(CachePhase::TOKENS, key).is_value());
+  fs::remove_all(dir);
+}
+
+TEST_CASE("coltc BuildCache trim")
+{
+  namespace fs = std::filesystem;
+  auto dir     = fs::temp_directory_path() / "coltc_cache_trim";
+  fs::remove_all(dir);
+
+  BuildCache cache;
+  // Each entry is 1000 bytes + its header: only 2 fit
+  REQUIRE(cache.enable(dir.string(), 2500));
+  const std::vector<u8> entry(1000, 1);
+  std::array keys = {key_of("a"), key_of("b"), key_of("c")};
+  auto time       = fs::file_time_type::clock::now() - std::chrono::hours{3};
+  for (auto& key : keys)
+  {
+    REQUIRE(cache.store(CachePhase::TOKENS, key, View<u8>{entry.data(), 1000}));
+    // Makes the order of the entries explicit
+    for (auto& file : fs::directory_iterator{dir})
+      if (fs::last_write_time(file.path()) > time)
+        fs::last_write_time(file.path(), time);
+    time += std::chrono::minutes{1};
+  }
+  // Using 'a' makes 'b' the least recently used entry
+  REQUIRE(cache.load(CachePhase::TOKENS, keys[0]).is_value());
+  // A temporary file abandoned by a killed process
+  auto abandoned = dir / "tokens-0.ctc.1-0.tmp";
+  std::ofstream{abandoned} << "partial";
+  fs::last_write_time(abandoned, time - std::chrono::hours{2});
+
+  cache.trim();
+  REQUIRE(cache.load(CachePhase::TOKENS, keys[0]).is_value());
+  REQUIRE(cache.load(CachePhase::TOKENS, keys[1]).is_none());
+  REQUIRE(cache.load(CachePhase::TOKENS, keys[2]).is_value());
+  REQUIRE_FALSE(fs::exists(abandoned));
+  REQUIRE(cache.disk_usage() <= 2500);
+  fs::remove_all(dir);
+}
@@ -0,0 +1,183 @@
+#include <includes.h>
+
+#ifndef COLT_WINDOWS
+  #include <util/daemon.h>
+  #include <util/daemon_protocol.h>
+  #include <filesystem>
+  #include <poll.h>
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #include <sys/wait.h>
+
+using namespace clt;
+
+TEST_CASE("coltc daemon protocol")
+{
+  int fds[2];
+  REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+  const std::vector<std::string_view> sent = {
+      "/home/user", "coltc", "", "--cache-dir", "cache"};
+  auto request = daemon::encode_request(sent);
+  REQUIRE(daemon::write_all(fds[0], request.data(), request.size()));
+  std::vector<std::string> received;
+  REQUIRE(daemon::read_request(fds[1], received));
+  REQUIRE(std::ranges::equal(sent, received));
+
+  // A request from another program (or version) is rejected
+  request[0] = 'X';
+  REQUIRE(daemon::write_all(fds[0], request.data(), request.size()));
+  REQUIRE_FALSE(daemon::read_request(fds[1], received));
+
+  ::close(fds[0]);
+  ::close(fds[1]);
+
+  // A truncated request (the header and half the strings) is rejected
+  REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+  // The peer of a socket pair is the current process
+  REQUIRE(daemon::is_peer_trusted(fds[1]));
+  request[0]          = daemon::REQUEST_MAGIC[0];
+  const size_t header = daemon::REQUEST_MAGIC.size() + 2 * sizeof(std::uint32_t);
+  REQUIRE(daemon::write_all(
+      fds[0], request.data(), header + (request.size() - header) / 2));
+  ::close(fds[0]);
+  REQUIRE_FALSE(daemon::read_request(fds[1], received));
+  ::close(fds[1]);
+
+  auto trailer = daemon::encode_trailer(-1);
+  REQUIRE(std::equal(
+      daemon::EXIT_MAGIC.begin(), daemon::EXIT_MAGIC.end(), trailer.begin()));
+  std::int32_t code;
+  std::memcpy(&code, trailer.data() + daemon::EXIT_MAGIC.size(), sizeof(code));
+  REQUIRE(code == -1);
+}
+
+/// @brief The pipes releasing the requests of the daemon test
+static int Release[2][2];
+
+/// @brief Writes "started", then waits for the request to be released
+/// @param argv The arguments ("coltc", then the index of the request)
+/// @return The index of the request
+static int wait_for_release(Span<const char8_t*> argv)
+{
+  int request = 0;
+  for (auto arg : argv)
+    request = arg[0] - u8'0';
+  (void)daemon::write_all(STDOUT_FILENO, "started", 7);
+  char byte;
+  (void)::read(Release[request][0], &byte, 1);
+  return request;
+}
+
+/// @brief Connects to the daemon and sends a request
+/// @param path The path of the socket
+/// @param request The index of the request
+/// @return The connection (or -1)
+static int send_request(const std::string& path, std::string_view request)
+{
+  sockaddr_un address = {};
+  address.sun_family  = AF_UNIX;
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  // The daemon may not be listening yet
+  for (int retry = 0; retry < 500; retry++)
+  {
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address))
+        == 0)
+    {
+      auto cwd = std::filesystem::current_path().string();
+      auto msg = daemon::encode_request({cwd, "coltc", request});
+      return daemon::write_all(fd, msg.data(), msg.size()) ? fd : -1;
+    }
+    ::close(fd);
+    ::poll(nullptr, 0, 10);
+  }
+  return -1;
+}
+
+/// @brief Reads a response until 'size' bytes or the end of the output
+/// @param fd The connection
+/// @param size The bytes to read (or 0 to read until the end)
+/// @return The bytes read (empty if nothing was received in 5 seconds)
+static std::string read_response(int fd, size_t size = 0)
+{
+  std::string out;
+  char buffer[256];
+  while (size == 0 || out.size() < size)
+  {
+    pollfd poll = {fd, POLLIN, 0};
+    if (::poll(&poll, 1, 5000) != 1)
+      return {};
+    const auto bytes = ::read(
+        fd, buffer,
+        size == 0 ? sizeof(buffer) : std::min(sizeof(buffer), size - out.size()));
+    if (bytes <= 0)
+      break;
+    out.append(buffer, static_cast<size_t>(bytes));
+  }
+  return out;
+}
+
+TEST_CASE("coltc daemon overlapping requests")
+{
+  namespace fs   = std::filesystem;
+  const auto dir = fs::temp_directory_path()
+                   / ("coltc-daemon-test-" + std::to_string(::getpid()));
+  fs::create_directories(dir);
+  const auto path = (dir / "coltc.sock").string();
+  REQUIRE(::pipe(Release[0]) == 0);
+  REQUIRE(::pipe(Release[1]) == 0);
+
+  const pid_t server = ::fork();
+  REQUIRE(server >= 0);
+  if (server == 0)
+    std::_Exit(run_daemon(path, &wait_for_release));
+  // The daemon (and its requests) are stopped even if a check fails
+  struct StopDaemon
+  {
+    pid_t pid;
+
+    ~StopDaemon()
+    {
+      if (pid <= 0)
+        return;
+      ::kill(pid, SIGTERM);
+      ::waitpid(pid, nullptr, 0);
+    }
+  } stop{server};
+
+  // The second request is forked while the first one is being compiled
+  const int first = send_request(path, "0");
+  REQUIRE(first >= 0);
+  REQUIRE(read_response(first, 7) == "started");
+  const int second = send_request(path, "1");
+  REQUIRE(second >= 0);
+  REQUIRE(read_response(second, 7) == "started");
+
+  // The first client sees the end of its output while the second
+  // request is still running
+  const auto trailer = daemon::encode_trailer(0);
+  REQUIRE(::write(Release[0][1], "", 1) == 1);
+  REQUIRE(read_response(first) == std::string{trailer.begin(), trailer.end()});
+  const auto second_trailer = daemon::encode_trailer(1);
+  REQUIRE(::write(Release[1][1], "", 1) == 1);
+  REQUIRE(
+      read_response(second)
+      == std::string{second_trailer.begin(), second_trailer.end()});
+
+  ::close(first);
+  ::close(second);
+  ::kill(server, SIGTERM);
+  stop.pid = -1;
+  int status;
+  REQUIRE(::waitpid(server, &status, 0) == server);
+  REQUIRE(WIFEXITED(status));
+  REQUIRE(WEXITSTATUS(status) == 0);
+  for (auto& pipe : Release)
+  {
+    ::close(pipe[0]);
+    ::close(pipe[1]);
+  }
+  fs::remove_all(dir);
+}
+#endif // !COLT_WINDOWS
@@ -43,3 +43,260 @@
 //  REQUIRE(!ptr.is_none());
 //  REQUIRE((*ptr)() == 42);
 //}
+
+#include <includes.h>
+#include <util/ffi/ffi_caller.h>
+#include <util/ffi/ffi_types.h>
+#include <util/ffi/ffi_closure.h>
+
+using namespace clt;
+
+/// @brief Function called through libffi by the tests below
+static i32 ffi_add(i32 a, i32 b)
+{
+  return a + b;
+}
+
+/// @brief Function returning a small integer called through libffi
+static u8 ffi_low_byte(u64 a)
+{
+  return static_cast<u8>(a);
+}
+
+TEST_CASE("coltc PreparedCall")
+{
+  auto add = ffi::PreparedCall<i32(i32, i32)>::prepare((void*)&ffi_add);
+  REQUIRE(add.is_value());
+  REQUIRE((*add)(40, 2) == 42);
+  REQUIRE((*add)(-1, 1) == 0);
+
+  // The signature is only prepared once
+  auto add2 = ffi::PreparedCall<i32(i32, i32)>::prepare((void*)&ffi_add);
+  REQUIRE(add2->prepared_signature() == add->prepared_signature());
+
+  REQUIRE(ffi::FFICaller::call<u8>((void*)&ffi_low_byte, u64{0x1234}) == 0x34);
+
+  ffi::SignatureCache cache;
+  ffi_type* args[] = {&ffi_type_sint32, &ffi_type_sint32};
+  auto sig         = cache.get(&ffi_type_sint32, Span<ffi_type* const>{args, 2});
+  REQUIRE(sig.is_value());
+  REQUIRE(*cache.get(&ffi_type_sint32, Span<ffi_type* const>{args, 2}) == *sig);
+  REQUIRE(cache.size() == 1);
+
+  i32 a = 20, b = 22;
+  void* values[] = {&a, &b};
+  ffi_arg result;
+  ffi::DynamicCall{*sig, (void*)&ffi_add}(&result, values);
+  REQUIRE(static_cast<i32>(result) == 42);
+}
+
+TEST_CASE("coltc PreparedCall benchmark", "[.][benchmark]")
+{
+  i32 a = 20, b = 22;
+  BENCHMARK("ffi_prep_cif + ffi_call (per call)")
+  {
+    ffi_type* types[] = {&ffi_type_sint32, &ffi_type_sint32};
+    void* values[]    = {&a, &b};
+    ffi_cif cif;
+    ffi_arg result;
+    ffi_prep_cif(&cif, FFI_DEFAULT_ABI, 2, &ffi_type_sint32, types);
+    ffi_call(&cif, FFI_FN(&ffi_add), &result, values);
+    return result;
+  };
+
+  auto add = *ffi::PreparedCall<i32(i32, i32)>::prepare((void*)&ffi_add);
+  BENCHMARK("PreparedCall")
+  {
+    return add(a, b);
+  };
+
+  BENCHMARK("FFICaller::call")
+  {
+    return ffi::FFICaller::call<i32>((void*)&ffi_add, a, b);
+  };
+
+  auto sig = *ffi::SignatureCache::global().get(
+      &ffi_type_sint32,
+      Span<ffi_type* const>{add.prepared_signature()->arg_types, 2});
+  BENCHMARK("SignatureCache::get + DynamicCall")
+  {
+    ffi_arg result;
+    void* values[] = {&a, &b};
+    ffi::DynamicCall{
+        *ffi::SignatureCache::global().get(
+            &ffi_type_sint32, Span<ffi_type* const>{sig->arg_types, 2}),
+        (void*)&ffi_add}(&result, values);
+    return result;
+  };
+}
+
+TEST_CASE("coltc FFI batch")
+{
+  static constexpr size_t ROWS = 100;
+  std::vector<i32> a(ROWS), b(ROWS), expected(ROWS);
+  std::vector<u64> wide(ROWS);
+  for (size_t i = 0; i < ROWS; i++)
+  {
+    a[i]        = static_cast<i32>(i);
+    b[i]        = static_cast<i32>(i * 3);
+    expected[i] = a[i] + b[i];
+    wide[i]     = 0xAB00 + i;
+  }
+
+  std::vector<i32> out(ROWS);
+  auto add = *ffi::PreparedCall<i32(i32, i32)>::prepare((void*)&ffi_add);
+  add.batch(ROWS, out.data(), a.data(), b.data());
+  REQUIRE(out == expected);
+
+  std::fill(out.begin(), out.end(), 0);
+  ffi::DynamicCall dyn{add.prepared_signature(), (void*)&ffi_add};
+  ffi::ArgColumn columns[] = {{a.data(), sizeof(i32)}, {b.data(), sizeof(i32)}};
+  dyn.batch(ROWS, {out.data(), sizeof(i32)}, Span<const ffi::ArgColumn>{columns, 2});
+  REQUIRE(out == expected);
+
+  // Results narrower than ffi_arg must not overflow the output column
+  std::vector<u8> bytes(ROWS + 1, 0xFF);
+  auto low = *ffi::PreparedCall<u8(u64)>::prepare((void*)&ffi_low_byte);
+  ffi::ArgColumn wide_column[] = {{wide.data(), sizeof(u64)}};
+  ffi::DynamicCall{low.prepared_signature(), (void*)&ffi_low_byte}.batch(
+      ROWS, {bytes.data(), sizeof(u8)}, Span<const ffi::ArgColumn>{wide_column, 1});
+  for (size_t i = 0; i < ROWS; i++)
+    REQUIRE(bytes[i] == static_cast<u8>(i));
+  REQUIRE(bytes[ROWS] == 0xFF);
+}
+
+TEST_CASE("coltc FFI batch benchmark", "[.][benchmark]")
+{
+  static constexpr size_t ROWS = 4096;
+  std::vector<i32> a(ROWS, 20), b(ROWS, 22), out(ROWS);
+  auto add = *ffi::PreparedCall<i32(i32, i32)>::prepare((void*)&ffi_add);
+  ffi::DynamicCall dyn{add.prepared_signature(), (void*)&ffi_add};
+  ffi::ArgColumn columns[] = {{a.data(), sizeof(i32)}, {b.data(), sizeof(i32)}};
+
+  BENCHMARK("PreparedCall per row")
+  {
+    for (size_t i = 0; i < ROWS; i++)
+      out[i] = add(a[i], b[i]);
+    return out[0];
+  };
+
+  BENCHMARK("DynamicCall::batch")
+  {
+    dyn.batch(
+        ROWS, {out.data(), sizeof(i32)}, Span<const ffi::ArgColumn>{columns, 2});
+    return out[0];
+  };
+
+  BENCHMARK("PreparedCall::batch (native loop)")
+  {
+    add.batch(ROWS, out.data(), a.data(), b.data());
+    return out[0];
+  };
+}
+
+/// @brief Struct passed by value through a runtime signature
+struct FFIPair
+{
+  i32 a;
+  i64 b;
+};
+
+/// @brief Struct containing a nested struct
+struct FFINested
+{
+  u8 tag;
+  FFIPair pair;
+};
+
+/// @brief Function taking structs by value
+static FFIPair ffi_swap(FFINested nested, i32 offset)
+{
+  return FFIPair{
+      static_cast<i32>(nested.pair.b) + offset, nested.pair.a + nested.tag};
+}
+
+TEST_CASE("coltc TypeInterner")
+{
+  using enum lng::PrimitiveType;
+  using namespace ffi;
+
+  // The types are passed to the libffi of the host
+  auto host = lng::TargetInfo::host();
+  TypeInterner interner{host};
+
+  ffi_type* i32_type = *interner.primitive(iw32b, true);
+  ffi_type* pair_members[] = {i32_type, *interner.primitive(iw64b, true)};
+  auto pair = interner.structure(Span<ffi_type* const>{pair_members, 2});
+  REQUIRE(pair.is_value());
+  REQUIRE((*pair)->size == sizeof(FFIPair));
+  REQUIRE(interner.offsets_of(*pair) == std::vector<u32>{0, offsetof(FFIPair, b)});
+  // Structurally equal types are interned
+  REQUIRE(*interner.structure(Span<ffi_type* const>{pair_members, 2}) == *pair);
+
+  ffi_type* nested_members[] = {*interner.primitive(iw08b), *pair};
+  auto nested = *interner.structure(Span<ffi_type* const>{nested_members, 2});
+  REQUIRE(nested->size == sizeof(FFINested));
+  REQUIRE(nested->alignment == alignof(FFINested));
+
+  ffi_type* args[] = {nested, i32_type};
+  auto sig         = interner.signature(*pair, Span<ffi_type* const>{args, 2});
+  REQUIRE(sig.is_value());
+  REQUIRE(*interner.signature(*pair, Span<ffi_type* const>{args, 2}) == *sig);
+
+  // Fill the argument buffer using the computed offsets
+  alignas(16) char buffer[64] = {};
+  REQUIRE((*sig)->buffer_size <= sizeof(buffer));
+  auto value = FFINested{3, {10, 20}};
+  i32 offset = 100;
+  std::memcpy(buffer + (*sig)->arg_offsets[0], &value, sizeof(value));
+  std::memcpy(buffer + (*sig)->arg_offsets[1], &offset, sizeof(offset));
+
+  FFIPair result;
+  TypeInterner::invoke(**sig, (void*)&ffi_swap, buffer, &result);
+  REQUIRE(result.a == 120);
+  REQUIRE(result.b == 13);
+
+  REQUIRE(interner.primitive(fw32b).is_value());
+  REQUIRE(interner.primitive(dtptr).is_value());
+
+  // Only the layout of the host ABI can be called natively
+  auto packed = host;
+  packed.primitive_infos[static_cast<u8>(iw64b)].align = 1;
+  REQUIRE(
+      TypeInterner{packed}.primitive(iw64b).error()
+      == TypeInterner::InternError::UNSUPPORTED_TYPE);
+}
+
+TEST_CASE("coltc Callback")
+{
+  using namespace ffi;
+  ClosurePool pool;
+  {
+    i32 calls = 0;
+    auto compare = Callback<i32(const void*, const void*)>::make(
+        [&calls](const void* a, const void* b)
+        {
+          calls++;
+          return *static_cast<const i32*>(a) - *static_cast<const i32*>(b);
+        },
+        pool);
+    REQUIRE(compare.is_value());
+
+    i32 values[] = {5, 3, 9, 1};
+    std::qsort(values, 4, sizeof(i32), compare->function());
+    REQUIRE(values[0] == 1);
+    REQUIRE(values[3] == 9);
+    REQUIRE(calls > 0);
+
+    auto narrow =
+        Callback<u8(u8)>::make([](u8 a) { return static_cast<u8>(a + 1); }, pool);
+    REQUIRE(narrow.is_value());
+    REQUIRE(narrow->function()(41) == 42);
+    REQUIRE(pool.allocated() == 2);
+  }
+  // The closures of destroyed callbacks are reused
+  auto reused = Callback<void()>::make([] {}, pool);
+  REQUIRE(reused.is_value());
+  reused->function()();
+  REQUIRE(pool.allocated() == 2);
+}
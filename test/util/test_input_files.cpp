@@ -0,0 +1,53 @@
+#include <includes.h>
+#include <util/input_files.h>
+#include <filesystem>
+#include <fstream>
+
+using namespace clt;
+
+TEST_CASE("coltc glob_match")
+{
+  REQUIRE(glob_match("*.ct", "main.ct"));
+  REQUIRE(glob_match("*.ct", ".ct"));
+  REQUIRE_FALSE(glob_match("*.ct", "main.ctx"));
+  REQUIRE(glob_match("a*b*c", "aXXbYbc"));
+  REQUIRE(glob_match("file?.ct", "file1.ct"));
+  REQUIRE_FALSE(glob_match("file?.ct", "file.ct"));
+  REQUIRE(glob_match("[a-c]x", "bx"));
+  REQUIRE_FALSE(glob_match("[!a-c]x", "bx"));
+  REQUIRE(glob_match("[]]", "]"));
+  // An unclosed '[' is a normal character
+  REQUIRE(glob_match("[a", "[a"));
+}
+
+TEST_CASE("coltc expand_inputs")
+{
+  namespace fs = std::filesystem;
+  auto dir     = fs::temp_directory_path() / "coltc_inputs";
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  for (auto name : {"b.ct", "a.ct", "c.txt", ".hidden.ct"})
+    std::ofstream{dir / name} << "var a = 0;";
+  auto base = dir.string() + "/";
+  std::ofstream{dir / "inputs.rsp"}
+      << "\"" << base << "c.txt\"\n  " << base << "*.ct @" << base << "nested.rsp";
+  std::ofstream{dir / "nested.rsp"} << base << "b.ct";
+  std::ofstream{dir / "cycle.rsp"} << "@" << base << "cycle.rsp";
+
+  std::vector<std::string> inputs;
+  std::string response = "@" + base + "inputs.rsp";
+  REQUIRE(expand_inputs({"x.ct", response}, inputs));
+  // Globs are sorted, hidden files are skipped and duplicates are removed
+  REQUIRE(
+      inputs
+      == std::vector<std::string>{
+          "x.ct", base + "c.txt", base + "a.ct", base + "b.ct"});
+
+  inputs.clear();
+  auto none  = base + "*.none";
+  auto cycle = "@" + base + "cycle.rsp";
+  REQUIRE_FALSE(expand_inputs({none}, inputs));
+  REQUIRE_FALSE(expand_inputs({cycle}, inputs));
+  REQUIRE_FALSE(expand_inputs({"@" + base + "missing.rsp"}, inputs));
+  fs::remove_all(dir);
+}
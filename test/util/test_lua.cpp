@@ -0,0 +1,133 @@
+#include <includes.h>
+#include <frontend/lex/lex.h>
+#include <frontend/err/composable_reporter.h>
+#include <util/lua/lua_pool.h>
+
+using namespace clt;
+using namespace clt::lua;
+
+TEST_CASE("coltc LuaStatePool")
+{
+  static const char SOURCE[] = "a + b * c";
+  auto reporter = lng::make_error_reporter<lng::SinkReporter>();
+  auto ctx      = lng::lex(
+      *reporter, View<u8>{reinterpret_cast<const u8*>(SOURCE), sizeof(SOURCE) - 1});
+
+  LuaStatePool pool{2};
+  std::string error;
+  static constexpr std::string_view COUNT = R"(
+        return function(tokens)
+          local count = 0
+          for i = 1, #tokens do
+            if tokens:identifier(i) ~= nil then count = count + 1 end
+          end
+          return count
+        end)";
+  auto count = pool.chunks().compile("count", COUNT, error);
+  REQUIRE(count.is_value());
+  // Compiled once, unless the script changes
+  REQUIRE(*pool.chunks().compile("count", COUNT, error) == *count);
+  auto changed = pool.chunks().compile("count", "return function() end", error);
+  REQUIRE(changed.is_value());
+  REQUIRE(*changed != *count);
+
+  for (u32 worker = 0; worker < pool.size(); worker++)
+  {
+    for (u32 i = 0; i < 3; i++)
+    {
+      auto result = pool.state(worker).run(**count, ctx);
+      REQUIRE(result.is_value());
+      REQUIRE(*result == 3);
+    }
+  }
+
+  auto syntax = pool.chunks().compile("syntax", "return function(", error);
+  REQUIRE(syntax.is_error());
+  REQUIRE(syntax.error() == LuaError::SYNTAX_ERR);
+
+  auto not_fn = pool.chunks().compile("not_fn", "return 1", error);
+  REQUIRE(not_fn.is_value());
+  REQUIRE(pool.state(0).run(**not_fn, ctx).error() == LuaError::BAD_RESULT);
+
+  // The token view cannot be used after its hook returned
+  auto save = pool.chunks().compile(
+      "save", "return function(tokens) saved = tokens end", error);
+  auto use = pool.chunks().compile(
+      "use", "return function() return #saved end", error);
+  REQUIRE((save.is_value() && use.is_value()));
+  REQUIRE(pool.state(0).run(**save, ctx).is_value());
+  REQUIRE(pool.state(0).run(**use, ctx).error() == LuaError::RUNTIME_ERR);
+
+  // The token view is read-only
+  auto write = pool.chunks().compile(
+      "write", "return function(tokens) tokens[1] = 0 end", error);
+  REQUIRE(pool.state(1).run(**write, ctx).error() == LuaError::RUNTIME_ERR);
+}
+
+TEST_CASE("coltc LuaArena")
+{
+  LuaArena arena;
+  auto small = LuaArena::allocate(&arena, nullptr, LUA_TTABLE, 24);
+  auto large = LuaArena::allocate(&arena, nullptr, LUA_TSTRING, 4096);
+  REQUIRE((small != nullptr && large != nullptr));
+  REQUIRE(arena.in_use() == 24 + 4096);
+  REQUIRE(arena.reserved() == LuaArena::BLOCK_SIZE);
+
+  // Growing inside a size class keeps the slot
+  REQUIRE(LuaArena::allocate(&arena, small, 24, 32) == small);
+  LuaArena::allocate(&arena, small, 32, 0);
+  // Freed slots are reused
+  REQUIRE(LuaArena::allocate(&arena, nullptr, LUA_TTABLE, 20) == small);
+
+  arena.set_limit(arena.in_use() + 100);
+  REQUIRE(LuaArena::allocate(&arena, nullptr, LUA_TSTRING, 200) == nullptr);
+  REQUIRE(arena.is_limit_hit());
+  // Shrinking never fails
+  large = LuaArena::allocate(&arena, large, 4096, 16);
+  REQUIRE(large != nullptr);
+  REQUIRE(arena.in_use() == 20 + 16);
+  REQUIRE(arena.peak_use() == 24 + 4096 + 8);
+  REQUIRE(arena.total_allocated() == 24 + 4096 + 8 + 20);
+
+  LuaArena::allocate(&arena, small, 20, 0);
+  LuaArena::allocate(&arena, large, 16, 0);
+  REQUIRE(arena.in_use() == 0);
+  arena.release();
+  REQUIRE(arena.reserved() == 0);
+}
+
+TEST_CASE("coltc LuaState memory budget")
+{
+  static const char SOURCE[] = "a";
+  auto reporter = lng::make_error_reporter<lng::SinkReporter>();
+  auto ctx      = lng::lex(
+      *reporter, View<u8>{reinterpret_cast<const u8*>(SOURCE), sizeof(SOURCE) - 1});
+
+  LuaStatePool pool{1, 64 * 1024};
+  std::string error;
+  auto greedy = pool.chunks().compile(
+      "greedy", R"(
+        return function(tokens)
+          local t = {}
+          for i = 1, 1000000 do t[i] = i end
+          return #t
+        end)",
+      error);
+  auto small = pool.chunks().compile(
+      "small", "return function(tokens) return tokens:size(1) end", error);
+  REQUIRE((greedy.is_value() && small.is_value()));
+
+  auto& state = pool.state(0);
+  REQUIRE(state.run(**greedy, ctx).error() == LuaError::MEMORY_ERR);
+  REQUIRE(state.usage_of(**greedy).over_budget == 1);
+  REQUIRE(state.usage_of(**greedy).peak <= 64 * 1024);
+  // The state remains usable
+  REQUIRE(*state.run(**small, ctx) == 1);
+  REQUIRE(state.usage_of(**small).runs == 1);
+
+  state.reset();
+  REQUIRE(*state.run(**small, ctx) == 1);
+  REQUIRE(state.usage_of(**small).runs == 2);
+  state.set_budget(LuaArena::NO_LIMIT);
+  REQUIRE(*state.run(**greedy, ctx) == 1000000);
+}
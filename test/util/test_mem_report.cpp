@@ -0,0 +1,36 @@
+#include <includes.h>
+#include <util/mem_report.h>
+
+using namespace clt;
+
+TEST_CASE("coltc MemAccounting")
+{
+  MemAccounting::reset();
+  MemAccounting::enable();
+  {
+    TrackedVector<u64, MemTag::BACKEND> values;
+    values.reserve(16);
+    values.reserve(32);
+    auto mem = MemAccounting::stats(MemTag::BACKEND);
+    REQUIRE(mem.live == 32 * sizeof(u64));
+    REQUIRE(mem.peak == 48 * sizeof(u64));
+    REQUIRE(mem.allocs == 2);
+    REQUIRE(mem.frees == 1);
+
+    MemCharge charge{MemTag::LEXER, 100};
+    MemCharge moved = std::move(charge);
+    charge.update(10);
+    REQUIRE(MemAccounting::stats(MemTag::LEXER).live == 110);
+    moved.update(50);
+    REQUIRE(MemAccounting::stats(MemTag::LEXER).live == 60);
+    REQUIRE(MemAccounting::stats(MemTag::LEXER).peak == 110);
+  }
+  REQUIRE(MemAccounting::stats(MemTag::BACKEND).live == 0);
+  REQUIRE(MemAccounting::stats(MemTag::LEXER).live == 0);
+  MemAccounting::enable(false);
+  {
+    TrackedVector<u64, MemTag::BACKEND> values(8);
+  }
+  REQUIRE(MemAccounting::stats(MemTag::BACKEND).allocs == 2);
+  MemAccounting::reset();
+}
@@ -0,0 +1,39 @@
+#include <includes.h>
+#include <util/phase_timer.h>
+
+using namespace clt;
+
+TEST_CASE("coltc PhaseTimes")
+{
+  PhaseTimes times;
+  {
+    // Disabled: nothing is recorded
+    PhaseScope scope{times, Phase::LEX};
+  }
+  REQUIRE(times.recorded().empty());
+
+  times.enable();
+  for (auto path : {"a.ct", "b.ct"})
+  {
+    times.begin_file(path);
+    for (u32 i = 0; i < 2; i++)
+    {
+      PhaseScope scope{times, Phase::LEX};
+      scope.processed(100, 10);
+    }
+    PhaseScope scope{times, Phase::MAP_FILE};
+    scope.stop();
+    // Stopping twice only records once
+    scope.stop();
+  }
+  REQUIRE(times.recorded().size() == 2);
+  auto& lex = times.recorded()[1].phases[static_cast<size_t>(Phase::LEX)];
+  REQUIRE(lex.count == 2);
+  REQUIRE(lex.bytes == 200);
+  REQUIRE(lex.tokens == 20);
+
+  auto total = times.total();
+  REQUIRE(total[static_cast<size_t>(Phase::LEX)].count == 4);
+  REQUIRE(total[static_cast<size_t>(Phase::MAP_FILE)].count == 2);
+  REQUIRE(total[static_cast<size_t>(Phase::BACKEND)].count == 0);
+}
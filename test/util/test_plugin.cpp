@@ -0,0 +1,213 @@
+#include <includes.h>
+#include <filesystem>
+#include <util/ffi/plugin_registry.h>
+#include <util/ffi/plugin_reporter.h>
+
+using namespace clt;
+using namespace clt::ffi;
+
+TEST_CASE("coltc PluginRegistry manifest")
+{
+  auto path = (std::filesystem::temp_directory_path() / "coltc_test.manifest")
+                  .generic_string();
+
+  std::vector<PluginManifestEntry> entries = {
+      {"plugins/a.so", 123, 456, "A", "First\tplugin\n\\t",
+       ColtPlugin::PluginType::REPORTER, true},
+      {"plugins/b.so", -1, 0, "", "", ColtPlugin::PluginType::EMPTY, false},
+  };
+  REQUIRE(PluginRegistry::write_manifest(path.c_str(), entries));
+
+  auto read = PluginRegistry::read_manifest(path.c_str());
+  REQUIRE(read.size() == 2);
+  REQUIRE(read[0].path == "plugins/a.so");
+  REQUIRE(read[0].mtime == 123);
+  REQUIRE(read[0].size == 456);
+  REQUIRE(read[0].name == "A");
+  REQUIRE(read[0].desc == "First\tplugin\n\\t");
+  REQUIRE(read[0].purpose == ColtPlugin::PluginType::REPORTER);
+  REQUIRE(read[0].is_valid);
+  REQUIRE(read[1].mtime == -1);
+  REQUIRE(!read[1].is_valid);
+
+  // Corrupted manifests are ignored
+  auto file = std::fopen(path.c_str(), "wb");
+  REQUIRE(file != nullptr);
+  std::fputs("COLTPLUGINS:2\nplugins/a.so\tabc\n", file);
+  std::fclose(file);
+  REQUIRE(PluginRegistry::read_manifest(path.c_str()).empty());
+  file = std::fopen(path.c_str(), "wb");
+  REQUIRE(file != nullptr);
+  std::fputs("COLTPLUGINS:2\nplugins/a.so\t1\t2\t1\t0\tA\\q\t\n", file);
+  std::fclose(file);
+  REQUIRE(PluginRegistry::read_manifest(path.c_str()).empty());
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("coltc PluginRegistry lazy loading")
+{
+  using enum ColtPlugin::PluginType;
+  namespace fs = std::filesystem;
+
+  auto dir = fs::temp_directory_path() / "coltc_test_plugins";
+  fs::create_directories(dir);
+
+  PluginRegistry registry{dir.generic_string()};
+  // Undeclared purposes do not touch the plugin directory
+  REQUIRE(registry.require(REPORTER).empty());
+  REQUIRE(!registry.is_discovered());
+
+  registry.declare(REPORTER);
+  REQUIRE(registry.is_declared(REPORTER));
+  REQUIRE(!registry.is_declared(BACKEND));
+  REQUIRE(registry.require(REPORTER).empty());
+  REQUIRE(registry.is_discovered());
+  REQUIRE(registry.require(BACKEND).empty());
+  fs::remove_all(dir);
+}
+
+/// @brief The diagnostics received by 'record_batch' (copied)
+static std::vector<std::string> BATCHES;
+
+/// @brief Report function of a fake REPORTER plugin
+static void record_batch(const ColtPlugin::Diagnostic* diagnostics, u32 count)
+{
+  std::string batch;
+  for (u32 i = 0; i < count; i++)
+  {
+    auto& diag = diagnostics[i];
+    batch += fmt::format(
+        "{}:{}:{}:{}:{}:{};", diag.kind,
+        std::string_view{(const char*)diag.file, diag.file_size},
+        std::string_view{(const char*)diag.message, diag.message_size},
+        diag.id == ColtPlugin::Diagnostic::NO_ID ? -1 : (i64)diag.id,
+        diag.byte_offset == ColtPlugin::Diagnostic::NO_OFFSET
+            ? -1
+            : (i64)diag.byte_offset,
+        diag.column_begin);
+  }
+  BATCHES.push_back(std::move(batch));
+}
+
+TEST_CASE("coltc PluginReporter")
+{
+  using namespace clt::lng;
+  static const char SOURCE[] = "let a = 10;\n";
+  auto content = View<u8>{reinterpret_cast<const u8*>(SOURCE), sizeof(SOURCE) - 1};
+  auto line    = u8StringView{reinterpret_cast<const Char8*>(SOURCE), 11};
+  auto expr    = u8StringView{reinterpret_cast<const Char8*>(SOURCE) + 8, 2};
+
+  BATCHES.clear();
+  {
+    auto reporter = make_error_reporter<PluginReporter<>>(
+        std::vector<ColtPlugin::fn_report_t>{&record_batch});
+    reporter->set_file(SourceFile{"a.ct", content});
+    reporter->error("first"_UTF8, SourceInfo{1, expr, line}, ReportNumber{3});
+    reporter->warn("second"_UTF8);
+    // Nothing is delivered until the end of the phase
+    REQUIRE(BATCHES.empty());
+    reporter->flush();
+    REQUIRE(BATCHES.size() == 1);
+    REQUIRE(BATCHES[0] == "2:a.ct:first:3:8:9;1:a.ct:second:-1:-1:0;");
+    reporter->message("third"_UTF8);
+  }
+  // Delivered on destruction
+  REQUIRE(BATCHES.size() == 2);
+  REQUIRE(BATCHES[1] == "0:a.ct:third:-1:-1:0;");
+
+  BATCHES.clear();
+  {
+    DiagnosticBatch batch{{&record_batch}, 2};
+    for (u32 i = 0; i < 5; i++)
+      batch.push(ReportKind::ERROR, "e"_UTF8, None, None);
+    REQUIRE(BATCHES.size() == 2);
+    REQUIRE(batch.pending() == 1);
+  }
+  REQUIRE(BATCHES.size() == 3);
+  REQUIRE(BATCHES[2] == "2::e:-1:-1:0;");
+}
+
+/// @brief Library whose symbols are provided by the test
+struct FakeLib
+{
+  /// @brief The symbols of the library
+  std::vector<std::pair<std::string_view, void (*)()>> symbols;
+  /// @brief The number of calls to 'find'
+  mutable u32 lookups = 0;
+
+  template<typename T>
+  Option<T> find(const char* name) const noexcept
+  {
+    lookups++;
+    for (auto& [symbol, fn] : symbols)
+      if (symbol == name)
+        return reinterpret_cast<T>(fn);
+    return None;
+  }
+};
+
+/// @brief The table returned by 'fake_plugin_v1'
+static ColtPlugin::TableV1 FakeTable = {};
+
+static const Char8* fake_name()
+{
+  return u8"fake";
+}
+
+static ColtPlugin::PluginType fake_purpose()
+{
+  return ColtPlugin::PluginType::REPORTER;
+}
+
+static const ColtPlugin::TableV1* fake_plugin_v1()
+{
+  return &FakeTable;
+}
+
+static void fake_report(const ColtPlugin::Diagnostic*, u32) {}
+
+TEST_CASE("coltc ColtPlugin resolve")
+{
+  using any_fn_t = void (*)();
+  const auto v1_lib = FakeLib{
+      {{"colt_plugin_v1", reinterpret_cast<any_fn_t>(&fake_plugin_v1)},
+       {"colt_name", reinterpret_cast<any_fn_t>(&fake_name)}}};
+  FakeTable         = {};
+  FakeTable.name    = &fake_name;
+  FakeTable.purpose = &fake_purpose;
+  FakeTable.report  = &fake_report;
+
+  // A single lookup resolves all the entry points
+  auto table = ColtPlugin::resolve(v1_lib);
+  REQUIRE(table.is_value());
+  REQUIRE(v1_lib.lookups == 1);
+  REQUIRE(table->name == &fake_name);
+  REQUIRE(table->report == &fake_report);
+  REQUIRE(table->struct_size == sizeof(ColtPlugin::TableV1));
+
+  // Entry points past the size of the table of the plugin are ignored
+  FakeTable.struct_size = offsetof(ColtPlugin::TableV1, report);
+  table                 = ColtPlugin::resolve(v1_lib);
+  REQUIRE(table.is_value());
+  REQUIRE(table->report == nullptr);
+
+  // Tables of another version, or missing lifecycle functions, are rejected
+  FakeTable.struct_size = offsetof(ColtPlugin::TableV1, shutdown);
+  REQUIRE(ColtPlugin::resolve(v1_lib).is_none());
+  FakeTable.struct_size = sizeof(ColtPlugin::TableV1);
+  FakeTable.abi_version = ColtPlugin::ABI_V1 + 1;
+  REQUIRE(ColtPlugin::resolve(v1_lib).is_none());
+
+  // Older plugins only export the loose symbols
+  const auto legacy_lib = FakeLib{
+      {{"colt_name", reinterpret_cast<any_fn_t>(&fake_name)},
+       {"colt_purpose", reinterpret_cast<any_fn_t>(&fake_purpose)}}};
+  table = ColtPlugin::resolve(legacy_lib);
+  REQUIRE(table.is_value());
+  REQUIRE(table->name == &fake_name);
+  REQUIRE(table->purpose == &fake_purpose);
+  REQUIRE(table->setup == nullptr);
+  REQUIRE(table->report == nullptr);
+
+  REQUIRE(ColtPlugin::resolve(FakeLib{}).is_none());
+}
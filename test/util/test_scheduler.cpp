@@ -0,0 +1,129 @@
+#include <includes.h>
+#include <util/scheduler.h>
+
+using namespace clt;
+
+TEST_CASE("coltc Scheduler")
+{
+  Scheduler scheduler{4};
+  REQUIRE(scheduler.worker_count() == 4);
+
+  SECTION("dependencies")
+  {
+    // A diamond: 'last' runs after 'left' and 'right', which run after 'first'
+    std::atomic<u32> step = 0;
+    u32 first_step = 0, left_step = 0, right_step = 0, last_step = 0;
+    TaskGraph graph;
+    auto first = graph.add("first", [&](TaskContext&) { first_step = ++step; });
+    auto left  = graph.add("left", [&](TaskContext&) { left_step = ++step; });
+    auto right = graph.add("right", [&](TaskContext&) { right_step = ++step; });
+    auto last  = graph.add("last", [&](TaskContext&) { last_step = ++step; });
+    graph.precede(first, left);
+    graph.precede(first, right);
+    graph.precede(left, last);
+    graph.precede(right, last);
+    scheduler.run(graph);
+
+    REQUIRE(step == 4);
+    REQUIRE(first_step == 1);
+    REQUIRE(last_step == 4);
+    REQUIRE(left_step != right_step);
+  }
+
+  SECTION("spawn")
+  {
+    // A task is complete once all its (nested) children are
+    std::atomic<u32> children = 0;
+    u32 seen = 0;
+    TaskGraph graph;
+    auto parent = graph.add(
+        "parent",
+        [&](TaskContext& ctx)
+        {
+          for (u32 i = 0; i < 64; i++)
+            ctx.spawn(
+                "child",
+                [&](TaskContext& ctx)
+                {
+                  ctx.spawn("grandchild", [&](TaskContext&) { ++children; });
+                  ++children;
+                });
+        });
+    auto after = graph.add("after", [&](TaskContext&) { seen = children; });
+    graph.precede(parent, after);
+    scheduler.run(graph);
+    REQUIRE(seen == 128);
+  }
+
+  SECTION("uneven tasks")
+  {
+    // A worker never runs two tasks at the same time
+    std::array<std::atomic<u32>, 4> running = {};
+    std::atomic<u64> total = 0;
+    std::atomic<bool> overlap = false;
+    TaskGraph graph;
+    for (u32 i = 0; i < 200; i++)
+      graph.add(
+          "work",
+          [&, i](TaskContext& ctx)
+          {
+            if (running[ctx.worker()]++ != 0)
+              overlap = true;
+            // The first tasks are much longer than the others
+            u64 sum = 0;
+            for (u32 j = 0; j < (i < 4 ? 1'000'000U : 1'000U); j++)
+              sum += j;
+            total += sum != 0;
+            --running[ctx.worker()];
+          });
+    scheduler.run(graph);
+    REQUIRE(total == 200);
+    REQUIRE_FALSE(overlap);
+  }
+
+  SECTION("cancellation")
+  {
+    std::atomic<u32> runs = 0;
+    TaskGraph graph;
+    auto first = graph.add(
+        "cancel",
+        [&](TaskContext& ctx)
+        {
+          ++runs;
+          ctx.cancel();
+        });
+    for (u32 i = 0; i < 16; i++)
+    {
+      auto next = graph.add("skipped", [&](TaskContext&) { ++runs; });
+      graph.precede(first, next);
+    }
+    scheduler.run(graph);
+    REQUIRE(graph.is_cancelled());
+    REQUIRE(runs == 1);
+  }
+}
+
+TEST_CASE("coltc Scheduler single worker")
+{
+  Scheduler scheduler{1};
+  std::vector<u32> order;
+  TaskGraph graph;
+  auto a = graph.add("a", [&](TaskContext&) { order.push_back(0); });
+  auto b = graph.add("b", [&](TaskContext&) { order.push_back(1); });
+  auto c = graph.add("c", [&](TaskContext&) { order.push_back(2); });
+  graph.precede(c, b);
+  graph.precede(b, a);
+  scheduler.run(graph);
+  REQUIRE(order == std::vector<u32>{2, 1, 0});
+
+  // An empty graph returns immediately
+  TaskGraph empty;
+  scheduler.run(empty);
+}
+
+TEST_CASE("coltc worker_count")
+{
+  REQUIRE(worker_count(4, 2) == 2);
+  REQUIRE(worker_count(4, 0) == 1);
+  REQUIRE(worker_count(0, 1'000'000) >= 1);
+}
@@ -0,0 +1,55 @@
+#include <includes.h>
+#include <util/trace_file.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace clt;
+
+TEST_CASE("coltc FileTracer")
+{
+  auto count = [](const std::string& str, std::string_view what)
+  {
+    size_t result = 0;
+    for (auto i = str.find(what); i != str.npos; i = str.find(what, i + 1))
+      ++result;
+    return result;
+  };
+
+  {
+    // Disabled: nothing is recorded
+    TraceZone zone{"test_trace_disabled"};
+  }
+  FileTracer::enable();
+  {
+    TraceZone zone{"test_trace_outer"};
+    TraceZone{"test_trace_block"} + [] {};
+  }
+  std::thread worker{[] { TraceZone zone{"test_trace_worker"}; }};
+  worker.join();
+  FileTracer::enable(false);
+
+  auto path = (std::filesystem::temp_directory_path() / "coltc_trace.json").string();
+  REQUIRE(FileTracer::write(path.c_str()));
+  std::stringstream content;
+  content << std::ifstream{path}.rdbuf();
+  std::filesystem::remove(path);
+  auto json = content.str();
+
+  REQUIRE(json.starts_with("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+  REQUIRE(json.ends_with("]}\n"));
+  REQUIRE(count(json, "\"test_trace_disabled\"") == 0);
+  REQUIRE(count(json, "\"test_trace_outer\"") == 1);
+  REQUIRE(count(json, "\"test_trace_block\"") == 1);
+  REQUIRE(count(json, "\"test_trace_worker\"") == 1);
+  // The worker has its own thread identifier
+  auto tid_of = [&](std::string_view name)
+  {
+    auto end   = json.rfind(",\"name\":\"" + std::string{name});
+    auto begin = json.rfind("\"tid\":", end) + 6;
+    return json.substr(begin, end - begin);
+  };
+  REQUIRE(tid_of("test_trace_outer") == tid_of("test_trace_block"));
+  REQUIRE(tid_of("test_trace_outer") != tid_of("test_trace_worker"));
+}